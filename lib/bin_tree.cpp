@@ -1,6 +1,7 @@
 #include "bin_tree.h"
 
 #include <sys/stat.h>
+#include <cstddef>
 #include <cstring>
 #include <time.h>
 #include <ctype.h>
@@ -10,6 +11,13 @@
 #include "util/dbg/debug.h"
 #include "file_helper.h"
 #include "alloc_tracker/alloc_tracker.h"
+#include "equation_arena.h"
+#include "equation_program.h"
+#include "rewrite_rules.h"
+#include "polynomial.h"
+#include "node_map.h"
+#include "thread_pool.h"
+#include "traversal.h"
 
 #include "tree_config.h"
 
@@ -20,33 +28,141 @@
         break;                                                                                                          \
 
 /**
- * @brief Print subtree to the .dot file.
+ * @brief Find maximal subtrees not bigger than the threshold, whose parents are bigger than the threshold.
  * 
- * @param equation subtree to print
+ * @param equation
+ * @param threshold
+ * @param subtrees where to put the subtrees (sizes are put into the value field)
+ * @param map map to add the subtrees to
+ * @param err_code variable to use as errno
+ * @return false on failure
+ */
+static bool collect_subtrees(const Equation* equation, size_t threshold, TraversalStack* subtrees, NodeMap* map,
+                             int* const err_code);
+
+//* Subtrees differentiated by one pool task.
+struct DiffChunk {
+    const TraversalFrame* subtrees = NULL;
+    size_t count = 0;
+
+    uintptr_t var_id = 0;
+    NodeMap* derivatives = NULL;    //* Where to put derivatives of subtrees.
+};
+
+//* Pool task differentiating the DiffChunk.
+static void diff_chunk(void* argument);
+
+/**
+ * @brief Print part of the node that goes at the stage of the traversal.
+ * 
+ * @param node
+ * @param stage
+ * @param caret write destination
+ * @param err_code variable to use as errno
+ */
+typedef void write_step_t(const Equation* node, TraversalStage stage, caret_t* caret, int* const err_code);
+
+/**
+ * @brief Write the equation in-order, calling the step function before, between and after the branches.
+ * 
+ * @param equation
+ * @param caret write destination
+ * @param end end of the destination buffer
+ * @param step writer of node parts
+ * @param err_code variable to use as errno
+ * @return false if the equation is invalid or does not fit
+ */
+static bool write_equation(const Equation* equation, caret_t* caret, const char* end, write_step_t* step,
+                           int* const err_code);
+
+static write_step_t write_formula_step;
+static write_step_t write_tex_step;
+static write_step_t write_c_step;
+static write_step_t write_input_step;
+
+/**
+ * @brief Check if the operand of an infix operator has to be put in brackets for the parser to read it back.
+ * 
+ * @param op operator
+ * @param operand left or right operand of the operator
+ * @param is_left true for the left operand
+ * @return true if brackets are needed
+ */
+static bool needs_brackets(Operator op, const Equation* operand, bool is_left);
+
+/**
+ * @brief Write the constant as a number of the program input syntax.
+ * 
+ * @param value
+ * @param caret write destination
+ */
+static void write_input_number(double value, caret_t* caret);
+
+static fold_step_t copy_step;
+static fold_step_t diff_step;
+static fold_step_t calculate_step;
+
+/**
+ * @brief Print nodes and edges of the equation to the .dot file.
+ * 
+ * @param equation equation to print (must be valid)
  * @param file write destination
  * @param err_code variable to use as errno
  */
-static void recursive_graph_dump(const Equation* equation, FILE* file, int* const err_code = &errno);
+static void write_graph(const Equation* equation, FILE* file, int* const err_code = &errno);
+
+//* Operation node waiting to be checked by simplification rules.
+struct SimplifyItem {
+    Equation* node = NULL;
+    size_t parent = 0;      //* Index of the parent item (SIMPLIFY_ROOT for the top node).
+    bool seed = false;      //* The node was changed outside of the pass.
+    bool seeded = false;    //* The node is a seed or belongs to the subtree of one.
+    bool queued = false;    //* The node should be checked.
+};
+
+static const size_t SIMPLIFY_ROOT = (size_t)-1;
+
+/**
+ * @brief Apply simplification rules to the nodes that may match them, bottom-up.
+ * Items are listed in pre-order and checked in reverse, so every node is checked after its branches.
+ * A rewrite only changes the node and constants below it, so it queues just the parent of the node.
+ * 
+ * @param equation
+ * @param seeds nodes changed since the last pass, their subtrees are checked completely (NULL = whole equation)
+ * @param err_code variable to use as errno
+ */
+static void simplify_nodes(Equation* equation, const NodeMap* seeds, int* const err_code);
+
+/**
+ * @brief Apply rules to the top node of the equation until none of them matches.
+ * 
+ * @param equation
+ * @return true if any rule was applied
+ */
+static bool simplify_node(Equation* equation);
 
 /**
- * @brief Collapse the equation to constant.
+ * @brief Rewrite the top node of the equation as the rule says.
  * 
- * @param equation 
+ * @param equation
+ * @param rule rule matching the node
  */
-static void wrap_constants(Equation* equation);
+static void apply_rule(Equation* equation, const RewriteRule* rule);
 
 /**
- * @brief Resolve useless operations, such as multiplication by 1 or 0.
+ * @brief Free single node, if it was not allocated from an arena.
  * 
  * @param equation
  */
-static void rm_useless(Equation* equation);
+static inline void release_node(Equation* equation);
 
 Equation* Equation_new(NodeType type, NodeValue value, Equation* left, Equation* right, int* const err_code) {
-    Equation* equation = (Equation*) calloc(1, sizeof(*equation));
+    EquationArena* arena = EquationArena_active();
+    Equation* equation = arena ? EquationArena_alloc(arena, err_code) : (Equation*) calloc(1, sizeof(*equation));
     _LOG_FAIL_CHECK_(equation, "error", ERROR_REPORTS, return NULL, err_code, ENOMEM);
 
     equation->type = type;
+    equation->from_arena = arena != NULL;
     equation->value = value;
     equation->left = left;
     equation->right = right;
@@ -58,12 +174,31 @@ void Equation_dtor(Equation** equation) {
     if (!equation)  return;
     if (!*equation) return;
 
-    if ((*equation)->left)  Equation_dtor(&(*equation)->left);
-    if ((*equation)->right) Equation_dtor(&(*equation)->right);
-    free(*equation);
+    //* Left branches are rotated up into the right spine, so the tree is freed without a stack.
+    Equation* node = (*equation)->from_arena ? NULL : *equation;
+    while (node) {
+        if (node->left && node->left->from_arena) node->left = NULL;
+
+        if (node->left) {
+            Equation* left = node->left;
+            node->left = left->right;
+            left->right = node;
+            node = left;
+        } else {
+            Equation* right = node->right;
+            free(node);
+            node = right && !right->from_arena ? right : NULL;
+        }
+    }
+
     *equation = NULL;
 }
 
+static inline void release_node(Equation* equation) {
+    if (equation && !equation->from_arena) free(equation);
+}
+
+//* Number of drawn graphs (updated atomically).
 static size_t PictCount = 0;
 
 void _Equation_dump_graph(const Equation* equation, unsigned int importance) {
@@ -81,7 +216,19 @@ void _Equation_dump_graph(const Equation* equation, unsigned int importance) {
 
     if (status & ~TREE_INV_CONNECTIONS) return_clean();
 
-    FILE* temp_file = fopen(TREE_TEMP_DOT_FNAME, "w");
+    size_t size = Equation_size(equation);
+    if (size > TREE_DUMP_MAX_SIZE) {
+        _log_printf(importance, "tree_dump", "\tGraph of %ld nodes is too big to be drawn.\n", (long int)size);
+        return_clean();
+    }
+
+    long int pict_id = (long int)__atomic_add_fetch(&PictCount, 1, __ATOMIC_RELAXED);
+
+    const char* dot_name = dynamic_sprintf(TREE_TEMP_DOT_FNAME, pict_id);
+    _LOG_FAIL_CHECK_(dot_name, "error", ERROR_REPORTS, return_clean(), NULL, EFAULT);
+    track_allocation(dot_name, free_variable);
+
+    FILE* temp_file = fopen(dot_name, "w");
     
     _LOG_FAIL_CHECK_(temp_file, "error", ERROR_REPORTS, return_clean(), NULL, 0);
 
@@ -90,7 +237,7 @@ void _Equation_dump_graph(const Equation* equation, unsigned int importance) {
             "\tlayout=dot\n"
             , temp_file);
 
-    recursive_graph_dump(equation, temp_file);
+    write_graph(equation, temp_file);
 
     fputc('}', temp_file);
     fclose(temp_file);
@@ -100,15 +247,17 @@ void _Equation_dump_graph(const Equation* equation, unsigned int importance) {
     time_t raw_time = 0;
     time(&raw_time);
 
-    const char* pict_name = dynamic_sprintf(TREE_LOG_ASSET_FOLD_NAME "/pict%04ld_%ld.png", (long int)++PictCount, raw_time);
+    const char* pict_name = dynamic_sprintf(TREE_LOG_ASSET_FOLD_NAME "/pict%04ld_%ld.png", pict_id, raw_time);
     _LOG_FAIL_CHECK_(pict_name, "error", ERROR_REPORTS, return_clean(), NULL, EFAULT);
     track_allocation(pict_name, free_variable);
 
-    const char* draw_request = dynamic_sprintf("dot -Tpng -o %s " TREE_TEMP_DOT_FNAME, pict_name);
+    const char* draw_request = dynamic_sprintf("dot -Tpng -o %s %s", pict_name, dot_name);
     track_allocation(draw_request, free_variable);
 
     log_printf(STATUS_REPORTS, "status", "Draw request: %s.\n", draw_request);
-    _LOG_FAIL_CHECK_(!system(draw_request), "error", ERROR_REPORTS, return_clean(), NULL, EAGAIN);
+    int draw_status = system(draw_request);
+    remove(dot_name);
+    _LOG_FAIL_CHECK_(!draw_status, "error", ERROR_REPORTS, return_clean(), NULL, EAGAIN);
 
     _log_printf(importance, "tree_dump",
                 "\n<details><summary>Graph</summary><img src=\"%s\"></details>\n", pict_name);
@@ -116,138 +265,46 @@ void _Equation_dump_graph(const Equation* equation, unsigned int importance) {
     return_clean();
 }
 
-#define in_brackets(left, code, right, condition) do {  \
-    bool __cond = (condition);                          \
-    if (__cond) caret_printf(caret, left);              \
-    code                                                \
-    if (__cond) caret_printf(caret, right);             \
-} while (0)
-
-void Equation_write_as_formula(const Equation* equation, caret_t* caret, int* const err_code) {
-    _LOG_FAIL_CHECK_(!Equation_get_error(equation), "error", ERROR_REPORTS, return, err_code, EINVAL);
-    _LOG_FAIL_CHECK_(caret, "error", ERROR_REPORTS, return, err_code, EINVAL);
-
-    switch (equation->type) {
-    case TYPE_VAR:
-        caret_printf(caret, "%c", (char)equation->value.id);
-        break;
-
-    case TYPE_CONST:
-        caret_printf(caret, "(%lg)", equation->value.dbl);
-        break;
+bool Equation_write_as_formula(const Equation* equation, caret_t* caret, const char* end, int* const err_code) {
+    return write_equation(equation, caret, end, write_formula_step, err_code);
+}
 
-    case TYPE_OP: {
-        switch (equation->value.op) {
-        case OP_SIN:
-        case OP_COS:
-            caret_printf(caret, "%s(deg", OP_TEXT_REPS[equation->value.op]);
-            in_brackets("(", { Equation_write_as_formula(equation->right, caret); }, "))", true);
-            break;
-        case OP_LN:
-            caret_printf(caret, "%s", OP_TEXT_REPS[equation->value.op]);
-            in_brackets("(", { Equation_write_as_formula(equation->right, caret); }, ")", true);
-            break;
-        case OP_ADD:
-        case OP_SUB:
-        case OP_MUL:
-        case OP_DIV:
-        case OP_POW:
-            in_brackets("(", { Equation_write_as_formula(equation->left, caret); }, ")", true);
-            caret_printf(caret, "%s", OP_TEXT_REPS[equation->value.op]);
-            in_brackets("(", { Equation_write_as_formula(equation->right, caret); }, ")", true);
-            break;
-        OP_SWITCH_END
-        }
+bool Equation_write_as_tex(const Equation* equation, caret_t* caret, const char* end, int* const err_code) {
+    return write_equation(equation, caret, end, write_tex_step, err_code);
+}
 
-        break;
-    }
-    default:
-        log_printf(ERROR_REPORTS, "error", 
-            "Somehow NodeType equation->type had an incorrect value of %d.\n", equation->type);
-        break;
-    }
+bool Equation_write_as_c(const Equation* equation, caret_t* caret, const char* end, int* const err_code) {
+    return write_equation(equation, caret, end, write_c_step, err_code);
 }
 
-void Equation_write_as_tex(const Equation* equation, caret_t* caret, int* const err_code) {
-    _LOG_FAIL_CHECK_(!Equation_get_error(equation), "error", ERROR_REPORTS, return, err_code, EINVAL);
-    _LOG_FAIL_CHECK_(caret, "error", ERROR_REPORTS, return, err_code, EINVAL);
+bool Equation_write_as_input(const Equation* equation, caret_t* caret, const char* end, int* const err_code) {
+    return write_equation(equation, caret, end, write_input_step, err_code);
+}
 
-    switch (equation->type) {
-    case TYPE_VAR:
-        caret_printf(caret, "%c", (char)equation->value.id);
-        break;
+bool Equation_write_to_buffer(const Equation* equation, equation_writer_t* writer, char** buffer, size_t* capacity,
+                              size_t max_capacity, int* const err_code) {
+    _LOG_FAIL_CHECK_(writer && buffer && capacity, "error", ERROR_REPORTS, return false, err_code, EFAULT);
 
-    case TYPE_CONST:
-        if (equation->value.dbl >= 0) {
-            caret_printf(caret, "%lg", equation->value.dbl);
-        } else {
-            caret_printf(caret, "(%lg)", equation->value.dbl);
+    while (true) {
+        int write_error = 0;
+        caret_t caret = *buffer;
+        if (caret && writer(equation, &caret, *buffer + *capacity, &write_error)) {
+            *caret = '\0';
+            return true;
         }
-        break;
-
-    case TYPE_OP: {
-        switch (equation->value.op) {
-        case OP_POW:
-            in_brackets("(", { Equation_write_as_tex(equation->left, caret); }, ")",
-                equation->left->type == TYPE_OP);
-
-            caret_printf(caret, "^");
-
-            in_brackets("{", { Equation_write_as_tex(equation->right, caret); }, "}", true);
 
-            break;
-
-        case OP_DIV:
-            caret_printf(caret, "\\frac");
-
-            in_brackets("{", { Equation_write_as_tex(equation->left,  caret); }, "}", true);
-            in_brackets("{", { Equation_write_as_tex(equation->right, caret); }, "}", true);
+        //* Equation is written again into the bigger buffer, so the total work is at most twice the final write.
+        _LOG_FAIL_CHECK_(!caret || write_error == ENOBUFS, "error", ERROR_REPORTS, return false, err_code, write_error);
+        _LOG_FAIL_CHECK_(*capacity < max_capacity, "error", ERROR_REPORTS, return false, err_code, EFBIG);
 
-            break;
-
-        case OP_MUL:
-            in_brackets("(", { Equation_write_as_tex(equation->left, caret); }, ")",
-                equation->left->type == TYPE_OP &&
-                OP_PRIORITY[equation->left->value.op] < OP_PRIORITY[equation->value.op]);
+        size_t new_capacity = *capacity < EQ_WRITE_STEP_LENGTH ? 2 * EQ_WRITE_STEP_LENGTH : *capacity * 2;
+        if (new_capacity > max_capacity) new_capacity = max_capacity;
 
-            if (equation->right->type == TYPE_CONST)
-                caret_printf(caret, "\\cdot");
+        char* new_buffer = (char*) realloc(*buffer, new_capacity);
+        _LOG_FAIL_CHECK_(new_buffer, "error", ERROR_REPORTS, return false, err_code, ENOMEM);
 
-            in_brackets("(", { Equation_write_as_tex(equation->right, caret); }, ")",
-                equation->right->type == TYPE_OP &&
-                OP_PRIORITY[equation->right->value.op] < OP_PRIORITY[equation->value.op]);
-            
-            break;
-
-        case OP_SIN:
-        case OP_COS:
-        case OP_LN:
-            caret_printf(caret, "\\%s", OP_TEXT_REPS[equation->value.op]);
-            in_brackets("(", { Equation_write_as_tex(equation->right, caret); }, ")", true);
-            break;
-        
-        case OP_ADD:
-        case OP_SUB:
-            in_brackets("(", { Equation_write_as_tex(equation->left, caret); }, ")",
-                equation->left->type == TYPE_OP &&
-                OP_PRIORITY[equation->left->value.op] < OP_PRIORITY[equation->value.op]);
-
-            caret_printf(caret, "%s", OP_TEXT_REPS[equation->value.op]);
-
-            in_brackets("(", { Equation_write_as_tex(equation->right, caret); }, ")",
-                equation->right->type == TYPE_OP &&
-                OP_PRIORITY[equation->right->value.op] < OP_PRIORITY[equation->value.op]);
-            
-            break;
-        OP_SWITCH_END
-        }
-
-        break;
-    }
-    default:
-        log_printf(ERROR_REPORTS, "error", 
-            "Somehow NodeType equation->type had an incorrect value of %d.\n", equation->type);
-        break;
+        *buffer = new_buffer;
+        *capacity = new_capacity;
     }
 }
 
@@ -256,29 +313,38 @@ BinaryTree_status_t Equation_get_error(const Equation* equation) {
 
     if (equation == NULL) return TREE_NULL;
 
-    if (equation->type == TYPE_OP && (!equation->left || !equation->right)) status |= TREE_INV_CONNECTIONS;
-    if (equation->type != TYPE_OP && ( equation->left ||  equation->right)) status |= TREE_INV_CONNECTIONS;
+    TraversalStack stack = {};
+    TraversalStack_push(&stack, { .node = equation });
+
+    while (stack.size) {
+        const Equation* node = TraversalStack_pop(&stack).node;
 
-    #ifndef NDEBUG
-        if (equation->left)  status |= Equation_get_error(equation->left);
-        if (equation->right) status |= Equation_get_error(equation->right);
-    #endif
+        if (node->type == TYPE_OP && (!node->left || !node->right)) status |= TREE_INV_CONNECTIONS;
+        if (node->type != TYPE_OP && ( node->left ||  node->right)) status |= TREE_INV_CONNECTIONS;
+
+        #ifndef NDEBUG
+            if (node->left  && !TraversalStack_push(&stack, { .node = node->left  })) break;
+            if (node->right && !TraversalStack_push(&stack, { .node = node->right })) break;
+        #endif
+    }
+
+    TraversalStack_dtor(&stack);
 
     return status;
 }
 
 Equation* Equation_copy(const Equation* equation) {
     if (!equation) return NULL;
-    return Equation_new(equation->type, equation->value, Equation_copy(equation->left), Equation_copy(equation->right));
+    return fold_equation(equation, false, copy_step, NULL, NULL, &errno).result;
 }
 
 #define eq_cL Equation_copy(equation->left)
 #define eq_cR Equation_copy(equation->right)
-#define eq_dL Equation_diff(equation->left,  var_id)
-#define eq_dR Equation_diff(equation->right, var_id)
+#define eq_dL d_left
+#define eq_dR d_right
 
 static inline Equation* eq_const(double val) { return Equation_new(TYPE_CONST, { .dbl = val }, NULL, NULL); }
-static inline Equation* eq_var(char id) { return Equation_new(TYPE_VAR,    { .id = (unsigned long)id }, NULL, NULL); }
+static inline Equation* eq_var(symbol_t id) { return Equation_new(TYPE_VAR,    { .id = id }, NULL, NULL); }
 static inline Equation* eq_op(Operator op, Equation* left, Equation* right) {
     return Equation_new(TYPE_OP, { .op = op }, left, right); 
 }
@@ -295,29 +361,104 @@ static inline Equation* eq_ln (Equation* arg)                   { return eq_op(O
 
 Equation* Equation_diff(const Equation* equation, const uintptr_t var_id, int* const err_code) {
     if (!equation) return NULL;
+    return fold_equation(equation, true, diff_step, &var_id, NULL, err_code).result;
+}
+
+Equation* Equation_diff_parallel(const Equation* equation, const uintptr_t var_id, ThreadPool* pool,
+                                 size_t threshold, int* const err_code) {
+    if (!equation) return NULL;
+    _LOG_FAIL_CHECK_(pool, "error", ERROR_REPORTS, return NULL, err_code, EFAULT);
+
+    NodeMap derivatives = {};
+    NodeMap_ctor(&derivatives);
+
+    TraversalStack subtrees = {};
+    DiffChunk* chunks = NULL;
+    size_t chunk_count = 0;
+
+    bool fine = collect_subtrees(equation, threshold, &subtrees, &derivatives, err_code);
+
+    if (fine && subtrees.size) {
+        chunks = (DiffChunk*) calloc(subtrees.size, sizeof(*chunks));
+        _LOG_FAIL_CHECK_(chunks, "error", ERROR_REPORTS, fine = false, err_code, ENOMEM);
+    }
+
+    //* Small neighbouring subtrees are grouped, so every task has about the threshold nodes to differentiate.
+    double chunk_size = 0.0;
+    for (size_t id = 0; chunks && id < subtrees.size; ++id) {
+        if (!chunk_count || chunk_size >= (double)threshold) {
+            chunks[chunk_count++] = { .subtrees = &subtrees.frames[id], .count = 0,
+                                      .var_id = var_id, .derivatives = &derivatives };
+            chunk_size = 0.0;
+        }
+
+        ++chunks[chunk_count - 1].count;
+        chunk_size += subtrees.frames[id].value;
+    }
+
+    for (size_t id = 0; id < chunk_count; ++id) ThreadPool_submit(pool, diff_chunk, &chunks[id], err_code);
+    ThreadPool_wait(pool);
+
+    for (size_t id = 0; id < subtrees.size; ++id) {
+        _LOG_FAIL_CHECK_(NodeMap_find(&derivatives, subtrees.frames[id].node)->image,
+                         "error", ERROR_REPORTS, fine = false, err_code, ENOMEM);
+    }
+
+    Equation* derivative = fine ? fold_equation(equation, true, diff_step, &var_id, &derivatives, err_code).result : NULL;
+
+    //* Derivatives that did not make it into the result (because of failures) are released.
+    for (size_t id = 0; id < subtrees.size; ++id) {
+        NodeInfo* info = NodeMap_find(&derivatives, subtrees.frames[id].node);
+        if (!info->uses) Equation_dtor(&info->image);
+    }
+
+    free(chunks);
+    TraversalStack_dtor(&subtrees);
+    NodeMap_dtor(&derivatives);
+
+    return derivative;
+}
+
+static void diff_chunk(void* argument) {
+    DiffChunk* chunk = (DiffChunk*)argument;
+
+    for (size_t id = 0; id < chunk->count; ++id) {
+        const Equation* subtree = chunk->subtrees[id].node;
+        NodeMap_find(chunk->derivatives, subtree)->image = Equation_diff(subtree, chunk->var_id);
+    }
+}
+
+static void diff_step(const Equation* equation, const TraversalFrame* left, const TraversalFrame* right,
+                      TraversalFrame* result, const void* context, int* const err_code) {
+    const uintptr_t var_id = *(const uintptr_t*)context;
+
+    Equation* d_left  = left  ? left->result  : NULL;
+    Equation* d_right = right ? right->result : NULL;
+
     switch (equation->type) {
     case TYPE_VAR:
-        if (equation->value.id == var_id)
-            return eq_const(1);
-        else
-            return Equation_copy(equation);
-    
-    case TYPE_CONST: return eq_const(0);
+        result->result = eq_const(equation->value.id == var_id ? 1 : 0);
+        return;
+
+    case TYPE_CONST: result->result = eq_const(0); return;
 
     case TYPE_OP:
         switch (equation->value.op) {
-        case OP_ADD: return eq_add(eq_dL, eq_dR);
-        case OP_SUB: return eq_sub(eq_dL, eq_dR);
+        case OP_ADD: result->result = eq_add(eq_dL, eq_dR); return;
+        case OP_SUB: result->result = eq_sub(eq_dL, eq_dR); return;
 
-        case OP_MUL: return eq_add(eq_mul(eq_dL, eq_cR), eq_mul(eq_cL, eq_dR));
-        case OP_DIV: return eq_div(eq_sub(eq_mul(eq_dL, eq_cR), eq_mul(eq_dR, eq_cL)), eq_pow(eq_cR, eq_const(2)));
+        case OP_MUL: result->result = eq_add(eq_mul(eq_dL, eq_cR), eq_mul(eq_cL, eq_dR)); return;
+        case OP_DIV: result->result = eq_div(eq_sub(eq_mul(eq_dL, eq_cR), eq_mul(eq_dR, eq_cL)),
+                                             eq_pow(eq_cR, eq_const(2)));
+            return;
 
-        case OP_SIN: return eq_mul(eq_dR, eq_cos(eq_cR));
-        case OP_COS: return eq_mul(eq_dR, eq_neg(eq_sin(eq_cR)));
+        case OP_SIN: result->result = eq_mul(eq_dR, eq_cos(eq_cR)); return;
+        case OP_COS: result->result = eq_mul(eq_dR, eq_neg(eq_sin(eq_cR))); return;
 
-        case OP_POW: return eq_mul(eq_pow(eq_cL, eq_sub(eq_cR, eq_const(1))),
+        case OP_POW: result->result = eq_mul(eq_pow(eq_cL, eq_sub(eq_cR, eq_const(1))),
                                    eq_add( eq_mul(eq_cR, eq_dL),  eq_mul(eq_mul(eq_cL, eq_dR), eq_ln(eq_cL)) ));
-        case OP_LN:  return eq_div(eq_dR, eq_cR);
+            return;
+        case OP_LN:  result->result = eq_div(eq_dR, eq_cR); return;
         OP_SWITCH_END
         }
         break;
@@ -327,7 +468,10 @@ Equation* Equation_diff(const Equation* equation, const uintptr_t var_id, int* c
             "Somehow NodeType equation->type had an incorrect value of %d.\n", equation->type);
         break;
     }
-    return Equation_copy(equation);
+
+    Equation_dtor(&d_left);
+    Equation_dtor(&d_right);
+    result->result = Equation_copy(equation);
 }
 
 static bool eq_t_const(Equation* eq) { return eq->type == TYPE_CONST;  }
@@ -336,44 +480,113 @@ static bool eq_t_op(Equation* eq)    { return eq->type == TYPE_OP;     }
 #define eq_L ( equation->left )
 #define eq_R ( equation->right )
 
+size_t Equation_size(const Equation* equation) {
+    if (!equation) return 0;
+
+    size_t size = 0;
+
+    TraversalStack stack = {};
+    TraversalStack_push(&stack, { .node = equation });
+
+    while (stack.size) {
+        const Equation* node = TraversalStack_pop(&stack).node;
+        ++size;
+
+        if (node->left  && !TraversalStack_push(&stack, { .node = node->left  })) break;
+        if (node->right && !TraversalStack_push(&stack, { .node = node->right })) break;
+    }
+
+    TraversalStack_dtor(&stack);
+
+    return size;
+}
+
+bool Equation_equal(const Equation* alpha, const Equation* beta) {
+    bool equal = true;
+
+    //* Frames go in pairs, the top one belongs to beta.
+    TraversalStack stack = {};
+    TraversalStack_push(&stack, { .node = alpha });
+    TraversalStack_push(&stack, { .node = beta  });
+
+    while (equal && stack.size >= 2) {
+        const Equation* right = TraversalStack_pop(&stack).node;
+        const Equation* left  = TraversalStack_pop(&stack).node;
+
+        if (left == right) continue;
+        if (!left || !right || left->type != right->type) {
+            equal = false;
+            break;
+        }
+
+        switch (left->type) {
+        case TYPE_CONST: equal = is_equal(left->value.dbl, right->value.dbl); break;
+        case TYPE_VAR:   equal = left->value.id == right->value.id;           break;
+        case TYPE_OP:
+            equal = left->value.op == right->value.op &&
+                    TraversalStack_push(&stack, { .node = left->left   }) &&
+                    TraversalStack_push(&stack, { .node = right->left  }) &&
+                    TraversalStack_push(&stack, { .node = left->right  }) &&
+                    TraversalStack_push(&stack, { .node = right->right });
+            break;
+        default: equal = false; break;
+        }
+    }
+
+    TraversalStack_dtor(&stack);
+
+    return equal;
+}
+
 void Equation_simplify(Equation* equation, int* const err_code) {
     if (!equation) return;
     _LOG_FAIL_CHECK_(!Equation_get_error(equation), "error", ERROR_REPORTS, return, err_code, EINVAL);
 
-    if (!equation->type == TYPE_OP) return;
+    simplify_nodes(equation, NULL, err_code);
 
-    Equation_simplify(eq_L, err_code);
-    Equation_simplify(eq_R, err_code);
+    //* Only collected parts and their ancestors can match rules after collection.
+    NodeMap collected = {};
+    NodeMap_ctor(&collected);
 
-    wrap_constants(equation);
+    Equation_collect_terms(equation, &collected, err_code);
+    if (collected.size) simplify_nodes(equation, &collected, err_code);
 
-    rm_useless(equation);
+    NodeMap_dtor(&collected);
 }
 
 double Equation_calculate(const Equation* equation, const double x_value, int* const err_code) {
     if (!equation) return 0.0;
+    return fold_equation(equation, true, calculate_step, &x_value, NULL, err_code).value;
+}
+
+static void calculate_step(const Equation* equation, const TraversalFrame* left, const TraversalFrame* right,
+                           TraversalFrame* result, const void* context, int* const err_code) {
+    const double x_value = *(const double*)context;
+
+    double alpha = left  ? left->value  : 0.0;
+    double beta  = right ? right->value : 0.0;
+
+    result->value = 0.0;
 
     switch (equation->type) {
 
-    case TYPE_CONST: return equation->value.dbl;
-    case TYPE_VAR: return equation->value.id == 'x' ? x_value : 0.0;
+    case TYPE_CONST: result->value = equation->value.dbl; break;
+    case TYPE_VAR: result->value = equation->value.id == SYMBOL_X ? x_value : 0.0; break;
 
     case TYPE_OP: {
-        double alpha = Equation_calculate(equation->left, x_value);
-        double beta  = Equation_calculate(equation->right, x_value);
-
         switch (equation->value.op) {
 
-        case OP_ADD: return alpha + beta;
-        case OP_SUB: return alpha - beta;
-        case OP_MUL: return alpha * beta;
+        case OP_ADD: result->value = alpha + beta; break;
+        case OP_SUB: result->value = alpha - beta; break;
+        case OP_MUL: result->value = alpha * beta; break;
         case OP_DIV:
-            _LOG_FAIL_CHECK_(!is_equal(beta, 0.0), "error", ERROR_REPORTS, return INFINITY, err_code, EINVAL);
-            return alpha / beta;
-        case OP_COS: return cos(beta);
-        case OP_SIN: return sin(beta);
-        case OP_POW: return pow(alpha, beta);
-        case OP_LN:  return log(beta);
+            _LOG_FAIL_CHECK_(!is_equal(beta, 0.0), "error", ERROR_REPORTS, /* result is infinite */, err_code, EINVAL);
+            result->value = is_equal(beta, 0.0) ? INFINITY : alpha / beta;
+            break;
+        case OP_COS: result->value = cos(beta); break;
+        case OP_SIN: result->value = sin(beta); break;
+        case OP_POW: result->value = pow(alpha, beta); break;
+        case OP_LN:  result->value = log(beta); break;
         OP_SWITCH_END
 
         }
@@ -382,77 +595,61 @@ double Equation_calculate(const Equation* equation, const double x_value, int* c
     }
     default: break;
     }
-
-    return 0.0;
 }
 
-void recursive_graph_dump(const Equation* equation, FILE* file, int* const err_code) {
-    _LOG_FAIL_CHECK_(!(Equation_get_error(equation) & (~TREE_INV_CONNECTIONS)), 
-        "error", ERROR_REPORTS, return, err_code, EINVAL);
-    _LOG_FAIL_CHECK_(file, "error", ERROR_REPORTS, return, err_code, ENOENT);
+void Equation_calculate_batch(const Equation* equation, const double* xs, double* out, size_t count,
+                              int* const err_code) {
+    _LOG_FAIL_CHECK_(!Equation_get_error(equation), "error", ERROR_REPORTS, return, err_code, EINVAL);
 
-    if (!equation || !file) return;
-    fprintf(file, "\tV%p [shape=\"box\" label=\"", equation);
-    switch (equation->type) {
-        case TYPE_CONST: fprintf(file, "%lg", equation->value.dbl);             break;
-        case TYPE_OP: fprintf(file, "%s", OP_TEXT_REPS[equation->value.op]);    break;
-        case TYPE_VAR: fprintf(file, "%c", (char)equation->value.id);           break;
-        default:
-            log_printf(ERROR_REPORTS, "error", 
-                "Somehow NodeType equation->type had an incorrect value of %d.\n", equation->type);
-            break;
-    }
-    fprintf(file, "\"]\n");
+    EquationProgram program = {};
+    EquationProgram_ctor(&program, equation, err_code);
+    EquationProgram_calculate_batch(&program, xs, out, count, err_code);
+    EquationProgram_dtor(&program);
+}
 
-    if (equation->left) {
-        recursive_graph_dump(equation->left, file);
-        fprintf(file, "\tV%p -> V%p [arrowhead=\"none\"]\n", equation, equation->left);
-    }
-    if (equation->right) {
-        recursive_graph_dump(equation->right, file);
-        fprintf(file, "\tV%p -> V%p [arrowhead=\"none\"]\n", equation, equation->right);
-    }
+bool Equation_same_value(double alpha, double beta) {
+    if (isnan(alpha) || isnan(beta)) return isnan(alpha) && isnan(beta);
+    if (isinf(alpha) || isinf(beta)) return isinf(alpha) && isinf(beta) && signbit(alpha) == signbit(beta);
+
+    return fabs(alpha - beta) <= EQ_CALCULATE_TOLERANCE * fmax(1.0, fmax(fabs(alpha), fabs(beta)));
 }
 
-#define eq_value ( equation->value.dbl )
-#define get_value(eq) ( eq->value.dbl )
-#define as_op(operation) eq_value = get_value(eq_L) operation get_value(eq_R); break
+//* Name of the variable node, "?" if its symbol is unknown.
+static inline const char* var_name(const Equation* equation) {
+    const char* name = Symbol_name((symbol_t)equation->value.id);
+    return name ? name : "?";
+}
 
-static void wrap_constants(Equation* equation) {
-    if (!equation || !eq_t_op(equation)) return;
-    if (!eq_t_const(eq_L) || !eq_t_const(eq_R)) return;
+static void write_graph(const Equation* equation, FILE* file, int* const err_code) {
+    _LOG_FAIL_CHECK_(file, "error", ERROR_REPORTS, return, err_code, ENOENT);
 
-    if ( equation->value.op == OP_DIV && ( is_equal(get_value(eq_R), 0.0) ||
-        !is_equal(get_value(eq_L) / get_value(eq_R), round(get_value(eq_L) / get_value(eq_R))) ) ) return;
-    
-    if ( equation->value.op == OP_POW && !is_equal(get_value(eq_R), round(get_value(eq_R))) ) return;
-    
-    switch (equation->value.op) {
-    case OP_ADD: as_op(+);
-    case OP_SUB: as_op(-);
-    case OP_MUL: as_op(*);
-    case OP_DIV: as_op(/);
-    case OP_POW:
-        eq_value = pow(get_value(eq_L), get_value(eq_R));
-        break;
-    case OP_LN:
-        if (is_equal(get_value(eq_R), 1.0)) {
-            eq_value = 0.0;
-            break;
-        } else {
-            return;
+    TraversalStack stack = {};
+
+    bool fine = equation && TraversalStack_push(&stack, { .node = equation }, err_code);
+    while (fine && stack.size) {
+        const Equation* node = TraversalStack_pop(&stack).node;
+
+        fprintf(file, "\tV%p [shape=\"box\" label=\"", node);
+        switch (node->type) {
+            case TYPE_CONST: fprintf(file, "%lg", node->value.dbl);             break;
+            case TYPE_OP: fprintf(file, "%s", OP_TEXT_REPS[node->value.op]);    break;
+            case TYPE_VAR: fprintf(file, "%s", var_name(node));                break;
+            default:
+                log_printf(ERROR_REPORTS, "error", 
+                    "Somehow NodeType node->type had an incorrect value of %d.\n", node->type);
+                break;
         }
-    case OP_SIN:
-    case OP_COS:
-    default: return;
-    }
+        fprintf(file, "\"]\n");
 
-    equation->type = TYPE_CONST;
+        if (node->left)  fprintf(file, "\tV%p -> V%p [arrowhead=\"none\"]\n", node, node->left);
+        if (node->right) fprintf(file, "\tV%p -> V%p [arrowhead=\"none\"]\n", node, node->right);
 
-    Equation_dtor(&equation->left);
-    Equation_dtor(&equation->right);
-}
+        fine = (!node->right || TraversalStack_push(&stack, { .node = node->right }, err_code)) &&
+               (!node->left  || TraversalStack_push(&stack, { .node = node->left  }, err_code));
+    }
 
+    TraversalStack_dtor(&stack);
+}
 
 static inline void replace_node(Equation* alpha, Equation* beta) {    
     if (alpha->right != beta)
@@ -463,7 +660,7 @@ static inline void replace_node(Equation* alpha, Equation* beta) {
     alpha->left  = beta->left;
     alpha->right = beta->right;
     alpha->value = beta->value;
-    free(beta);
+    release_node(beta);
 }
 
 static inline void set_to_const(Equation* equation, double value) {
@@ -473,44 +670,453 @@ static inline void set_to_const(Equation* equation, double value) {
     equation->value.dbl = value;
 }
 
-static void rm_useless(Equation* equation) {
+static void simplify_nodes(Equation* equation, const NodeMap* seeds, int* const err_code) {
     if (!equation || !eq_t_op(equation)) return;
-    if (!eq_t_const(eq_L) && !eq_t_const(eq_R)) return;
-    
-    Equation* const_branch = eq_t_const(eq_L) ? eq_L : eq_R;
-    Equation* undef_branch = eq_t_const(eq_L) ? eq_R : eq_L;
-
-    switch (equation->value.op) {
-    case OP_ADD:
-    case OP_SUB:
-        if (is_equal(const_branch->value.dbl, 0.0))
-            replace_node(equation, undef_branch);
+
+    SimplifyItem* items = NULL;
+    size_t size = 0, capacity = 0;
+
+    TraversalStack stack = {};
+
+    bool fine = TraversalStack_push(&stack, { .node = equation, .index = SIMPLIFY_ROOT }, err_code);
+    while (fine && stack.size) {
+        TraversalFrame frame = TraversalStack_pop(&stack);
+
+        if (size == capacity) {
+            capacity = capacity ? capacity * 2 : TRAVERSAL_LOCAL_CAPACITY;
+            SimplifyItem* new_items = (SimplifyItem*) realloc(items, capacity * sizeof(*items));
+            _LOG_FAIL_CHECK_(new_items, "error", ERROR_REPORTS, /* the pass is abandoned */, err_code, ENOMEM);
+
+            fine = new_items != NULL;
+            if (!fine) break;
+            items = new_items;
+        }
+
+        //* Nodes of the stack belong to the equation being simplified, so they can be modified.
+        SimplifyItem* item = &items[size];
+        *item = { .node = (Equation*)frame.node, .parent = frame.index };
+
+        item->seed = seeds && NodeMap_find(seeds, item->node);
+        item->seeded = item->seed || (item->parent != SIMPLIFY_ROOT && items[item->parent].seeded);
+        item->queued = !seeds || item->seeded;
+
+        Equation* node = item->node;
+
+        //* Seeds collapsed into leaves get no items, so their parents are queued right away.
+        if (seeds && !item->queued)
+            item->queued = (!eq_t_op(node->right) && NodeMap_find(seeds, node->right)) ||
+                           (!eq_t_op(node->left)  && NodeMap_find(seeds, node->left));
+
+        fine = (!eq_t_op(node->right) || TraversalStack_push(&stack, { .node = node->right, .index = size }, err_code)) &&
+               (!eq_t_op(node->left)  || TraversalStack_push(&stack, { .node = node->left,  .index = size }, err_code));
+
+        ++size;
+    }
+
+    TraversalStack_dtor(&stack);
+
+    //* Rewrites happen in place and only free nodes below the rewritten one, which have been checked already.
+    for (size_t id = size; fine && id-- > 0;) {
+        SimplifyItem* item = &items[id];
+        if (!item->queued) continue;
+
+        bool changed = simplify_node(item->node) || item->seed;
+        if (changed && item->parent != SIMPLIFY_ROOT) items[item->parent].queued = true;
+    }
+
+    free(items);
+}
+
+static bool simplify_node(Equation* equation) {
+    bool changed = false;
+
+    const RewriteRule* rule = NULL;
+    while (eq_t_op(equation) && (rule = find_rewrite_rule(equation->value.op, equation->left, equation->right))) {
+        apply_rule(equation, rule);
+        changed = true;
+    }
+
+    return changed;
+}
+
+static void apply_rule(Equation* equation, const RewriteRule* rule) {
+    double folded = 0.0;
+    Equation* product = NULL;
+
+    switch (rule->action) {
+    case ACT_FOLD:
+        fold_constants(equation->value.op, eq_L->value.dbl, eq_R->value.dbl, &folded);
+        set_to_const(equation, folded);
+        break;
+    case ACT_LEFT:  replace_node(equation, eq_L); break;
+    case ACT_RIGHT: replace_node(equation, eq_R); break;
+    case ACT_ZERO:  set_to_const(equation, 0.0);  break;
+    case ACT_ONE:   set_to_const(equation, 1.0);  break;
+    case ACT_NEGATE:
+        eq_L->value.dbl = -1.0;
+        equation->value.op = OP_MUL;
+        break;
+    case ACT_DOUBLE:
+        Equation_dtor(&eq_L);
+        eq_L = eq_const(2);
+        equation->value.op = OP_MUL;
+        break;
+    case ACT_SQUARE:
+        Equation_dtor(&eq_R);
+        eq_R = eq_const(2);
+        equation->value.op = OP_POW;
+        break;
+    case ACT_MERGE_MUL:
+        product = eq_t_const(eq_L) ? eq_R : eq_L;
+        const_mul_factor(product)->value.dbl *= (eq_t_const(eq_L) ? eq_L : eq_R)->value.dbl;
+        replace_node(equation, product);
+        break;
+    case ACT_MERGE_POW:
+        eq_L->right->value.dbl *= eq_R->value.dbl;
+        replace_node(equation, eq_L);
+        break;
+    default:
+        log_printf(ERROR_REPORTS, "error", "Somehow RuleAction rule->action had an incorrect value of %d.\n", rule->action);
+        break;
+    }
+}
+
+static void copy_step(const Equation* node, const TraversalFrame* left, const TraversalFrame* right,
+                      TraversalFrame* result, const void* context, int* const err_code) {
+    (void) context;
+    result->result = Equation_new(node->type, node->value, left ? left->result : NULL, right ? right->result : NULL,
+                                  err_code);
+}
+
+static bool write_equation(const Equation* equation, caret_t* caret, const char* end, write_step_t* step,
+                           int* const err_code) {
+    _LOG_FAIL_CHECK_(!Equation_get_error(equation), "error", ERROR_REPORTS, return false, err_code, EINVAL);
+    _LOG_FAIL_CHECK_(caret && *caret && end, "error", ERROR_REPORTS, return false, err_code, EINVAL);
+
+    TraversalStack stack = {};
+
+    bool fine = TraversalStack_push(&stack, { .node = equation }, err_code);
+    while (fine && stack.size) {
+        TraversalFrame frame = TraversalStack_pop(&stack);
+        const Equation* node = frame.node;
+
+        //* Overflow is not logged, as callers usually retry with a bigger buffer.
+        if (end - *caret <= (ptrdiff_t)EQ_WRITE_STEP_LENGTH) {
+            if (err_code) *err_code = ENOBUFS;
+            fine = false;
+            break;
+        }
+
+        step(node, frame.stage, caret, err_code);
+
+        if (frame.stage != STAGE_ENTER || node->type != TYPE_OP) continue;
+
+        fine = TraversalStack_push(&stack, { .node = node, .stage = STAGE_EXIT  }, err_code) &&
+               TraversalStack_push(&stack, { .node = node->right                }, err_code) &&
+               TraversalStack_push(&stack, { .node = node, .stage = STAGE_INFIX }, err_code) &&
+               (has_placeholder(node) || TraversalStack_push(&stack, { .node = node->left }, err_code));
+    }
+
+    TraversalStack_dtor(&stack);
+
+    return fine;
+}
+
+static void write_formula_step(const Equation* equation, TraversalStage stage, caret_t* caret, int* const err_code) {
+    switch (equation->type) {
+    case TYPE_VAR:
+        caret_printf(caret, "%s", var_name(equation));
+        break;
+
+    case TYPE_CONST:
+        caret_printf(caret, "(%lg)", equation->value.dbl);
+        break;
+
+    case TYPE_OP: {
+        switch (equation->value.op) {
+        case OP_SIN:
+        case OP_COS:
+            if (stage == STAGE_ENTER) caret_printf(caret, "%s(deg(", OP_TEXT_REPS[equation->value.op]);
+            if (stage == STAGE_EXIT)  caret_printf(caret, "))");
+            break;
+        case OP_LN:
+            if (stage == STAGE_ENTER) caret_printf(caret, "%s(", OP_TEXT_REPS[equation->value.op]);
+            if (stage == STAGE_EXIT)  caret_printf(caret, ")");
+            break;
+        case OP_ADD:
+        case OP_SUB:
+        case OP_MUL:
+        case OP_DIV:
+        case OP_POW:
+            if (stage == STAGE_ENTER) caret_printf(caret, "(");
+            if (stage == STAGE_INFIX) caret_printf(caret, ")%s(", OP_TEXT_REPS[equation->value.op]);
+            if (stage == STAGE_EXIT)  caret_printf(caret, ")");
+            break;
+        OP_SWITCH_END
+        }
+
+        break;
+    }
+    default:
+        log_printf(ERROR_REPORTS, "error", 
+            "Somehow NodeType equation->type had an incorrect value of %d.\n", equation->type);
+        break;
+    }
+}
+
+static void write_tex_step(const Equation* equation, TraversalStage stage, caret_t* caret, int* const err_code) {
+    switch (equation->type) {
+    case TYPE_VAR:
+        //* Longer names would be typeset as a product of letters.
+        if (var_name(equation)[1] == '\0') caret_printf(caret, "%s", var_name(equation));
+        else caret_printf(caret, "\\mathit{%s}", var_name(equation));
+        break;
+
+    case TYPE_CONST:
+        if (equation->value.dbl >= 0) {
+            caret_printf(caret, "%lg", equation->value.dbl);
+        } else {
+            caret_printf(caret, "(%lg)", equation->value.dbl);
+        }
+        break;
+
+    case TYPE_OP: {
+        bool left_brackets = equation->left->type == TYPE_OP &&
+                             OP_PRIORITY[equation->left->value.op] < OP_PRIORITY[equation->value.op];
+        bool right_brackets = equation->right->type == TYPE_OP &&
+                              OP_PRIORITY[equation->right->value.op] < OP_PRIORITY[equation->value.op];
+
+        switch (equation->value.op) {
+        case OP_POW:
+            if (stage == STAGE_ENTER && equation->left->type == TYPE_OP) caret_printf(caret, "(");
+            if (stage == STAGE_INFIX && equation->left->type == TYPE_OP) caret_printf(caret, ")");
+            if (stage == STAGE_INFIX) caret_printf(caret, "^{");
+            if (stage == STAGE_EXIT)  caret_printf(caret, "}");
+            break;
+
+        case OP_DIV:
+            if (stage == STAGE_ENTER) caret_printf(caret, "\\frac{");
+            if (stage == STAGE_INFIX) caret_printf(caret, "}{");
+            if (stage == STAGE_EXIT)  caret_printf(caret, "}");
+            break;
+
+        case OP_MUL:
+        case OP_ADD:
+        case OP_SUB:
+            if (stage == STAGE_ENTER && left_brackets) caret_printf(caret, "(");
+
+            if (stage == STAGE_INFIX) {
+                if (left_brackets) caret_printf(caret, ")");
+
+                if (equation->value.op != OP_MUL) {
+                    caret_printf(caret, "%s", OP_TEXT_REPS[equation->value.op]);
+                } else if (equation->right->type == TYPE_CONST) {
+                    caret_printf(caret, "\\cdot");
+                }
+
+                if (right_brackets) caret_printf(caret, "(");
+            }
+
+            if (stage == STAGE_EXIT && right_brackets) caret_printf(caret, ")");
+            break;
+
+        case OP_SIN:
+        case OP_COS:
+        case OP_LN:
+            if (stage == STAGE_ENTER) caret_printf(caret, "\\%s(", OP_TEXT_REPS[equation->value.op]);
+            if (stage == STAGE_EXIT)  caret_printf(caret, ")");
+            break;
+        OP_SWITCH_END
+        }
+
+        break;
+    }
+    default:
+        log_printf(ERROR_REPORTS, "error", 
+            "Somehow NodeType equation->type had an incorrect value of %d.\n", equation->type);
+        break;
+    }
+}
+
+static void write_c_step(const Equation* equation, TraversalStage stage, caret_t* caret, int* const err_code) {
+    switch (equation->type) {
+    case TYPE_VAR:
+        caret_printf(caret, "%s", equation->value.id == SYMBOL_X ? "x" : "0.0");
+        break;
+
+    case TYPE_CONST: {
+        double value = equation->value.dbl;
+
+        if (isnan(value)) {
+            caret_printf(caret, "NAN");
+        } else if (isinf(value)) {
+            caret_printf(caret, "%sINFINITY", value < 0 ? "-" : "");
+        } else {
+            //* Constants are written exactly and always as double literals, so 1/2 is not an integer division.
+            char literal[32] = "";
+            snprintf(literal, sizeof(literal), "%.17g", value);
+            if (!strpbrk(literal, ".e")) strncat(literal, ".0", sizeof(literal) - strlen(literal) - 1);
+
+            caret_printf(caret, value < 0 ? "(%s)" : "%s", literal);
+        }
+        break;
+    }
+
+    case TYPE_OP: {
+        switch (equation->value.op) {
+        case OP_SIN:
+        case OP_COS:
+        case OP_LN:
+            if (stage == STAGE_ENTER) caret_printf(caret, "%s(", equation->value.op == OP_LN ? "log" :
+                                                                 OP_TEXT_REPS[equation->value.op]);
+            if (stage == STAGE_EXIT)  caret_printf(caret, ")");
+            break;
+        case OP_POW:
+            if (stage == STAGE_ENTER) caret_printf(caret, "pow(");
+            if (stage == STAGE_INFIX) caret_printf(caret, ", ");
+            if (stage == STAGE_EXIT)  caret_printf(caret, ")");
+            break;
+        case OP_ADD:
+        case OP_SUB:
+        case OP_MUL:
+        case OP_DIV:
+            if (stage == STAGE_ENTER) caret_printf(caret, "(");
+            if (stage == STAGE_INFIX) caret_printf(caret, " %s ", OP_TEXT_REPS[equation->value.op]);
+            if (stage == STAGE_EXIT)  caret_printf(caret, ")");
+            break;
+        OP_SWITCH_END
+        }
+
+        break;
+    }
+    default:
+        log_printf(ERROR_REPORTS, "error", 
+            "Somehow NodeType equation->type had an incorrect value of %d.\n", equation->type);
+        break;
+    }
+}
+
+static bool needs_brackets(Operator op, const Equation* operand, bool is_left) {
+    if (operand->type != TYPE_OP || has_placeholder(operand)) return false;
+
+    int priority = OP_PRIORITY[op];
+    int operand_priority = OP_PRIORITY[operand->value.op];
+    if (operand_priority != priority) return operand_priority < priority;
+
+    //* a-(b-c) and (a^b)^c keep their brackets, a-b-c and a^b^c do not need them.
+    return is_left == (OP_ASSOCIATIVITY[op] == ASSOC_RIGHT);
+}
+
+static void write_input_number(double value, caret_t* caret) {
+    //* Input has no unary minus and no literals for infinities, so they are written as expressions.
+    if (isnan(value)) {
+        caret_printf(caret, "(0/0)");
+        return;
+    }
+
+    if (isinf(value)) {
+        caret_printf(caret, value < 0 ? "(0-1/0)" : "(1/0)");
+        return;
+    }
+
+    //* Shortest of the two precisions that is read back as the same value.
+    char literal[32] = "";
+    snprintf(literal, sizeof(literal), "%.15g", fabs(value));
+    double parsed = strtod(literal, NULL);
+    if (parsed < fabs(value) || parsed > fabs(value)) snprintf(literal, sizeof(literal), "%.17g", fabs(value));
+
+    caret_printf(caret, value < 0 ? "(0-%s)" : "%s", literal);
+}
+
+static void write_input_step(const Equation* equation, TraversalStage stage, caret_t* caret, int* const err_code) {
+    switch (equation->type) {
+    case TYPE_VAR:
+        caret_printf(caret, "%s", var_name(equation));
         break;
-    case OP_MUL:
-        if (is_equal(const_branch->value.dbl, 1.0))
-            replace_node(equation, undef_branch);
-        else if (is_equal(const_branch->value.dbl, 0.0))
-            set_to_const(equation, 0.0);
+
+    case TYPE_CONST:
+        write_input_number(equation->value.dbl, caret);
         break;
-    case OP_DIV:
-        if (eq_R->type == TYPE_CONST && is_equal(eq_R->value.dbl, 1.0))
-            replace_node(equation, eq_L);
-        else if (eq_L->type == TYPE_CONST && is_equal(eq_L->value.dbl, 0.0))
-            set_to_const(equation, 0.0);
+
+    case TYPE_OP: {
+        switch (equation->value.op) {
+        case OP_SIN:
+        case OP_COS:
+        case OP_LN:
+            if (stage == STAGE_ENTER) caret_printf(caret, "%s(", OP_TEXT_REPS[equation->value.op]);
+            if (stage == STAGE_EXIT)  caret_printf(caret, ")");
+            break;
+        case OP_ADD:
+        case OP_SUB:
+        case OP_MUL:
+        case OP_DIV:
+        case OP_POW: {
+            bool left_brackets  = needs_brackets(equation->value.op, equation->left,  true);
+            bool right_brackets = needs_brackets(equation->value.op, equation->right, false);
+
+            if (stage == STAGE_ENTER && left_brackets) caret_printf(caret, "(");
+
+            if (stage == STAGE_INFIX) {
+                if (left_brackets) caret_printf(caret, ")");
+                caret_printf(caret, "%s", OP_TEXT_REPS[equation->value.op]);
+                if (right_brackets) caret_printf(caret, "(");
+            }
+
+            if (stage == STAGE_EXIT && right_brackets) caret_printf(caret, ")");
+            break;
+        }
+        OP_SWITCH_END
+        }
+
         break;
-    case OP_POW:
-        if (eq_R->type == TYPE_CONST && is_equal(eq_R->value.dbl, 1.0))
-            replace_node(equation, eq_L);
-        else if (eq_R->type == TYPE_CONST && is_equal(eq_R->value.dbl, 0.0))
-            set_to_const(equation, 1.0);
-        else if (eq_L->type == TYPE_CONST && is_equal(eq_L->value.dbl, 1.0)) 
-            set_to_const(equation, 1.0);
-        else if (eq_L->type == TYPE_CONST && is_equal(eq_L->value.dbl, 0.0))
-            set_to_const(equation, 0.0);
+    }
+    default:
+        log_printf(ERROR_REPORTS, "error", 
+            "Somehow NodeType equation->type had an incorrect value of %d.\n", equation->type);
         break;
-    case OP_LN:
-    case OP_COS:
-    case OP_SIN:
-    default: return;
     }
 }
+
+static bool collect_subtrees(const Equation* equation, size_t threshold, TraversalStack* subtrees, NodeMap* map,
+                             int* const err_code) {
+    TraversalStack stack = {};
+    TraversalStack sizes = {};
+
+    bool fine = TraversalStack_push(&stack, { .node = equation }, err_code);
+    while (fine && stack.size) {
+        TraversalFrame frame = TraversalStack_pop(&stack);
+        const Equation* node = frame.node;
+
+        bool visit_left = node->left && !has_placeholder(node);
+
+        if (frame.stage == STAGE_ENTER && (node->left || node->right)) {
+            fine = TraversalStack_push(&stack, { .node = node, .stage = STAGE_EXIT }, err_code) &&
+                   (!node->right || TraversalStack_push(&stack, { .node = node->right }, err_code)) &&
+                   (!visit_left  || TraversalStack_push(&stack, { .node = node->left  }, err_code));
+            continue;
+        }
+
+        TraversalFrame right = node->right ? TraversalStack_pop(&sizes) : TraversalFrame {};
+        TraversalFrame left  = visit_left  ? TraversalStack_pop(&sizes) : TraversalFrame {};
+
+        double size = 1.0 + left.value + right.value;
+
+        if (size > (double)threshold) {
+            const TraversalFrame* branches[] = { &left, &right };
+
+            for (size_t id = 0; fine && id < 2; ++id) {
+                const TraversalFrame* branch = branches[id];
+                if (!branch->node || branch->value > (double)threshold || NodeMap_find(map, branch->node)) continue;
+
+                fine = NodeMap_get(map, branch->node, err_code) && TraversalStack_push(subtrees, *branch, err_code);
+            }
+        }
+
+        fine = fine && TraversalStack_push(&sizes, { .node = node, .value = size }, err_code);
+    }
+
+    TraversalStack_dtor(&stack);
+    TraversalStack_dtor(&sizes);
+
+    return fine;
+}
@@ -18,24 +18,52 @@
 #include <errno.h>
 
 #include "tree_config.h"
+#include "symbol_table.h"
 #include "bin_tree_reports.h"
 #include "file_helper.h"
 
+struct ThreadPool;
+
+//* Subtrees of this size or smaller are differentiated by a single thread.
+static const size_t EQ_PARALLEL_DIFF_THRESHOLD = 4096;
+
+//* Space writers keep free for the next part of the node, longest parts are variable names.
+static const size_t EQ_WRITE_STEP_LENGTH = SYMBOL_MAX_LENGTH + 64;
+
 union NodeValue {
-    uintptr_t id;
+    uintptr_t id;   //* Symbol of the variable (see symbol_table.h).
     Operator op;
     double dbl;
 };
 
 struct Equation {
     NodeType type = {};
+    bool from_arena = false;
     NodeValue value = { .id = 0 };
 
     Equation* left = NULL;
     Equation* right = NULL;
 };
 
+/**
+ * @brief Create new equation node.
+ * Node is taken from the arena bound with EquationArena_bind() if there is one, or from the heap otherwise.
+ * 
+ * @param type node type
+ * @param value node value
+ * @param left left branch
+ * @param right right branch
+ * @param err_code variable to use as errno
+ * @return pointer to the new node
+ */
 Equation* Equation_new(NodeType type, NodeValue value, Equation* left, Equation* right, int* const err_code = &errno);
+
+/**
+ * @brief Destroy the equation and set its pointer to NULL.
+ * Subtrees allocated from an arena are left untouched, as they are released together with their arena.
+ * 
+ * @param node
+ */
 void Equation_dtor(Equation** node);
 
 /**
@@ -62,18 +90,63 @@ void _Equation_dump_graph(const Equation* equation, unsigned int importance);
  * 
  * @param node tree node to write to the file
  * @param caret write destination
- * @param err_code variable to use as errno
+ * @param end end of the destination buffer
+ * @param err_code variable to use as errno (ENOBUFS if the equation does not fit)
+ * @return false if the equation could not be written
  */
-void Equation_write_as_formula(const Equation* equation, caret_t* caret, int* const err_code = &errno);
+bool Equation_write_as_formula(const Equation* equation, caret_t* caret, const char* end, int* const err_code = &errno);
 
 /**
  * @brief Write equation in tex format.
  * 
  * @param node tree node to write to the file
  * @param caret write destination
- * @param err_code variable to use as errno
+ * @param end end of the destination buffer
+ * @param err_code variable to use as errno (ENOBUFS if the equation does not fit)
+ * @return false if the equation could not be written
+ */
+bool Equation_write_as_tex(const Equation* equation, caret_t* caret, const char* end, int* const err_code = &errno);
+
+/**
+ * @brief Write equation as a C expression of the double variable x.
+ * Variables other than X are written as 0, like in Equation_calculate().
+ * 
+ * @param node tree node to write to the file
+ * @param caret write destination
+ * @param end end of the destination buffer
+ * @param err_code variable to use as errno (ENOBUFS if the equation does not fit)
+ * @return false if the equation could not be written
+ */
+bool Equation_write_as_c(const Equation* equation, caret_t* caret, const char* end, int* const err_code = &errno);
+
+/**
+ * @brief Write equation in the syntax of the program input, so it can be parsed back.
+ * 
+ * @param node tree node to write to the file
+ * @param caret write destination
+ * @param end end of the destination buffer
+ * @param err_code variable to use as errno (ENOBUFS if the equation does not fit)
+ * @return false if the equation could not be written
+ */
+bool Equation_write_as_input(const Equation* equation, caret_t* caret, const char* end, int* const err_code = &errno);
+
+//* One of the Equation_write_as_...() functions.
+typedef bool equation_writer_t(const Equation* equation, caret_t* caret, const char* end, int* const err_code);
+
+/**
+ * @brief Write the equation into the heap buffer, growing the buffer until the equation fits.
+ * Written text is '\0'-terminated.
+ * 
+ * @param equation
+ * @param writer function to write the equation with
+ * @param buffer buffer allocated with malloc() (is reallocated when it grows)
+ * @param capacity size of the buffer (is updated when it grows)
+ * @param max_capacity size the buffer is not grown beyond
+ * @param err_code variable to use as errno (EFBIG if the equation does not fit)
+ * @return false if the equation could not be written
  */
-void Equation_write_as_tex(const Equation* equation, caret_t* caret, int* const err_code = &errno);
+bool Equation_write_to_buffer(const Equation* equation, equation_writer_t* writer, char** buffer, size_t* capacity,
+                              size_t max_capacity, int* const err_code = &errno);
 
 /**
  * @brief Get status of the equation.
@@ -100,8 +173,41 @@ Equation* Equation_copy(const Equation* equation);
  */
 Equation* Equation_diff(const Equation* equation, const uintptr_t var_id, int* const err_code = &errno);
 
+/**
+ * @brief Differentiate the equation, differentiating its independent subtrees in parallel.
+ * The equation is split into the smallest number of subtrees not bigger than the threshold,
+ * they are differentiated by pool tasks, and their derivatives are combined in the calling thread.
+ * 
+ * @param equation
+ * @param var_id ID of the variable to differentiate from
+ * @param pool pool to run tasks in
+ * @param threshold maximum size of a subtree to differentiate in one task
+ * @param err_code variable to use as errno
+ * @return pointer to the differentiated equation
+ */
+Equation* Equation_diff_parallel(const Equation* equation, const uintptr_t var_id, ThreadPool* pool,
+                                 size_t threshold = EQ_PARALLEL_DIFF_THRESHOLD, int* const err_code = &errno);
+
+/**
+ * @brief Count nodes of the equation.
+ * 
+ * @param equation
+ * @return number of nodes
+ */
+size_t Equation_size(const Equation* equation);
+
+/**
+ * @brief Check if two equations are structurally equal.
+ * 
+ * @param alpha
+ * @param beta
+ * @return true if equations have the same structure and values
+ */
+bool Equation_equal(const Equation* alpha, const Equation* beta);
+
 /**
  * @brief Simplify the equation (collapse constants, remove trivial operations).
+ * Rules from REWRITE_RULES are applied until none of them matches, then like terms are collected.
  * 
  * @param equation 
  */
@@ -116,4 +222,27 @@ void Equation_simplify(Equation* equation, int* const err_code = &errno);
  */
 double Equation_calculate(const Equation* equation, const double x_value, int* const err_code = &errno);
 
+/**
+ * @brief Get expression values at multiple points X = xs[i].
+ * The equation is compiled once and evaluated over blocks of points with vector instructions.
+ * 
+ * @param equation
+ * @param xs values of the X parameter
+ * @param out where to write expression values (can be the same as xs)
+ * @param count number of points
+ * @param err_code variable to use as errno
+ */
+void Equation_calculate_batch(const Equation* equation, const double* xs, double* out, size_t count,
+                              int* const err_code = &errno);
+
+/**
+ * @brief Check if two values of an equation are the same up to EQ_CALCULATE_TOLERANCE.
+ * Used to compare results of different evaluators of the same equation.
+ * 
+ * @param alpha
+ * @param beta
+ * @return true if both values are NaN, equal infinities or close numbers
+ */
+bool Equation_same_value(double alpha, double beta);
+
 #endif
@@ -0,0 +1,100 @@
+#include "diff_cache.h"
+
+#include "util/dbg/debug.h"
+
+/**
+ * @brief Get the first slot to look for the key in.
+ * 
+ * @param source
+ * @param var_id
+ * @param mask capacity of the slot array minus one
+ * @return slot index
+ */
+static inline size_t key_index(const Equation* source, uintptr_t var_id, size_t mask) {
+    hash_t hash = (hash_t)(uintptr_t)source * 0x9E3779B97F4A7C15ULL ^ (hash_t)var_id * 0xC2B2AE3D27D4EB4FULL;
+    return (size_t)(hash ^ (hash >> 29)) & mask;
+}
+
+/**
+ * @brief Double the capacity of the cache.
+ * 
+ * @param cache
+ * @param err_code variable to use as errno
+ */
+static void grow(DiffCache* cache, int* const err_code = &errno);
+
+void DiffCache_ctor(DiffCache* cache, size_t capacity) {
+    _LOG_FAIL_CHECK_(cache, "error", ERROR_REPORTS, return, &errno, EFAULT);
+
+    cache->capacity = 1;
+    while (cache->capacity < (capacity ? capacity : DIFF_CACHE_DEFAULT_CAPACITY)) cache->capacity <<= 1;
+
+    cache->size = 0;
+    cache->hits = 0;
+    cache->misses = 0;
+    cache->slots = (DiffCacheSlot*) calloc(cache->capacity, sizeof(*cache->slots));
+    _LOG_FAIL_CHECK_(cache->slots, "error", ERROR_REPORTS, cache->capacity = 0, &errno, ENOMEM);
+}
+
+void DiffCache_dtor(DiffCache* cache) {
+    if (!cache) return;
+
+    log_printf(STATUS_REPORTS, "status", "Releasing derivative cache of %ld entries (%ld hits, %ld misses).\n",
+                                          (long int)cache->size, (long int)cache->hits, (long int)cache->misses);
+
+    free(cache->slots);
+    cache->slots = NULL;
+    cache->capacity = 0;
+    cache->size = 0;
+}
+
+Equation* DiffCache_find(DiffCache* cache, const Equation* source, uintptr_t var_id) {
+    if (!cache || !cache->slots) return NULL;
+
+    size_t mask = cache->capacity - 1;
+    for (size_t index = key_index(source, var_id, mask); cache->slots[index].source; index = (index + 1) & mask) {
+        if (cache->slots[index].source == source && cache->slots[index].var_id == var_id) {
+            ++cache->hits;
+            return cache->slots[index].derivative;
+        }
+    }
+
+    ++cache->misses;
+    return NULL;
+}
+
+void DiffCache_store(DiffCache* cache, const Equation* source, uintptr_t var_id, Equation* derivative,
+                     int* const err_code) {
+    _LOG_FAIL_CHECK_(cache && cache->slots, "error", ERROR_REPORTS, return, err_code, EFAULT);
+    if (!source || !derivative) return;
+
+    if ((cache->size + 1) * 2 > cache->capacity) grow(cache, err_code);
+
+    size_t mask = cache->capacity - 1;
+    size_t index = key_index(source, var_id, mask);
+    for (; cache->slots[index].source; index = (index + 1) & mask) {
+        if (cache->slots[index].source == source && cache->slots[index].var_id == var_id) break;
+    }
+
+    if (!cache->slots[index].source) ++cache->size;
+    cache->slots[index] = { .source = source, .var_id = var_id, .derivative = derivative };
+}
+
+static void grow(DiffCache* cache, int* const err_code) {
+    size_t new_capacity = cache->capacity * 2;
+    DiffCacheSlot* new_slots = (DiffCacheSlot*) calloc(new_capacity, sizeof(*new_slots));
+    _LOG_FAIL_CHECK_(new_slots, "error", ERROR_REPORTS, return, err_code, ENOMEM);
+
+    size_t mask = new_capacity - 1;
+    for (size_t id = 0; id < cache->capacity; ++id) {
+        if (!cache->slots[id].source) continue;
+
+        size_t index = key_index(cache->slots[id].source, cache->slots[id].var_id, mask);
+        while (new_slots[index].source) index = (index + 1) & mask;
+        new_slots[index] = cache->slots[id];
+    }
+
+    free(cache->slots);
+    cache->slots = new_slots;
+    cache->capacity = new_capacity;
+}
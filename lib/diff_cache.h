@@ -0,0 +1,80 @@
+/**
+ * @file diff_cache.h
+ * @author Kudryashov Ilya (kudriashov.it@phystech.edu)
+ * @brief Cache of already calculated derivatives.
+ * @version 0.1
+ * @date 2022-12-05
+ * 
+ * @copyright Copyright (c) 2022
+ * 
+ */
+
+#ifndef DIFF_CACHE_H
+#define DIFF_CACHE_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+
+#include "bin_tree.h"
+
+static const size_t DIFF_CACHE_DEFAULT_CAPACITY = 1024;
+
+struct DiffCacheSlot {
+    const Equation* source = NULL;
+    uintptr_t var_id = 0;
+    Equation* derivative = NULL;
+};
+
+/**
+ * @brief Map from (subexpression, variable) to the derivative of the subexpression.
+ * Keys are nodes of an EquationTable, so equal subexpressions share one entry.
+ * The cache should not outlive the table its nodes belong to.
+ */
+struct DiffCache {
+    DiffCacheSlot* slots = NULL;
+    size_t capacity = 0;
+    size_t size = 0;
+
+    size_t hits = 0;
+    size_t misses = 0;
+};
+
+/**
+ * @brief Initialize the cache.
+ * 
+ * @param cache
+ * @param capacity initial number of slots (0 = default)
+ */
+void DiffCache_ctor(DiffCache* cache, size_t capacity = 0);
+
+/**
+ * @brief Release the cache.
+ * 
+ * @param cache
+ */
+void DiffCache_dtor(DiffCache* cache);
+
+/**
+ * @brief Find previously calculated derivative.
+ * 
+ * @param cache
+ * @param source differentiated node
+ * @param var_id ID of the variable the node was differentiated from
+ * @return derivative of the node (NULL if it was not calculated yet)
+ */
+Equation* DiffCache_find(DiffCache* cache, const Equation* source, uintptr_t var_id);
+
+/**
+ * @brief Remember the derivative of the node.
+ * 
+ * @param cache
+ * @param source differentiated node
+ * @param var_id ID of the variable the node was differentiated from
+ * @param derivative derivative of the node
+ * @param err_code variable to use as errno
+ */
+void DiffCache_store(DiffCache* cache, const Equation* source, uintptr_t var_id, Equation* derivative,
+                     int* const err_code = &errno);
+
+#endif
@@ -0,0 +1,80 @@
+#include "dual.h"
+
+#include <math.h>
+
+#include "util/util.h"
+#include "util/dbg/debug.h"
+
+#include "traversal.h"
+
+/**
+ * @brief Calculate value and derivative of the node from the ones of its branches.
+ */
+static fold_step_t dual_step;
+
+Dual Equation_calculate_dual(const Equation* equation, const double x_value, int* const err_code) {
+    if (!equation) return {};
+
+    TraversalFrame root = fold_equation(equation, true, dual_step, &x_value, NULL, err_code);
+    return { .val = root.value, .der = root.slope };
+}
+
+static void dual_step(const Equation* equation, const TraversalFrame* left, const TraversalFrame* right,
+                      TraversalFrame* result, const void* context, int* const err_code) {
+    const double x_value = *(const double*)context;
+
+    Dual alpha = left  ? Dual { .val = left->value,  .der = left->slope  } : Dual {};
+    Dual beta  = right ? Dual { .val = right->value, .der = right->slope } : Dual {};
+
+    Dual answer = {};
+
+    switch (equation->type) {
+
+    case TYPE_CONST: answer = { .val = equation->value.dbl, .der = 0.0 }; break;
+    case TYPE_VAR: answer = equation->value.id == SYMBOL_X ? Dual { .val = x_value, .der = 1.0 } : Dual {}; break;
+
+    case TYPE_OP: {
+        switch (equation->value.op) {
+
+        case OP_ADD: answer = { .val = alpha.val + beta.val, .der = alpha.der + beta.der }; break;
+        case OP_SUB: answer = { .val = alpha.val - beta.val, .der = alpha.der - beta.der }; break;
+        case OP_MUL: answer = { .val = alpha.val * beta.val, .der = alpha.der * beta.val + alpha.val * beta.der }; break;
+        case OP_DIV: {
+            _LOG_FAIL_CHECK_(!is_equal(beta.val, 0.0), "error", ERROR_REPORTS, /* result is infinite */, err_code, EINVAL);
+            answer = is_equal(beta.val, 0.0) ? Dual { .val = INFINITY, .der = INFINITY } :
+                     Dual { .val = alpha.val / beta.val,
+                            .der = (alpha.der * beta.val - alpha.val * beta.der) / (beta.val * beta.val) };
+            break;
+        }
+        case OP_COS: answer = { .val = cos(beta.val), .der = -sin(beta.val) * beta.der }; break;
+        case OP_SIN: answer = { .val = sin(beta.val), .der =  cos(beta.val) * beta.der }; break;
+        case OP_POW: {
+            double value = pow(alpha.val, beta.val);
+            double slope = beta.val * pow(alpha.val, beta.val - 1) * alpha.der;
+
+            //* Constant exponent is common and does not need the base to be positive.
+            if (!is_equal(beta.der, 0.0)) slope += value * log(alpha.val) * beta.der;
+
+            answer = { .val = value, .der = slope };
+            break;
+        }
+        case OP_LN:
+            answer = { .val = log(beta.val),
+                       .der = is_equal(beta.val, 0.0) ? INFINITY : beta.der / beta.val };
+            break;
+        default:
+            if (err_code) *err_code = EINVAL;
+            log_printf(ERROR_REPORTS, "error",
+                "Somehow Operation equation->value.op had an incorrect value of %d.\n", equation->value.op);
+            break;
+
+        }
+
+        break;
+    }
+    default: break;
+    }
+
+    result->value = answer.val;
+    result->slope = answer.der;
+}
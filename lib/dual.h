@@ -0,0 +1,39 @@
+/**
+ * @file dual.h
+ * @author Kudryashov Ilya (kudriashov.it@phystech.edu)
+ * @brief Dual numbers for numeric differentiation.
+ * @version 0.1
+ * @date 2022-12-07
+ * 
+ * @copyright Copyright (c) 2022
+ * 
+ */
+
+#ifndef DUAL_H
+#define DUAL_H
+
+#include <errno.h>
+
+#include "bin_tree.h"
+
+/**
+ * @brief Number of the form val + der * eps, where eps^2 = 0.
+ * Calculating function of (x + eps) gives f(x) + f'(x) * eps, so both the value
+ * and the derivative of an expression are found in one pass.
+ */
+struct Dual {
+    double val = 0.0;
+    double der = 0.0;
+};
+
+/**
+ * @brief Get expression value and its derivative at the point X = x_value.
+ * 
+ * @param equation
+ * @param x_value value of the X parameter
+ * @param err_code variable to use as errno
+ * @return value of the expression and its derivative by X
+ */
+Dual Equation_calculate_dual(const Equation* equation, const double x_value, int* const err_code = &errno);
+
+#endif
@@ -0,0 +1,675 @@
+#include "egraph.h"
+
+#include <cstring>
+#include <math.h>
+
+#include "util/util.h"
+#include "util/dbg/debug.h"
+#include "node_map.h"
+#include "rewrite_rules.h"
+#include "traversal.h"
+
+//* Estimated evaluation time of operations (in additions).
+static const double OP_EVAL_COST[] = {
+    1.0,    // <-- +
+    1.0,    // <-- -
+    1.0,    // <-- *
+    4.0,    // <-- /
+    16.0,   // <-- sin
+    16.0,   // <-- cos
+    24.0,   // <-- pow (^)
+    16.0,   // <-- ln
+};
+
+//* Estimated time of loading a constant or a variable.
+static const double LEAF_EVAL_COST = 0.5;
+
+/**
+ * @brief Calculate hash of the node content.
+ * 
+ * @param node
+ * @return hash_t
+ */
+static hash_t node_hash(const ENode* node);
+
+/**
+ * @brief Check if two nodes have the same content.
+ * 
+ * @param alpha
+ * @param beta
+ * @return true if nodes are equal
+ */
+static bool node_equal(const ENode* alpha, const ENode* beta);
+
+/**
+ * @brief Get copy of the node with canonical argument classes.
+ * 
+ * @param graph
+ * @param node
+ * @return canonical node
+ */
+static ENode canonical(EGraph* graph, ENode node);
+
+/**
+ * @brief Find the memo cell of the node (or the empty cell to put it to).
+ * 
+ * @param graph
+ * @param node canonical node
+ * @return memo cell (0 if empty, node index + 1 otherwise)
+ */
+static size_t* memo_cell(EGraph* graph, const ENode* node);
+
+/**
+ * @brief Refill the memo with canonical nodes, merging classes of equal ones.
+ * 
+ * @param graph
+ * @return true if any classes were merged
+ */
+static bool reindex(EGraph* graph);
+
+/**
+ * @brief Change the capacity of the graph.
+ * 
+ * @param graph
+ * @param capacity new number of nodes
+ * @param err_code variable to use as errno
+ * @return false on failure
+ */
+static bool reserve(EGraph* graph, size_t capacity, int* const err_code);
+
+/**
+ * @brief Add every subexpression of the equation to the graph once.
+ * 
+ * @param graph
+ * @param equation
+ * @param imported classes of already imported nodes
+ * @param err_code variable to use as errno
+ * @return class of the equation
+ */
+static eclass_t import_node(EGraph* graph, const Equation* equation, NodeMap* imported, int* const err_code);
+
+/**
+ * @brief Apply every rule to the nodes currently in the graph.
+ * 
+ * @param graph
+ * @param class_start index of the first member of every class in class_members
+ * @param class_members node indices sorted by class
+ * @param err_code variable to use as errno
+ * @return true if the graph was changed
+ */
+static bool apply_rules(EGraph* graph, const size_t* class_start, const size_t* class_members,
+                        int* const err_code);
+
+/**
+ * @brief Get cost of the node itself, without its arguments.
+ * 
+ * @param node
+ * @param cost cost function
+ * @return cost of the node
+ */
+static double node_cost(const ENode* node, OptimizeCost cost);
+
+/**
+ * @brief Build the equation of the class from the cheapest nodes.
+ * 
+ * @param graph
+ * @param eclass
+ * @param best_node index of the cheapest node of every class
+ * @param err_code variable to use as errno
+ * @return new equation
+ */
+static Equation* build(EGraph* graph, eclass_t eclass, const size_t* best_node, int* const err_code);
+
+void EGraph_ctor(EGraph* graph, size_t capacity, int* const err_code) {
+    _LOG_FAIL_CHECK_(graph, "error", ERROR_REPORTS, return, err_code, EFAULT);
+
+    graph->nodes = NULL;
+    graph->parents = NULL;
+    graph->is_constant = NULL;
+    graph->constants = NULL;
+    graph->memo = NULL;
+    graph->size = 0;
+    graph->capacity = 0;
+    graph->memo_capacity = 0;
+
+    reserve(graph, capacity ? capacity : EGRAPH_DEFAULT_CAPACITY, err_code);
+}
+
+void EGraph_dtor(EGraph* graph) {
+    if (!graph) return;
+
+    free(graph->nodes);
+    free(graph->parents);
+    free(graph->is_constant);
+    free(graph->constants);
+    free(graph->memo);
+
+    graph->nodes = NULL;
+    graph->parents = NULL;
+    graph->is_constant = NULL;
+    graph->constants = NULL;
+    graph->memo = NULL;
+    graph->size = 0;
+    graph->capacity = 0;
+    graph->memo_capacity = 0;
+}
+
+eclass_t EGraph_find(EGraph* graph, eclass_t eclass) {
+    if (eclass == ECLASS_NONE) return ECLASS_NONE;
+
+    while (graph->parents[eclass] != eclass) {
+        graph->parents[eclass] = graph->parents[graph->parents[eclass]];
+        eclass = graph->parents[eclass];
+    }
+
+    return eclass;
+}
+
+eclass_t EGraph_add(EGraph* graph, NodeType type, NodeValue value, eclass_t left, eclass_t right,
+                    int* const err_code) {
+    _LOG_FAIL_CHECK_(graph && graph->memo, "error", ERROR_REPORTS, return ECLASS_NONE, err_code, EFAULT);
+
+    ENode node = { .type = type, .value = value, .left = left, .right = right, .eclass = ECLASS_NONE };
+    node = canonical(graph, node);
+
+    size_t* cell = memo_cell(graph, &node);
+    if (*cell) return EGraph_find(graph, graph->nodes[*cell - 1].eclass);
+
+    if (graph->size >= graph->capacity) {
+        if (!reserve(graph, graph->capacity * 2, err_code)) return ECLASS_NONE;
+
+        //* Memo was refilled, and classes could have been merged.
+        node = canonical(graph, node);
+        cell = memo_cell(graph, &node);
+        if (*cell) return EGraph_find(graph, graph->nodes[*cell - 1].eclass);
+    }
+
+    eclass_t eclass = graph->size++;
+    node.eclass = eclass;
+
+    graph->nodes[eclass] = node;
+    graph->parents[eclass] = eclass;
+    graph->is_constant[eclass] = type == TYPE_CONST;
+    graph->constants[eclass] = type == TYPE_CONST ? value.dbl : 0.0;
+
+    *cell = eclass + 1;
+
+    return eclass;
+}
+
+bool EGraph_merge(EGraph* graph, eclass_t alpha, eclass_t beta) {
+    alpha = EGraph_find(graph, alpha);
+    beta  = EGraph_find(graph, beta);
+    if (alpha == beta || alpha == ECLASS_NONE || beta == ECLASS_NONE) return false;
+
+    //* The older class becomes the root, so class IDs stay small.
+    if (beta < alpha) {
+        eclass_t temp = alpha;
+        alpha = beta;
+        beta = temp;
+    }
+
+    graph->parents[beta] = alpha;
+
+    if (graph->is_constant[beta] && !graph->is_constant[alpha]) {
+        graph->is_constant[alpha] = true;
+        graph->constants[alpha] = graph->constants[beta];
+    }
+
+    return true;
+}
+
+void EGraph_rebuild(EGraph* graph) {
+    if (!graph || !graph->memo) return;
+    while (reindex(graph));
+}
+
+eclass_t EGraph_import(EGraph* graph, const Equation* equation, int* const err_code) {
+    _LOG_FAIL_CHECK_(graph, "error", ERROR_REPORTS, return ECLASS_NONE, err_code, EFAULT);
+
+    NodeMap imported = {};
+    NodeMap_ctor(&imported);
+
+    eclass_t eclass = import_node(graph, equation, &imported, err_code);
+
+    NodeMap_dtor(&imported);
+
+    return eclass;
+}
+
+void EGraph_saturate(EGraph* graph, size_t max_iterations, int* const err_code) {
+    _LOG_FAIL_CHECK_(graph && graph->memo, "error", ERROR_REPORTS, return, err_code, EFAULT);
+
+    size_t iteration = 0;
+    for (; iteration < max_iterations && graph->size < EGRAPH_MAX_NODES; ++iteration) {
+        //* Members of every class are listed once per round, nodes added during the round are not matched.
+        size_t* class_start = (size_t*) calloc(graph->size + 1, sizeof(*class_start));
+        size_t* class_members = (size_t*) calloc(graph->size + 1, sizeof(*class_members));
+        if (!class_start || !class_members) {
+            free(class_start);
+            free(class_members);
+            _LOG_FAIL_CHECK_(false, "error", ERROR_REPORTS, return, err_code, ENOMEM);
+        }
+
+        for (size_t id = 0; id < graph->size; ++id) ++class_start[EGraph_find(graph, graph->nodes[id].eclass) + 1];
+        for (size_t id = 0; id < graph->size; ++id) class_start[id + 1] += class_start[id];
+
+        size_t* position = (size_t*) calloc(graph->size + 1, sizeof(*position));
+        _LOG_FAIL_CHECK_(position, "error", ERROR_REPORTS, free(class_start); free(class_members); return,
+                         err_code, ENOMEM);
+
+        for (size_t id = 0; id < graph->size; ++id) {
+            eclass_t eclass = EGraph_find(graph, graph->nodes[id].eclass);
+            class_members[class_start[eclass] + position[eclass]++] = id;
+        }
+        free(position);
+
+        bool changed = apply_rules(graph, class_start, class_members, err_code);
+        EGraph_rebuild(graph);
+
+        free(class_start);
+        free(class_members);
+
+        if (!changed) break;
+    }
+
+    log_printf(STATUS_REPORTS, "status", "Equality saturation took %ld rounds and produced %ld nodes.\n",
+                                          (long int)iteration, (long int)graph->size);
+}
+
+Equation* EGraph_extract(EGraph* graph, eclass_t eclass, OptimizeCost cost, int* const err_code) {
+    _LOG_FAIL_CHECK_(graph && graph->nodes, "error", ERROR_REPORTS, return NULL, err_code, EFAULT);
+    if (eclass == ECLASS_NONE) return NULL;
+
+    double* best_cost = (double*) calloc(graph->size, sizeof(*best_cost));
+    size_t* best_node = (size_t*) calloc(graph->size, sizeof(*best_node));
+    if (!best_cost || !best_node) {
+        free(best_cost);
+        free(best_node);
+        _LOG_FAIL_CHECK_(false, "error", ERROR_REPORTS, return NULL, err_code, ENOMEM);
+    }
+
+    for (size_t id = 0; id < graph->size; ++id) best_cost[id] = INFINITY;
+
+    //* Costs only decrease, so relaxation stops once every class has its cheapest node.
+    bool changed = true;
+    while (changed) {
+        changed = false;
+
+        for (size_t id = 0; id < graph->size; ++id) {
+            const ENode* node = &graph->nodes[id];
+
+            double total = node_cost(node, cost);
+            if (node->left  != ECLASS_NONE) total += best_cost[EGraph_find(graph, node->left)];
+            if (node->right != ECLASS_NONE) total += best_cost[EGraph_find(graph, node->right)];
+
+            eclass_t node_class = EGraph_find(graph, node->eclass);
+            if (total < best_cost[node_class]) {
+                best_cost[node_class] = total;
+                best_node[node_class] = id;
+                changed = true;
+            }
+        }
+    }
+
+    Equation* equation = build(graph, eclass, best_node, err_code);
+
+    free(best_cost);
+    free(best_node);
+
+    return equation;
+}
+
+Equation* Equation_optimize(const Equation* equation, OptimizeCost cost, int* const err_code) {
+    if (!equation) return NULL;
+    _LOG_FAIL_CHECK_(!Equation_get_error(equation), "error", ERROR_REPORTS, return NULL, err_code, EINVAL);
+
+    EGraph graph = {};
+    EGraph_ctor(&graph, 0, err_code);
+
+    eclass_t root = EGraph_import(&graph, equation, err_code);
+    EGraph_saturate(&graph, EGRAPH_MAX_ITERATIONS, err_code);
+    Equation* optimized = EGraph_extract(&graph, root, cost, err_code);
+
+    EGraph_dtor(&graph);
+
+    return optimized;
+}
+
+static hash_t node_hash(const ENode* node) {
+    hash_t hash = (hash_t)node->type + 1;
+
+    switch (node->type) {
+    case TYPE_CONST: hash ^= get_simple_hash(&node->value.dbl, &node->value.dbl + 1);  break;
+    case TYPE_VAR:   hash ^= (hash_t)node->value.id * 0x9E3779B97F4A7C15ULL;           break;
+    case TYPE_OP:    hash ^= (hash_t)node->value.op * 0xC2B2AE3D27D4EB4FULL;           break;
+    default: break;
+    }
+
+    hash = (hash ^ (hash >> 29)) * 0xBF58476D1CE4E5B9ULL + (hash_t)node->left;
+    hash = (hash ^ (hash >> 31)) * 0x94D049BB133111EBULL + (hash_t)node->right;
+
+    return hash ^ (hash >> 32);
+}
+
+static bool node_equal(const ENode* alpha, const ENode* beta) {
+    if (alpha->type != beta->type || alpha->left != beta->left || alpha->right != beta->right) return false;
+
+    switch (alpha->type) {
+    case TYPE_CONST: return memcmp(&alpha->value.dbl, &beta->value.dbl, sizeof(alpha->value.dbl)) == 0;
+    case TYPE_VAR:   return alpha->value.id == beta->value.id;
+    case TYPE_OP:    return alpha->value.op == beta->value.op;
+    default: return false;
+    }
+}
+
+static ENode canonical(EGraph* graph, ENode node) {
+    node.left  = EGraph_find(graph, node.left);
+    node.right = EGraph_find(graph, node.right);
+    return node;
+}
+
+static size_t* memo_cell(EGraph* graph, const ENode* node) {
+    size_t mask = graph->memo_capacity - 1;
+
+    size_t index = (size_t)node_hash(node) & mask;
+    for (; graph->memo[index]; index = (index + 1) & mask) {
+        ENode stored = canonical(graph, graph->nodes[graph->memo[index] - 1]);
+        if (node_equal(&stored, node)) break;
+    }
+
+    return &graph->memo[index];
+}
+
+static bool reindex(EGraph* graph) {
+    memset(graph->memo, 0, graph->memo_capacity * sizeof(*graph->memo));
+
+    bool merged = false;
+    for (size_t id = 0; id < graph->size; ++id) {
+        graph->nodes[id] = canonical(graph, graph->nodes[id]);
+
+        size_t* cell = memo_cell(graph, &graph->nodes[id]);
+        if (*cell) merged = EGraph_merge(graph, graph->nodes[*cell - 1].eclass, graph->nodes[id].eclass) || merged;
+        else *cell = id + 1;
+    }
+
+    return merged;
+}
+
+static bool reserve(EGraph* graph, size_t capacity, int* const err_code) {
+    ENode* nodes = (ENode*) realloc(graph->nodes, capacity * sizeof(*nodes));
+    if (nodes) graph->nodes = nodes;
+    eclass_t* parents = (eclass_t*) realloc(graph->parents, capacity * sizeof(*parents));
+    if (parents) graph->parents = parents;
+    bool* is_constant = (bool*) realloc(graph->is_constant, capacity * sizeof(*is_constant));
+    if (is_constant) graph->is_constant = is_constant;
+    double* constants = (double*) realloc(graph->constants, capacity * sizeof(*constants));
+    if (constants) graph->constants = constants;
+
+    _LOG_FAIL_CHECK_(nodes && parents && is_constant && constants, "error", ERROR_REPORTS, return false,
+                     err_code, ENOMEM);
+
+    graph->capacity = capacity;
+
+    //* Memo is kept at most half full.
+    size_t memo_capacity = 1;
+    while (memo_capacity < capacity * 2) memo_capacity <<= 1;
+
+    size_t* memo = (size_t*) calloc(memo_capacity, sizeof(*memo));
+    _LOG_FAIL_CHECK_(memo, "error", ERROR_REPORTS, return false, err_code, ENOMEM);
+
+    free(graph->memo);
+    graph->memo = memo;
+    graph->memo_capacity = memo_capacity;
+
+    reindex(graph);
+
+    return true;
+}
+
+static eclass_t import_node(EGraph* graph, const Equation* equation, NodeMap* imported, int* const err_code) {
+    if (!equation) return ECLASS_NONE;
+
+    //* Index of a result frame is the class of its node.
+    TraversalStack stack = {};
+    TraversalStack classes = {};
+
+    bool fine = TraversalStack_push(&stack, { .node = equation }, err_code);
+    while (fine && stack.size) {
+        TraversalFrame frame = TraversalStack_pop(&stack);
+        const Equation* node = frame.node;
+
+        if (frame.stage == STAGE_ENTER) {
+            NodeInfo* info = NodeMap_find(imported, node);
+            if (info) {
+                fine = TraversalStack_push(&classes, { .node = node, .index = info->slot }, err_code);
+                continue;
+            }
+
+            if (node->left || node->right) {
+                fine = TraversalStack_push(&stack, { .node = node, .stage = STAGE_EXIT }, err_code) &&
+                       (!node->right || TraversalStack_push(&stack, { .node = node->right }, err_code)) &&
+                       (!node->left  || TraversalStack_push(&stack, { .node = node->left  }, err_code));
+                continue;
+            }
+        }
+
+        eclass_t right = node->right ? TraversalStack_pop(&classes).index : ECLASS_NONE;
+        eclass_t left  = node->left  ? TraversalStack_pop(&classes).index : ECLASS_NONE;
+
+        eclass_t eclass = EGraph_add(graph, node->type, node->value, left, right, err_code);
+
+        NodeInfo* info = NodeMap_get(imported, node, err_code);
+        if (info) info->slot = eclass;
+
+        fine = TraversalStack_push(&classes, { .node = node, .index = eclass }, err_code);
+    }
+
+    eclass_t eclass = fine ? TraversalStack_pop(&classes).index : ECLASS_NONE;
+
+    TraversalStack_dtor(&stack);
+    TraversalStack_dtor(&classes);
+
+    return eclass;
+}
+
+#define CONSTANT(val) EGraph_add(graph, TYPE_CONST, { .dbl = (val) }, ECLASS_NONE, ECLASS_NONE, err_code)
+#define OPERATION(operation, left, right) EGraph_add(graph, TYPE_OP, { .op = operation }, left, right, err_code)
+
+#define IS_CONST(eclass, val) ( graph->is_constant[eclass] && is_equal(graph->constants[eclass], val) )
+
+//* Declare the matched node equal to the target.
+#define PROVE(target) do {                                                      \
+    if (graph->size >= EGRAPH_MAX_NODES) break;                                 \
+    eclass_t __target = (target);                                               \
+    if (__target != ECLASS_NONE)                                                \
+        changed = EGraph_merge(graph, eclass, __target) || changed;             \
+} while (0)
+
+//* Iterate over nodes of the class as they were at the start of the round.
+#define FOR_EACH_MEMBER(member_class, member, index)                                                    \
+    for (size_t index = class_start[member_class];                                                      \
+         index < class_start[(member_class) + 1] && ((member) = graph->nodes[class_members[index]], true); \
+         ++index)                                                                                       \
+        if ((member).type == TYPE_OP)
+
+static bool apply_rules(EGraph* graph, const size_t* class_start, const size_t* class_members,
+                        int* const err_code) {
+    bool changed = false;
+    size_t size = graph->size;
+
+    for (size_t id = 0; id < size && graph->size < EGRAPH_MAX_NODES; ++id) {
+        ENode node = graph->nodes[id];
+        if (node.type != TYPE_OP) continue;
+
+        eclass_t eclass = EGraph_find(graph, node.eclass);
+        eclass_t alpha  = EGraph_find(graph, node.left);
+        eclass_t beta   = EGraph_find(graph, node.right);
+
+        //* Class index only covers classes that existed at the start of the round.
+        if (alpha >= size || beta >= size) continue;
+
+        double folded = 0.0;
+        if (graph->is_constant[alpha] && graph->is_constant[beta] &&
+            fold_constants(node.value.op, graph->constants[alpha], graph->constants[beta], &folded))
+            PROVE(CONSTANT(folded));
+
+        ENode inner = {}, other = {};
+
+        switch (node.value.op) {
+        case OP_ADD:
+            PROVE(OPERATION(OP_ADD, beta, alpha));
+            if (IS_CONST(beta, 0.0)) PROVE(alpha);
+            if (alpha == beta) PROVE(OPERATION(OP_MUL, CONSTANT(2.0), alpha));
+
+            FOR_EACH_MEMBER(alpha, inner, inner_id) {
+                //* (x + y) + z = x + (y + z)
+                if (inner.value.op == OP_ADD)
+                    PROVE(OPERATION(OP_ADD, inner.left, OPERATION(OP_ADD, inner.right, beta)));
+
+                if (inner.value.op != OP_MUL) continue;
+
+                //* x * y + x = x * (y + 1)
+                if (EGraph_find(graph, inner.left) == beta)
+                    PROVE(OPERATION(OP_MUL, beta, OPERATION(OP_ADD, inner.right, CONSTANT(1.0))));
+
+                //* x * y + x * z = x * (y + z)
+                FOR_EACH_MEMBER(beta, other, other_id) {
+                    if (other.value.op == OP_MUL && EGraph_find(graph, other.left) == EGraph_find(graph, inner.left))
+                        PROVE(OPERATION(OP_MUL, inner.left, OPERATION(OP_ADD, inner.right, other.right)));
+                }
+            }
+
+            //* x + (-c) * y = x - c * y
+            FOR_EACH_MEMBER(beta, other, other_id) {
+                eclass_t factor = EGraph_find(graph, other.left);
+                if (other.value.op == OP_MUL && factor < size && graph->is_constant[factor] &&
+                    graph->constants[factor] < 0.0)
+                    PROVE(OPERATION(OP_SUB, alpha, OPERATION(OP_MUL, CONSTANT(-graph->constants[factor]), other.right)));
+            }
+            break;
+
+        case OP_SUB:
+            if (IS_CONST(beta, 0.0)) PROVE(alpha);
+            if (alpha == beta) PROVE(CONSTANT(0.0));
+            PROVE(OPERATION(OP_ADD, alpha, OPERATION(OP_MUL, CONSTANT(-1.0), beta)));
+            break;
+
+        case OP_MUL:
+            PROVE(OPERATION(OP_MUL, beta, alpha));
+            if (IS_CONST(beta, 1.0)) PROVE(alpha);
+            if (IS_CONST(beta, 0.0)) PROVE(CONSTANT(0.0));
+            if (alpha == beta) PROVE(OPERATION(OP_POW, alpha, CONSTANT(2.0)));
+
+            FOR_EACH_MEMBER(alpha, inner, inner_id) {
+                //* (x * y) * z = x * (y * z)
+                if (inner.value.op == OP_MUL)
+                    PROVE(OPERATION(OP_MUL, inner.left, OPERATION(OP_MUL, inner.right, beta)));
+
+                eclass_t power = EGraph_find(graph, inner.right);
+                if (inner.value.op != OP_POW || power >= size || !graph->is_constant[power]) continue;
+
+                //* x^a * x = x^(a + 1)
+                if (EGraph_find(graph, inner.left) == beta)
+                    PROVE(OPERATION(OP_POW, beta, CONSTANT(graph->constants[power] + 1.0)));
+
+                //* x^a * x^b = x^(a + b)
+                FOR_EACH_MEMBER(beta, other, other_id) {
+                    eclass_t other_power = EGraph_find(graph, other.right);
+                    if (other.value.op == OP_POW && other_power < size && graph->is_constant[other_power] &&
+                        EGraph_find(graph, other.left) == EGraph_find(graph, inner.left))
+                        PROVE(OPERATION(OP_POW, inner.left,
+                                        CONSTANT(graph->constants[power] + graph->constants[other_power])));
+                }
+            }
+            break;
+
+        case OP_DIV:
+            if (IS_CONST(beta, 1.0)) PROVE(alpha);
+            if (alpha == beta) PROVE(CONSTANT(1.0));
+
+            //* (x * y) / x = y
+            FOR_EACH_MEMBER(alpha, inner, inner_id) {
+                if (inner.value.op == OP_MUL && EGraph_find(graph, inner.left) == beta) PROVE(inner.right);
+            }
+            break;
+
+        case OP_POW:
+            if (IS_CONST(beta, 1.0)) PROVE(alpha);
+            if (IS_CONST(beta, 0.0)) PROVE(CONSTANT(1.0));
+            if (IS_CONST(beta, 2.0)) PROVE(OPERATION(OP_MUL, alpha, alpha));
+
+            //* (x^a)^b = x^(ab) for integer b
+            if (!graph->is_constant[beta] || !is_equal(graph->constants[beta], round(graph->constants[beta]))) break;
+            FOR_EACH_MEMBER(alpha, inner, inner_id) {
+                eclass_t power = EGraph_find(graph, inner.right);
+                if (inner.value.op == OP_POW && power < size && graph->is_constant[power])
+                    PROVE(OPERATION(OP_POW, inner.left, CONSTANT(graph->constants[power] * graph->constants[beta])));
+            }
+            break;
+
+        case OP_SIN:
+        case OP_COS:
+        case OP_LN:
+            break;
+
+        default:
+            if (err_code) *err_code = EINVAL;
+            log_printf(ERROR_REPORTS, "error",
+                "Somehow Operation node.value.op had an incorrect value of %d.\n", node.value.op);
+            break;
+        }
+    }
+
+    return changed || graph->size > size;
+}
+
+#undef CONSTANT
+#undef OPERATION
+#undef IS_CONST
+#undef PROVE
+#undef FOR_EACH_MEMBER
+
+static double node_cost(const ENode* node, OptimizeCost cost) {
+    switch (cost) {
+    case OPT_COST_SIZE: return 1.0;
+    case OPT_COST_EVAL: return node->type == TYPE_OP ? OP_EVAL_COST[node->value.op] : LEAF_EVAL_COST;
+    default: return 1.0;
+    }
+}
+
+static Equation* build(EGraph* graph, eclass_t eclass, const size_t* best_node, int* const err_code) {
+    if (eclass == ECLASS_NONE) return NULL;
+
+    //* Index of a frame is the class to build, the cheapest node of the class is looked up on every visit.
+    TraversalStack stack = {};
+    TraversalStack results = {};
+
+    bool fine = TraversalStack_push(&stack, { .index = eclass }, err_code);
+    while (fine && stack.size) {
+        TraversalFrame frame = TraversalStack_pop(&stack);
+        ENode node = graph->nodes[best_node[EGraph_find(graph, frame.index)]];
+
+        if (frame.stage == STAGE_ENTER && (node.left != ECLASS_NONE || node.right != ECLASS_NONE)) {
+            fine = TraversalStack_push(&stack, { .stage = STAGE_EXIT, .index = frame.index }, err_code) &&
+                   (node.right == ECLASS_NONE || TraversalStack_push(&stack, { .index = node.right }, err_code)) &&
+                   (node.left  == ECLASS_NONE || TraversalStack_push(&stack, { .index = node.left  }, err_code));
+            continue;
+        }
+
+        Equation* right = node.right != ECLASS_NONE ? TraversalStack_pop(&results).result : NULL;
+        Equation* left  = node.left  != ECLASS_NONE ? TraversalStack_pop(&results).result : NULL;
+
+        Equation* built = Equation_new(node.type, node.value, left, right, err_code);
+
+        fine = TraversalStack_push(&results, { .result = built }, err_code);
+        if (!fine) Equation_dtor(&built);
+    }
+
+    Equation* equation = fine ? TraversalStack_pop(&results).result : NULL;
+
+    TraversalStack_dtor(&stack);
+    TraversalStack_dtor(&results);
+
+    return equation;
+}
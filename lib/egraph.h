@@ -0,0 +1,167 @@
+/**
+ * @file egraph.h
+ * @author Kudryashov Ilya (kudriashov.it@phystech.edu)
+ * @brief Equality saturation over equations.
+ * @version 0.1
+ * @date 2022-12-11
+ * 
+ * @copyright Copyright (c) 2022
+ * 
+ */
+
+#ifndef EGRAPH_H
+#define EGRAPH_H
+
+#include <stdlib.h>
+#include <errno.h>
+
+#include "bin_tree.h"
+
+//* Maximum number of nodes the graph is allowed to grow to during saturation.
+static const size_t EGRAPH_MAX_NODES = 8192;
+
+//* Maximum number of rule application rounds.
+static const size_t EGRAPH_MAX_ITERATIONS = 8;
+
+static const size_t EGRAPH_DEFAULT_CAPACITY = 256;
+
+typedef size_t eclass_t;
+
+//* Absent class (used for branches of leaf nodes).
+static const eclass_t ECLASS_NONE = (eclass_t)-1;
+
+//* What to minimize when extracting an equation from the graph.
+enum OptimizeCost {
+    OPT_COST_SIZE,  // <-- number of nodes
+    OPT_COST_EVAL,  // <-- estimated evaluation time
+};
+
+//* Operation with classes as arguments.
+struct ENode {
+    NodeType type = TYPE_CONST;
+    NodeValue value = { .id = 0 };
+
+    eclass_t left = ECLASS_NONE;
+    eclass_t right = ECLASS_NONE;
+
+    eclass_t eclass = ECLASS_NONE;  //* Class the node was added to (may be not canonical).
+};
+
+/**
+ * @brief Set of equivalence classes of equations.
+ * Every node represents an operation on classes, nodes of one class are proven to have equal values.
+ * Class IDs are indices of the nodes that created them.
+ */
+struct EGraph {
+    ENode* nodes = NULL;
+    size_t size = 0;
+    size_t capacity = 0;
+
+    eclass_t* parents = NULL;   //* Union-find forest of classes.
+
+    bool* is_constant = NULL;   //* Whether the class contains a constant.
+    double* constants = NULL;   //* Value of the constant of the class.
+
+    size_t* memo = NULL;        //* Hash table of node indices, finds nodes by content.
+    size_t memo_capacity = 0;
+};
+
+/**
+ * @brief Initialize empty graph.
+ * 
+ * @param graph
+ * @param capacity initial number of nodes (0 = default)
+ * @param err_code variable to use as errno
+ */
+void EGraph_ctor(EGraph* graph, size_t capacity = 0, int* const err_code = &errno);
+
+/**
+ * @brief Release the graph.
+ * 
+ * @param graph
+ */
+void EGraph_dtor(EGraph* graph);
+
+/**
+ * @brief Get canonical ID of the class.
+ * 
+ * @param graph
+ * @param eclass
+ * @return canonical class ID
+ */
+eclass_t EGraph_find(EGraph* graph, eclass_t eclass);
+
+/**
+ * @brief Add the node to the graph if it is not there yet.
+ * 
+ * @param graph
+ * @param type node type
+ * @param value node value
+ * @param left class of the left argument
+ * @param right class of the right argument
+ * @param err_code variable to use as errno
+ * @return class of the node
+ */
+eclass_t EGraph_add(EGraph* graph, NodeType type, NodeValue value, eclass_t left, eclass_t right,
+                    int* const err_code = &errno);
+
+/**
+ * @brief Declare two classes equal.
+ * Call EGraph_rebuild() after merging to restore congruence.
+ * 
+ * @param graph
+ * @param alpha
+ * @param beta
+ * @return true if the classes were different
+ */
+bool EGraph_merge(EGraph* graph, eclass_t alpha, eclass_t beta);
+
+/**
+ * @brief Merge classes of equal operations on equal arguments until there are none left.
+ * 
+ * @param graph
+ */
+void EGraph_rebuild(EGraph* graph);
+
+/**
+ * @brief Add every subexpression of the equation to the graph.
+ * 
+ * @param graph
+ * @param equation
+ * @param err_code variable to use as errno
+ * @return class of the equation
+ */
+eclass_t EGraph_import(EGraph* graph, const Equation* equation, int* const err_code = &errno);
+
+/**
+ * @brief Apply rewrite rules until nothing new can be proven or limits are reached.
+ * 
+ * @param graph
+ * @param max_iterations maximum number of rounds
+ * @param err_code variable to use as errno
+ */
+void EGraph_saturate(EGraph* graph, size_t max_iterations = EGRAPH_MAX_ITERATIONS, int* const err_code = &errno);
+
+/**
+ * @brief Build the cheapest equation of the class.
+ * 
+ * @param graph
+ * @param eclass
+ * @param cost cost function
+ * @param err_code variable to use as errno
+ * @return new equation
+ */
+Equation* EGraph_extract(EGraph* graph, eclass_t eclass, OptimizeCost cost, int* const err_code = &errno);
+
+/**
+ * @brief Find the cheapest equation equal to the given one.
+ * Unlike Equation_simplify, all rewrites are kept at once, so the result does not depend on their order.
+ * 
+ * @param equation
+ * @param cost what to minimize
+ * @param err_code variable to use as errno
+ * @return new equation
+ */
+Equation* Equation_optimize(const Equation* equation, OptimizeCost cost = OPT_COST_SIZE, int* const err_code = &errno);
+
+#endif
@@ -0,0 +1,101 @@
+#include "equation_arena.h"
+
+#include "util/dbg/debug.h"
+
+//* Binding is per thread, so threads never allocate from one arena at the same time.
+static thread_local EquationArena* ActiveArena = NULL;
+
+/**
+ * @brief Allocate new slab of nodes.
+ * 
+ * @param block_size number of nodes in the slab
+ * @param err_code variable to use as errno
+ * @return new slab (NULL on failure)
+ */
+static EquationArenaBlock* new_block(size_t block_size, int* const err_code = &errno);
+
+void EquationArena_ctor(EquationArena* arena, size_t block_size) {
+    _LOG_FAIL_CHECK_(arena, "error", ERROR_REPORTS, return, &errno, EFAULT);
+
+    arena->block_size = block_size ? block_size : EQ_ARENA_DEFAULT_BLOCK_SIZE;
+    arena->block_count = 0;
+    arena->first = new_block(arena->block_size);
+    arena->current = arena->first;
+
+    if (arena->first) arena->block_count = 1;
+}
+
+void EquationArena_dtor(EquationArena* arena) {
+    if (!arena) return;
+
+    if (ActiveArena == arena) ActiveArena = NULL;
+
+    log_printf(STATUS_REPORTS, "status", "Releasing equation arena of %ld slabs (%ld nodes each).\n",
+                                          (long int)arena->block_count, (long int)arena->block_size);
+
+    EquationArenaBlock* block = arena->first;
+    while (block) {
+        EquationArenaBlock* next = block->next;
+        free(block);
+        block = next;
+    }
+
+    arena->first = NULL;
+    arena->current = NULL;
+    arena->block_count = 0;
+}
+
+void EquationArena_reset(EquationArena* arena) {
+    if (!arena || !arena->first) return;
+
+    //* Slabs are not zeroed: Equation_new() sets every field of the node it takes,
+    //  and counters of the next slabs are reset when allocation moves to them.
+    arena->current = arena->first;
+    arena->current->used = 0;
+}
+
+Equation* EquationArena_alloc(EquationArena* arena, int* const err_code) {
+    _LOG_FAIL_CHECK_(arena, "error", ERROR_REPORTS, return NULL, err_code, EFAULT);
+
+    if (!arena->current) {
+        arena->first = new_block(arena->block_size, err_code);
+        _LOG_FAIL_CHECK_(arena->first, "error", ERROR_REPORTS, return NULL, err_code, ENOMEM);
+        arena->current = arena->first;
+        arena->block_count = 1;
+    }
+
+    if (arena->current->used >= arena->block_size) {
+        if (!arena->current->next) {
+            arena->current->next = new_block(arena->block_size, err_code);
+            _LOG_FAIL_CHECK_(arena->current->next, "error", ERROR_REPORTS, return NULL, err_code, ENOMEM);
+            ++arena->block_count;
+        }
+        arena->current = arena->current->next;
+        arena->current->used = 0;
+    }
+
+    return &arena->current->nodes[arena->current->used++];
+}
+
+EquationArena* EquationArena_bind(EquationArena* arena) {
+    EquationArena* previous = ActiveArena;
+    ActiveArena = arena;
+    return previous;
+}
+
+EquationArena* EquationArena_active() {
+    return ActiveArena;
+}
+
+static EquationArenaBlock* new_block(size_t block_size, int* const err_code) {
+    //* Header and nodes share one allocation, nodes go right after the header.
+    EquationArenaBlock* block = (EquationArenaBlock*)
+        calloc(1, sizeof(*block) + block_size * sizeof(*block->nodes));
+    _LOG_FAIL_CHECK_(block, "error", ERROR_REPORTS, return NULL, err_code, ENOMEM);
+
+    block->next = NULL;
+    block->used = 0;
+    block->nodes = (Equation*)(block + 1);
+
+    return block;
+}
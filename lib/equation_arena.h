@@ -0,0 +1,87 @@
+/**
+ * @file equation_arena.h
+ * @author Kudryashov Ilya (kudriashov.it@phystech.edu)
+ * @brief Slab allocator for equation nodes.
+ * @version 0.1
+ * @date 2022-12-03
+ * 
+ * @copyright Copyright (c) 2022
+ * 
+ */
+
+#ifndef EQUATION_ARENA_H
+#define EQUATION_ARENA_H
+
+#include <stdlib.h>
+#include <errno.h>
+
+#include "bin_tree.h"
+
+static const size_t EQ_ARENA_DEFAULT_BLOCK_SIZE = 4096;
+
+struct EquationArenaBlock {
+    EquationArenaBlock* next = NULL;
+    size_t used = 0;
+    Equation* nodes = NULL;
+};
+
+/**
+ * @brief Bump allocator for equation nodes.
+ * Nodes are never freed one by one, the whole arena is released at once.
+ */
+struct EquationArena {
+    EquationArenaBlock* first = NULL;
+    EquationArenaBlock* current = NULL;
+    size_t block_size = EQ_ARENA_DEFAULT_BLOCK_SIZE;
+    size_t block_count = 0;
+};
+
+/**
+ * @brief Initialize the arena.
+ * 
+ * @param arena
+ * @param block_size number of nodes in one slab (0 = default)
+ */
+void EquationArena_ctor(EquationArena* arena, size_t block_size = 0);
+
+/**
+ * @brief Free all slabs of the arena.
+ * 
+ * @param arena
+ */
+void EquationArena_dtor(EquationArena* arena);
+
+/**
+ * @brief Mark every node of the arena as free, keeping its slabs for reuse.
+ * Released nodes keep their old content, so nodes should only be taken through Equation_new().
+ * 
+ * @param arena
+ */
+void EquationArena_reset(EquationArena* arena);
+
+/**
+ * @brief Get an uninitialized node from the arena.
+ * 
+ * @param arena
+ * @param err_code variable to use as errno
+ * @return pointer to the node (NULL on failure)
+ */
+Equation* EquationArena_alloc(EquationArena* arena, int* const err_code = &errno);
+
+/**
+ * @brief Make Equation_new allocate nodes from the given arena.
+ * The binding only affects the calling thread.
+ * 
+ * @param arena arena to use (NULL = use heap)
+ * @return previously bound arena
+ */
+EquationArena* EquationArena_bind(EquationArena* arena);
+
+/**
+ * @brief Get the arena Equation_new currently allocates from.
+ * 
+ * @return bound arena (NULL if nodes are allocated on the heap)
+ */
+EquationArena* EquationArena_active();
+
+#endif
@@ -0,0 +1,590 @@
+#include "equation_program.h"
+
+#include <math.h>
+#include <float.h>
+#include <stdint.h>
+
+#include "util/util.h"
+#include "util/dbg/debug.h"
+#include "equation_table.h"
+#include "node_map.h"
+#include "traversal.h"
+
+//* Integer vector of the batch_lane_t size, comparisons of lanes give masks of this type.
+typedef int64_t batch_mask_t __attribute__((vector_size(EQ_BATCH_VECTOR_BYTES)));
+
+//* Sine and cosine kernels lose precision on bigger arguments, libm is called for them.
+static const double VECTOR_SINCOS_MAX_ARGUMENT = 1.073741824e9;
+
+//* Bigger integer powers are calculated through logarithm and exponent.
+static const double VECTOR_POW_MAX_INTEGER = 1024.0;
+
+/**
+ * @brief Replace every lane with its sine or cosine.
+ * 
+ * @param value
+ * @param is_cos true for cosine
+ */
+static void vector_sincos(batch_lane_t* value, bool is_cos);
+
+/**
+ * @brief Replace every lane with its natural logarithm.
+ * 
+ * @param value
+ */
+static void vector_log(batch_lane_t* value);
+
+/**
+ * @brief Replace every lane with its exponent.
+ * 
+ * @param value
+ */
+static void vector_exp(batch_lane_t* value);
+
+/**
+ * @brief Raise every lane of the base to the power in the same lane.
+ * 
+ * @param base base, replaced with the result
+ * @param power
+ */
+static void vector_pow(batch_lane_t* base, const batch_lane_t* power);
+
+/**
+ * @brief Evaluate the program over one block of points.
+ * 
+ * @param program
+ * @param stack evaluation stack (stack_depth * EQ_BATCH_VECTOR_COUNT vectors)
+ * @param slots saved values (slot_count * EQ_BATCH_VECTOR_COUNT vectors)
+ * @param x_block values of the X parameter
+ * @param err_code variable to use as errno
+ * @return pointer to the vectors with results
+ */
+static const batch_lane_t* calculate_block(const EquationProgram* program, batch_lane_t* stack, batch_lane_t* slots,
+                                           const batch_lane_t* x_block, int* const err_code);
+
+/**
+ * @brief Append the instruction to the end of the program.
+ * 
+ * @param program
+ * @param instruction
+ * @param err_code variable to use as errno
+ */
+static void emit(EquationProgram* program, ProgramInstruction instruction, int* const err_code);
+
+/**
+ * @brief Count references to every operation node of the shared equation.
+ * 
+ * @param equation
+ * @param uses where to count references
+ * @param err_code variable to use as errno
+ */
+static void count_uses(const Equation* equation, NodeMap* uses, int* const err_code);
+
+/**
+ * @brief Compile the equation into the end of the program.
+ * 
+ * @param program
+ * @param equation
+ * @param uses number of references to every operation node (slots of compiled nodes are written there)
+ * @param err_code variable to use as errno
+ */
+static void compile(EquationProgram* program, const Equation* equation, NodeMap* uses, int* const err_code);
+
+void EquationProgram_ctor(EquationProgram* program, const Equation* equation, int* const err_code) {
+    _LOG_FAIL_CHECK_(program, "error", ERROR_REPORTS, return, err_code, EFAULT);
+    _LOG_FAIL_CHECK_(!Equation_get_error(equation), "error", ERROR_REPORTS, return, err_code, EINVAL);
+
+    program->size = 0;
+    program->capacity = 0;
+    program->code = NULL;
+    program->stack_depth = 0;
+    program->slot_count = 0;
+
+    EquationTable shared = {};
+    EquationTable_ctor(&shared);
+
+    NodeMap uses = {};
+    NodeMap_ctor(&uses);
+
+    const Equation* dag = EquationTable_import(&shared, equation, err_code);
+    count_uses(dag, &uses, err_code);
+    compile(program, dag, &uses, err_code);
+
+    NodeMap_dtor(&uses);
+    EquationTable_dtor(&shared);
+
+    program->stack = (double*) calloc(program->stack_depth, sizeof(*program->stack));
+    _LOG_FAIL_CHECK_(program->stack, "error", ERROR_REPORTS, return, err_code, ENOMEM);
+
+    program->slots = (double*) calloc(program->slot_count ? program->slot_count : 1, sizeof(*program->slots));
+    _LOG_FAIL_CHECK_(program->slots, "error", ERROR_REPORTS, return, err_code, ENOMEM);
+
+    log_printf(STATUS_REPORTS, "status",
+        "Compiled equation %p into %ld instructions with stack depth %ld and %ld shared subexpressions.\n",
+        equation, (long int)program->size, (long int)program->stack_depth, (long int)program->slot_count);
+}
+
+void EquationProgram_dtor(EquationProgram* program) {
+    if (!program) return;
+
+    free(program->code);
+    free(program->stack);
+    free(program->slots);
+    program->code = NULL;
+    program->stack = NULL;
+    program->slots = NULL;
+    program->size = 0;
+    program->capacity = 0;
+    program->stack_depth = 0;
+    program->slot_count = 0;
+}
+
+double EquationProgram_calculate(EquationProgram* program, const double x_value, int* const err_code) {
+    _LOG_FAIL_CHECK_(program && program->stack, "error", ERROR_REPORTS, return 0.0, err_code, EFAULT);
+
+    double* top = program->stack;  //* Points to the first free cell of the stack.
+
+    const ProgramInstruction* end = program->code + program->size;
+    for (const ProgramInstruction* instr = program->code; instr < end; ++instr) {
+        switch (instr->code) {
+        case PROG_CONST: *top++ = instr->arg.dbl;                           break;
+        case PROG_VAR:   *top++ = instr->arg.id == SYMBOL_X ? x_value : 0.0;     break;
+
+        case PROG_STORE: program->slots[instr->arg.id] = top[-1];           break;
+        case PROG_LOAD:  *top++ = program->slots[instr->arg.id];            break;
+
+        case PROG_ADD: --top; top[-1] += top[0];                            break;
+        case PROG_SUB: --top; top[-1] -= top[0];                            break;
+        case PROG_MUL: --top; top[-1] *= top[0];                            break;
+        case PROG_DIV:
+            --top;
+            if (is_equal(top[0], 0.0)) {
+                if (err_code) *err_code = EINVAL;
+                log_printf(ERROR_REPORTS, "error", "Division by zero at instruction %ld.\n",
+                                                   instr - program->code);
+                top[-1] = INFINITY;
+            } else {
+                top[-1] /= top[0];
+            }
+            break;
+        case PROG_POW: --top; top[-1] = pow(top[-1], top[0]);              break;
+
+        case PROG_SIN: top[-1] = sin(top[-1]);                              break;
+        case PROG_COS: top[-1] = cos(top[-1]);                              break;
+        case PROG_LN:  top[-1] = log(top[-1]);                              break;
+
+        default:
+            if (err_code) *err_code = EINVAL;
+            log_printf(ERROR_REPORTS, "error", "Invalid opcode %d.\n", (int)instr->code);
+            return 0.0;
+        }
+    }
+
+    return top > program->stack ? top[-1] : 0.0;
+}
+
+void EquationProgram_calculate_batch(const EquationProgram* program, const double* xs, double* out, size_t count,
+                                     int* const err_code) {
+    _LOG_FAIL_CHECK_(program && program->code, "error", ERROR_REPORTS, return, err_code, EFAULT);
+    _LOG_FAIL_CHECK_(xs && out, "error", ERROR_REPORTS, return, err_code, EFAULT);
+
+    //* Slots go right after the stack in the same allocation.
+    size_t cell_bytes = EQ_BATCH_VECTOR_COUNT * sizeof(batch_lane_t);
+    size_t stack_bytes = (program->stack_depth + program->slot_count + 1) * cell_bytes;
+    batch_lane_t* stack = (batch_lane_t*) aligned_alloc(alignof(batch_lane_t), stack_bytes);
+    _LOG_FAIL_CHECK_(stack, "error", ERROR_REPORTS, return, err_code, ENOMEM);
+
+    batch_lane_t* slots = stack + (program->stack_depth + 1) * EQ_BATCH_VECTOR_COUNT;
+
+    batch_lane_t x_block[EQ_BATCH_VECTOR_COUNT] = {};
+
+    for (size_t start = 0; start < count; start += EQ_BATCH_BLOCK_SIZE) {
+        size_t block_size = count - start < EQ_BATCH_BLOCK_SIZE ? count - start : EQ_BATCH_BLOCK_SIZE;
+
+        //* Tail of the last block is padded with its last point.
+        for (size_t id = 0; id < EQ_BATCH_BLOCK_SIZE; ++id) {
+            x_block[id / EQ_BATCH_VECTOR_WIDTH][id % EQ_BATCH_VECTOR_WIDTH] =
+                xs[start + (id < block_size ? id : block_size - 1)];
+        }
+
+        const batch_lane_t* result = calculate_block(program, stack, slots, x_block, err_code);
+
+        for (size_t id = 0; id < block_size; ++id) {
+            out[start + id] = result[id / EQ_BATCH_VECTOR_WIDTH][id % EQ_BATCH_VECTOR_WIDTH];
+        }
+    }
+
+    free(stack);
+}
+
+//* Vectors are passed by pointers, as their ABI depends on the instruction set the file is built for.
+
+static inline bool any_lane(const batch_mask_t* mask) {
+    for (size_t lane = 0; lane < EQ_BATCH_VECTOR_WIDTH; ++lane) {
+        if ((*mask)[lane]) return true;
+    }
+
+    return false;
+}
+
+//* Replace lanes outside of the mask with values of the scalar function.
+static inline void scalar_fallback(batch_lane_t* result, const batch_mask_t* is_vector, const batch_lane_t* argument,
+                                   double function(double)) {
+    for (size_t lane = 0; lane < EQ_BATCH_VECTOR_WIDTH; ++lane) {
+        if (!(*is_vector)[lane]) (*result)[lane] = function((*argument)[lane]);
+    }
+}
+
+//* Polynomial with coefficients from the highest power to the lowest.
+template <size_t degree>
+static inline void polynomial(batch_lane_t* result, const batch_lane_t* argument, const double (&coefs)[degree]) {
+    *result = batch_lane_t{} + coefs[0];
+    for (size_t id = 1; id < degree; ++id) *result = *result * *argument + coefs[id];
+}
+
+//* Kernels below are vector versions of the Cephes library functions.
+
+static void vector_sincos(batch_lane_t* value, bool is_cos) {
+    static const double SIN_COEFS[] = {
+        1.58962301576546568060E-10, -2.50507477628578072866E-8, 2.75573136213857245213E-6,
+        -1.98412698295895385996E-4, 8.33333333332211858878E-3, -1.66666666666666307295E-1,
+    };
+    static const double COS_COEFS[] = {
+        -1.13585365213876817300E-11, 2.08757008419747316778E-9, -2.75573141792967388112E-7,
+        2.48015872888517045348E-5, -1.38888888888730564116E-3, 4.16666666666665929218E-2,
+    };
+
+    //* Pi/4 split into three parts, so the reduced argument is exact.
+    static const double PI_4_HIGH = 7.85398125648498535156E-1;
+    static const double PI_4_MID  = 3.77489470793079817668E-8;
+    static const double PI_4_LOW  = 2.69515142907905952645E-15;
+
+    const batch_lane_t one = batch_lane_t{} + 1.0;
+    const batch_lane_t argument = *value;
+
+    batch_lane_t abs_argument = argument < 0.0 ? -argument : argument;
+    batch_mask_t is_vector = abs_argument <= VECTOR_SINCOS_MAX_ARGUMENT;
+    abs_argument = is_vector ? abs_argument : batch_lane_t{};
+
+    //* Octant is rounded up to even, so the reduced argument is within [-Pi/4, Pi/4].
+    batch_mask_t octant = __builtin_convertvector(abs_argument * (4.0 / M_PI), batch_mask_t);
+    octant += octant & 1;
+    batch_lane_t octant_start = __builtin_convertvector(octant, batch_lane_t);
+
+    batch_lane_t reduced = ((abs_argument - octant_start * PI_4_HIGH) - octant_start * PI_4_MID) -
+                           octant_start * PI_4_LOW;
+    batch_lane_t square = reduced * reduced;
+
+    //* Cosine is the sine shifted by two octants, and it is an even function.
+    batch_lane_t sign = one;
+    if (is_cos) octant += 2;
+    else sign = argument < 0.0 ? -one : one;
+
+    batch_lane_t sin_value = {};
+    polynomial(&sin_value, &square, SIN_COEFS);
+    sin_value = reduced + reduced * square * sin_value;
+
+    batch_lane_t cos_value = {};
+    polynomial(&cos_value, &square, COS_COEFS);
+    cos_value = one - 0.5 * square + square * square * cos_value;
+
+    *value = (octant & 2) != 0 ? cos_value : sin_value;
+    *value = (octant & 4) != 0 ? -*value : *value;
+    *value *= sign;
+
+    if (is_cos) scalar_fallback(value, &is_vector, &argument, cos);
+    else scalar_fallback(value, &is_vector, &argument, sin);
+}
+
+static void vector_log(batch_lane_t* value) {
+    static const double NUMERATOR_COEFS[] = {
+        1.01875663804580931796E-4, 4.97494994976747001425E-1, 4.70579119878881725854E0,
+        1.44989225341610930846E1, 1.79368678507819816313E1, 7.70838733755885391666E0,
+    };
+    static const double DENOMINATOR_COEFS[] = {
+        1.0, 1.12873587189167450590E1, 4.52279145837532221105E1,
+        8.29875266912776603211E1, 7.11544750618563894466E1, 2.31251620126765340583E1,
+    };
+
+    //* Ln(2) split into two parts, the first one has exact products with exponents.
+    static const double LN2_HIGH = 0.693359375;
+    static const double LN2_LOW  = -2.121944400546905827679E-4;
+
+    const int64_t MANTISSA_MASK = 0x000fffffffffffff;
+    const int64_t HALF_EXPONENT = 0x3fe0000000000000;
+
+    const batch_lane_t argument = *value;
+
+    batch_mask_t is_vector = argument >= DBL_MIN && argument <= DBL_MAX;
+    batch_lane_t safe = is_vector ? argument : batch_lane_t{} + 1.0;
+
+    //* Argument is split into exponent and mantissa in [0.5, 1).
+    batch_mask_t bits = (batch_mask_t)safe;
+    batch_lane_t exponent = __builtin_convertvector(((bits >> 52) & 0x7ff) - 1022, batch_lane_t);
+    batch_lane_t mantissa = (batch_lane_t)((bits & MANTISSA_MASK) | HALF_EXPONENT);
+
+    batch_mask_t is_small = mantissa < M_SQRT1_2;
+    exponent = is_small ? exponent - 1.0 : exponent;
+    mantissa = is_small ? mantissa + mantissa - 1.0 : mantissa - 1.0;
+
+    batch_lane_t numerator = {};
+    batch_lane_t denominator = {};
+    polynomial(&numerator, &mantissa, NUMERATOR_COEFS);
+    polynomial(&denominator, &mantissa, DENOMINATOR_COEFS);
+
+    batch_lane_t square = mantissa * mantissa;
+    batch_lane_t result = mantissa * (square * numerator / denominator);
+    result = result + exponent * LN2_LOW - 0.5 * square;
+    *value = mantissa + result + exponent * LN2_HIGH;
+
+    scalar_fallback(value, &is_vector, &argument, log);
+}
+
+static void vector_exp(batch_lane_t* value) {
+    static const double NUMERATOR_COEFS[] = {
+        1.26177193074810590878E-4, 3.02994407707441961300E-2, 9.99999999999999999910E-1,
+    };
+    static const double DENOMINATOR_COEFS[] = {
+        3.00198505138664455042E-6, 2.52448340349684104192E-3, 2.27265548208155028766E-1, 2.00000000000000000009E0,
+    };
+
+    static const double LN2_HIGH = 6.93145751953125E-1;
+    static const double LN2_LOW  = 1.42860682030941723212E-6;
+
+    const batch_lane_t argument = *value;
+
+    //* Results of bigger arguments are not normal numbers.
+    batch_mask_t is_vector = argument >= -708.0 && argument <= 709.0;
+    batch_lane_t safe = is_vector ? argument : batch_lane_t{};
+
+    //* Power of two closest to the result, truncation is corrected to get the floor.
+    batch_lane_t scaled = M_LOG2E * safe + 0.5;
+    batch_mask_t power = __builtin_convertvector(scaled, batch_mask_t);
+    batch_lane_t power_value = __builtin_convertvector(power, batch_lane_t);
+    power = power_value > scaled ? power - 1 : power;
+    power_value = power_value > scaled ? power_value - 1.0 : power_value;
+
+    batch_lane_t reduced = safe - power_value * LN2_HIGH - power_value * LN2_LOW;
+    batch_lane_t square = reduced * reduced;
+
+    batch_lane_t odd = {};
+    batch_lane_t even = {};
+    polynomial(&odd, &square, NUMERATOR_COEFS);
+    polynomial(&even, &square, DENOMINATOR_COEFS);
+    odd *= reduced;
+
+    batch_lane_t result = 1.0 + 2.0 * (odd / (even - odd));
+
+    //* Result is multiplied by 2^power through its exponent bits.
+    *value = (batch_lane_t)((batch_mask_t)result + (power << 52));
+
+    scalar_fallback(value, &is_vector, &argument, exp);
+}
+
+static void vector_pow(batch_lane_t* base, const batch_lane_t* power) {
+    const batch_lane_t one = batch_lane_t{} + 1.0;
+
+    batch_lane_t abs_power = *power < 0.0 ? -*power : *power;
+    batch_mask_t is_small = abs_power <= VECTOR_POW_MAX_INTEGER;
+    abs_power = is_small ? abs_power : batch_lane_t{};
+
+    batch_mask_t exponent = __builtin_convertvector(abs_power, batch_mask_t);
+    batch_mask_t is_integer = is_small && __builtin_convertvector(exponent, batch_lane_t) == abs_power;
+    exponent = is_integer ? exponent : batch_mask_t{};
+
+    //* Integer powers are calculated by squaring, so negative bases are handled too.
+    batch_lane_t result = one;
+    batch_lane_t square = *base;
+    for (batch_mask_t is_left = exponent != 0; any_lane(&is_left); is_left = exponent != 0) {
+        result = (exponent & 1) != 0 ? result * square : result;
+        square *= square;
+        exponent >>= 1;
+    }
+    result = *power < 0.0 ? one / result : result;
+
+    batch_mask_t is_positive = *base >= DBL_MIN && *base <= DBL_MAX && *power >= -DBL_MAX && *power <= DBL_MAX;
+    batch_mask_t is_exp = !is_integer && is_positive;
+
+    if (any_lane(&is_exp)) {
+        batch_lane_t exp_result = is_positive ? *base : one;
+        vector_log(&exp_result);
+        exp_result *= *power;
+        vector_exp(&exp_result);
+
+        result = is_integer ? result : exp_result;
+    }
+
+    //* Other lanes (non-positive bases with fractional powers, infinities and NaNs) are left to libm.
+    for (size_t lane = 0; lane < EQ_BATCH_VECTOR_WIDTH; ++lane) {
+        if (!is_integer[lane] && !is_positive[lane]) result[lane] = pow((*base)[lane], (*power)[lane]);
+    }
+
+    *base = result;
+}
+
+static const batch_lane_t* calculate_block(const EquationProgram* program, batch_lane_t* stack, batch_lane_t* slots,
+                                           const batch_lane_t* x_block, int* const err_code) {
+    const size_t cell = EQ_BATCH_VECTOR_COUNT;  //* Number of vectors in one stack cell.
+    batch_lane_t* top = stack;                  //* Points to the first free cell of the stack.
+
+    //* Vector of the topmost occupied cell.
+    #define TOP_CELL(vec) ( (top - cell)[vec] )
+
+    const ProgramInstruction* end = program->code + program->size;
+    for (const ProgramInstruction* instr = program->code; instr < end; ++instr) {
+        switch (instr->code) {
+        case PROG_CONST:
+            for (size_t vec = 0; vec < cell; ++vec) top[vec] = batch_lane_t{} + instr->arg.dbl;
+            top += cell;
+            break;
+        case PROG_VAR:
+            for (size_t vec = 0; vec < cell; ++vec) top[vec] = instr->arg.id == SYMBOL_X ? x_block[vec] : batch_lane_t{};
+            top += cell;
+            break;
+
+        case PROG_STORE:
+            for (size_t vec = 0; vec < cell; ++vec) slots[instr->arg.id * cell + vec] = TOP_CELL(vec);
+            break;
+        case PROG_LOAD:
+            for (size_t vec = 0; vec < cell; ++vec) top[vec] = slots[instr->arg.id * cell + vec];
+            top += cell;
+            break;
+
+        case PROG_ADD: top -= cell; for (size_t vec = 0; vec < cell; ++vec) TOP_CELL(vec) += top[vec]; break;
+        case PROG_SUB: top -= cell; for (size_t vec = 0; vec < cell; ++vec) TOP_CELL(vec) -= top[vec]; break;
+        case PROG_MUL: top -= cell; for (size_t vec = 0; vec < cell; ++vec) TOP_CELL(vec) *= top[vec]; break;
+        case PROG_DIV:
+            top -= cell;
+            for (size_t vec = 0; vec < cell; ++vec) {
+                //* Same zero check as is_equal(), so results match Equation_calculate().
+                batch_mask_t is_zero = top[vec] < CMP_EPS && top[vec] > -CMP_EPS;
+                if (any_lane(&is_zero) && err_code) *err_code = EINVAL;
+                TOP_CELL(vec) = is_zero ? batch_lane_t{} + INFINITY : TOP_CELL(vec) / top[vec];
+            }
+            break;
+        case PROG_POW:
+            top -= cell;
+            for (size_t vec = 0; vec < cell; ++vec) vector_pow(&TOP_CELL(vec), &top[vec]);
+            break;
+
+        case PROG_SIN: for (size_t vec = 0; vec < cell; ++vec) vector_sincos(&TOP_CELL(vec), false); break;
+        case PROG_COS: for (size_t vec = 0; vec < cell; ++vec) vector_sincos(&TOP_CELL(vec), true);  break;
+        case PROG_LN:  for (size_t vec = 0; vec < cell; ++vec) vector_log(&TOP_CELL(vec));           break;
+
+        default:
+            if (err_code) *err_code = EINVAL;
+            log_printf(ERROR_REPORTS, "error", "Invalid opcode %d.\n", (int)instr->code);
+            return stack;
+        }
+    }
+
+    #undef TOP_CELL
+
+    return top - cell;
+}
+
+static void emit(EquationProgram* program, ProgramInstruction instruction, int* const err_code) {
+    if (program->size >= program->capacity) {
+        size_t new_capacity = program->capacity ? program->capacity * 2 : 16;
+        ProgramInstruction* new_code = (ProgramInstruction*)
+            realloc(program->code, new_capacity * sizeof(*program->code));
+        _LOG_FAIL_CHECK_(new_code, "error", ERROR_REPORTS, return, err_code, ENOMEM);
+
+        program->code = new_code;
+        program->capacity = new_capacity;
+    }
+
+    program->code[program->size++] = instruction;
+}
+
+static void count_uses(const Equation* equation, NodeMap* uses, int* const err_code) {
+    if (!equation) return;
+
+    TraversalStack stack = {};
+
+    bool fine = TraversalStack_push(&stack, { .node = equation }, err_code);
+    while (fine && stack.size) {
+        const Equation* node = TraversalStack_pop(&stack).node;
+        if (!node || node->type != TYPE_OP) continue;
+
+        NodeInfo* info = NodeMap_get(uses, node, err_code);
+        if (!info || info->uses++) continue;
+
+        fine = TraversalStack_push(&stack, { .node = node->right }, err_code) &&
+               TraversalStack_push(&stack, { .node = node->left  }, err_code);
+    }
+
+    TraversalStack_dtor(&stack);
+}
+
+static void compile(EquationProgram* program, const Equation* equation, NodeMap* uses, int* const err_code) {
+    if (!equation) return;
+
+    //* Index of a frame is the stack depth before its node is evaluated.
+    TraversalStack stack = {};
+
+    bool fine = TraversalStack_push(&stack, { .node = equation }, err_code);
+    while (fine && stack.size) {
+        TraversalFrame frame = TraversalStack_pop(&stack);
+        const Equation* node = frame.node;
+        size_t depth = frame.index;
+
+        //* Slot numbers are stored with offset of 1, so 0 means the node was not compiled yet.
+        NodeInfo* info = node->type == TYPE_OP ? NodeMap_find(uses, node) : NULL;
+
+        if (frame.stage == STAGE_EXIT) {
+            emit(program, { .code = (ProgramOpcode)node->value.op }, err_code);
+
+            if (info && info->uses > 1) {
+                info->slot = ++program->slot_count;
+                emit(program, { .code = PROG_STORE, .arg = { .id = info->slot - 1 } }, err_code);
+            }
+            continue;
+        }
+
+        if (depth + 1 > program->stack_depth) program->stack_depth = depth + 1;
+
+        if (info && info->uses > 1 && info->slot) {
+            emit(program, { .code = PROG_LOAD, .arg = { .id = info->slot - 1 } }, err_code);
+            continue;
+        }
+
+        switch (node->type) {
+        case TYPE_CONST: emit(program, { .code = PROG_CONST, .arg = node->value }, err_code); break;
+        case TYPE_VAR:   emit(program, { .code = PROG_VAR,   .arg = node->value }, err_code); break;
+
+        case TYPE_OP:
+            switch (node->value.op) {
+            case OP_SIN:
+            case OP_COS:
+            case OP_LN:
+                //* Left branch of unary operations is a placeholder and is not evaluated.
+                fine = TraversalStack_push(&stack, { .node = node, .stage = STAGE_EXIT, .index = depth }, err_code) &&
+                       TraversalStack_push(&stack, { .node = node->right, .index = depth }, err_code);
+                break;
+            case OP_ADD:
+            case OP_SUB:
+            case OP_MUL:
+            case OP_DIV:
+            case OP_POW:
+                fine = TraversalStack_push(&stack, { .node = node, .stage = STAGE_EXIT, .index = depth }, err_code) &&
+                       TraversalStack_push(&stack, { .node = node->right, .index = depth + 1 }, err_code) &&
+                       TraversalStack_push(&stack, { .node = node->left,  .index = depth     }, err_code);
+                break;
+            default:
+                if (err_code) *err_code = EINVAL;
+                log_printf(ERROR_REPORTS, "error",
+                    "Somehow Operation node->value.op had an incorrect value of %d.\n", node->value.op);
+                break;
+            }
+            break;
+
+        default:
+            log_printf(ERROR_REPORTS, "error",
+                "Somehow NodeType node->type had an incorrect value of %d.\n", node->type);
+            break;
+        }
+    }
+
+    TraversalStack_dtor(&stack);
+}
@@ -0,0 +1,121 @@
+/**
+ * @file equation_program.h
+ * @author Kudryashov Ilya (kudriashov.it@phystech.edu)
+ * @brief Equations compiled into flat stack machine code.
+ * @version 0.1
+ * @date 2022-12-06
+ * 
+ * @copyright Copyright (c) 2022
+ * 
+ */
+
+#ifndef EQUATION_PROGRAM_H
+#define EQUATION_PROGRAM_H
+
+#include <stdlib.h>
+#include <errno.h>
+
+#include "bin_tree.h"
+
+//* Number of bytes in one vector register used by batch evaluation.
+//  Wider vectors without AVX are split by the compiler into slow pieces.
+#ifdef __AVX__
+#define EQ_BATCH_VECTOR_BYTES 32
+#else
+#define EQ_BATCH_VECTOR_BYTES 16
+#endif
+
+//* Vector of doubles processed by a single SIMD instruction.
+typedef double batch_lane_t __attribute__((vector_size(EQ_BATCH_VECTOR_BYTES)));
+
+//* Number of points in one vector.
+static const size_t EQ_BATCH_VECTOR_WIDTH = sizeof(batch_lane_t) / sizeof(double);
+
+//* Number of vectors evaluated by one pass of the program.
+static const size_t EQ_BATCH_VECTOR_COUNT = 8;
+
+//* Number of points evaluated by one pass of the program.
+static const size_t EQ_BATCH_BLOCK_SIZE = EQ_BATCH_VECTOR_WIDTH * EQ_BATCH_VECTOR_COUNT;
+
+enum ProgramOpcode {
+    PROG_ADD = OP_ADD,
+    PROG_SUB = OP_SUB,
+    PROG_MUL = OP_MUL,
+    PROG_DIV = OP_DIV,
+    PROG_SIN = OP_SIN,
+    PROG_COS = OP_COS,
+    PROG_POW = OP_POW,
+    PROG_LN  = OP_LN,
+
+    PROG_CONST,
+    PROG_VAR,
+    PROG_STORE, //* Copy top of the stack to the slot arg.id.
+    PROG_LOAD,  //* Push value of the slot arg.id.
+};
+
+struct ProgramInstruction {
+    ProgramOpcode code = PROG_CONST;
+    NodeValue arg = { .id = 0 };
+};
+
+/**
+ * @brief Equation in postfix form, evaluated by a stack machine.
+ * Operations take their arguments from the top of the stack and push the result back.
+ * Values of subexpressions used more than once are saved to slots and are calculated only once.
+ */
+struct EquationProgram {
+    ProgramInstruction* code = NULL;
+    size_t size = 0;
+    size_t capacity = 0;
+
+    double* stack = NULL;
+    size_t stack_depth = 0;
+
+    double* slots = NULL;
+    size_t slot_count = 0;
+};
+
+/**
+ * @brief Compile the equation into the program.
+ * Equal subtrees of the equation are merged before compilation (see EquationTable_import).
+ * 
+ * @param program
+ * @param equation equation to compile (can be a shared DAG)
+ * @param err_code variable to use as errno
+ */
+void EquationProgram_ctor(EquationProgram* program, const Equation* equation, int* const err_code = &errno);
+
+/**
+ * @brief Release the program.
+ * 
+ * @param program
+ */
+void EquationProgram_dtor(EquationProgram* program);
+
+/**
+ * @brief Get program value at the point X = x_value (same as Equation_calculate() of the source equation).
+ * Uses internal stack of the program, so one program should not be evaluated from multiple threads.
+ * 
+ * @param program
+ * @param x_value value of the X parameter
+ * @param err_code variable to use as errno
+ * @return value of the equation
+ */
+double EquationProgram_calculate(EquationProgram* program, const double x_value, int* const err_code = &errno);
+
+/**
+ * @brief Get program values at multiple points.
+ * Points are processed in blocks of EQ_BATCH_BLOCK_SIZE, so every instruction of the program
+ * is executed once per block with vector operations. Elementary functions use vector kernels,
+ * libm is only called for lanes out of their range.
+ * 
+ * @param program
+ * @param xs values of the X parameter
+ * @param out where to write values of the equation (can be the same as xs)
+ * @param count number of points
+ * @param err_code variable to use as errno
+ */
+void EquationProgram_calculate_batch(const EquationProgram* program, const double* xs, double* out, size_t count,
+                                     int* const err_code = &errno);
+
+#endif
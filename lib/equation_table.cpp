@@ -0,0 +1,584 @@
+#include "equation_table.h"
+
+#include <cstring>
+
+#include "util/util.h"
+#include "rewrite_rules.h"
+#include "node_map.h"
+#include "traversal.h"
+#include "polynomial.h"
+
+/**
+ * @brief Calculate hash of the node content (branches are hashed by address).
+ * 
+ * @param type
+ * @param value
+ * @param left
+ * @param right
+ * @return hash_t
+ */
+static hash_t node_hash(NodeType type, NodeValue value, const Equation* left, const Equation* right);
+
+/**
+ * @brief Check if the node has specified content.
+ * 
+ * @param node
+ * @param type
+ * @param value
+ * @param left
+ * @param right
+ * @return true if the node is equal to the described one
+ */
+static bool node_matches(const Equation* node, NodeType type, NodeValue value,
+                         const Equation* left, const Equation* right);
+
+/**
+ * @brief Double the capacity of the table.
+ * 
+ * @param table
+ * @param err_code variable to use as errno
+ */
+static void grow(EquationTable* table, int* const err_code = &errno);
+
+/**
+ * @brief Put the equation into the table, importing every shared subexpression once.
+ * 
+ * @param table
+ * @param equation
+ * @param imported map from imported nodes to their images in the table
+ * @param err_code variable to use as errno
+ * @return shared copy of the equation
+ */
+static Equation* import_node(EquationTable* table, const Equation* equation, NodeMap* imported,
+                             int* const err_code);
+
+/**
+ * @brief Mark polynomial operations of the shared equation which are used outside of bigger polynomials.
+ * 
+ * @param equation
+ * @param roots map to mark nodes in (slot of a marked node is set to 1)
+ * @param err_code variable to use as errno
+ */
+static void mark_polynomial_roots(const Equation* equation, NodeMap* roots, int* const err_code);
+
+/**
+ * @brief Replace the shared polynomial with its collected form, if the form is not bigger.
+ * 
+ * @param table
+ * @param equation polynomial operation
+ * @param sizes tree sizes of already measured nodes
+ * @param err_code variable to use as errno
+ * @return shared collected polynomial (or the equation itself)
+ */
+static Equation* collect_polynomial(EquationTable* table, Equation* equation, NodeMap* sizes, int* const err_code);
+
+/**
+ * @brief Get the size the shared equation would have as a tree.
+ * 
+ * @param equation
+ * @param sizes tree sizes of already measured nodes (saved to their slots)
+ * @param err_code variable to use as errno
+ * @return number of nodes (SIZE_MAX if it does not fit)
+ */
+static size_t tree_size(const Equation* equation, NodeMap* sizes, int* const err_code);
+
+/**
+ * @brief Differentiate the top node of the equation, given derivatives of its branches.
+ * 
+ * @param table
+ * @param equation
+ * @param var_id
+ * @param left_diff derivative of the left branch (NULL for unary operations)
+ * @param right_diff derivative of the right branch
+ * @param err_code
+ * @return shared derivative of the equation
+ */
+static Equation* diff_node(EquationTable* table, const Equation* equation, const uintptr_t var_id,
+                           Equation* left_diff, Equation* right_diff, int* const err_code);
+
+void EquationTable_ctor(EquationTable* table, size_t capacity) {
+    _LOG_FAIL_CHECK_(table, "error", ERROR_REPORTS, return, &errno, EFAULT);
+
+    //* Capacity is kept as a power of two, so slot index is taken by a mask.
+    table->capacity = 1;
+    while (table->capacity < (capacity ? capacity : EQ_TABLE_DEFAULT_CAPACITY)) table->capacity <<= 1;
+
+    table->size = 0;
+    table->slots = (EquationTableSlot*) calloc(table->capacity, sizeof(*table->slots));
+    _LOG_FAIL_CHECK_(table->slots, "error", ERROR_REPORTS, table->capacity = 0, &errno, ENOMEM);
+
+    EquationArena_ctor(&table->arena);
+}
+
+void EquationTable_dtor(EquationTable* table) {
+    if (!table) return;
+
+    log_printf(STATUS_REPORTS, "status", "Releasing equation table with %ld unique nodes.\n", (long int)table->size);
+
+    free(table->slots);
+    table->slots = NULL;
+    table->capacity = 0;
+    table->size = 0;
+
+    EquationArena_dtor(&table->arena);
+}
+
+Equation* EquationTable_node(EquationTable* table, NodeType type, NodeValue value,
+                             Equation* left, Equation* right, int* const err_code) {
+    _LOG_FAIL_CHECK_(table && table->slots, "error", ERROR_REPORTS, return NULL, err_code, EFAULT);
+
+    if ((table->size + 1) * 2 > table->capacity) grow(table, err_code);
+
+    hash_t hash = node_hash(type, value, left, right);
+    size_t mask = table->capacity - 1;
+
+    size_t index = (size_t)hash & mask;
+    for (; table->slots[index].node; index = (index + 1) & mask) {
+        if (table->slots[index].hash == hash && node_matches(table->slots[index].node, type, value, left, right))
+            return table->slots[index].node;
+    }
+
+    Equation* node = EquationArena_alloc(&table->arena, err_code);
+    _LOG_FAIL_CHECK_(node, "error", ERROR_REPORTS, return NULL, err_code, ENOMEM);
+
+    node->type = type;
+    node->from_arena = true;
+    node->value = value;
+    node->left = left;
+    node->right = right;
+
+    table->slots[index] = { .hash = hash, .node = node };
+    ++table->size;
+
+    return node;
+}
+
+Equation* EquationTable_import(EquationTable* table, const Equation* equation, int* const err_code) {
+    if (!equation) return NULL;
+    _LOG_FAIL_CHECK_(table, "error", ERROR_REPORTS, return NULL, err_code, EFAULT);
+
+    NodeMap imported = {};
+    NodeMap_ctor(&imported);
+
+    Equation* image = import_node(table, equation, &imported, err_code);
+
+    NodeMap_dtor(&imported);
+
+    return image;
+}
+
+static Equation* import_node(EquationTable* table, const Equation* equation, NodeMap* imported,
+                             int* const err_code) {
+    TraversalStack stack = {};
+    TraversalStack images = {};
+
+    bool fine = TraversalStack_push(&stack, { .node = equation }, err_code);
+    while (fine && stack.size) {
+        TraversalFrame frame = TraversalStack_pop(&stack);
+        const Equation* node = frame.node;
+
+        if (frame.stage == STAGE_ENTER) {
+            NodeInfo* info = NodeMap_find(imported, node);
+            if (info) {
+                fine = TraversalStack_push(&images, { .node = node, .result = info->image }, err_code);
+                continue;
+            }
+
+            if (node->left || node->right) {
+                fine = TraversalStack_push(&stack, { .node = node, .stage = STAGE_EXIT }, err_code) &&
+                       (!node->right || TraversalStack_push(&stack, { .node = node->right }, err_code)) &&
+                       (!node->left  || TraversalStack_push(&stack, { .node = node->left  }, err_code));
+                continue;
+            }
+        }
+
+        Equation* right = node->right ? TraversalStack_pop(&images).result : NULL;
+        Equation* left  = node->left  ? TraversalStack_pop(&images).result : NULL;
+
+        Equation* image = EquationTable_node(table, node->type, node->value, left, right, err_code);
+
+        NodeInfo* info = NodeMap_get(imported, node, err_code);
+        if (info) info->image = image;
+
+        fine = TraversalStack_push(&images, { .node = node, .result = image }, err_code);
+    }
+
+    Equation* image = fine ? TraversalStack_pop(&images).result : NULL;
+
+    //* Images belong to the table and are not destroyed with the stack.
+    images.size = 0;
+
+    TraversalStack_dtor(&stack);
+    TraversalStack_dtor(&images);
+
+    return image;
+}
+
+static inline Equation* sh_const(EquationTable* table, double value) {
+    return EquationTable_node(table, TYPE_CONST, { .dbl = value }, NULL, NULL);
+}
+
+/**
+ * @brief Get shared operation node, collapsing trivial cases.
+ * 
+ * @param table
+ * @param op
+ * @param left
+ * @param right
+ * @return shared node
+ */
+static Equation* sh_op(EquationTable* table, Operator op, Equation* left, Equation* right) {
+    if (!left || !right) return NULL;
+
+    const RewriteRule* rule = find_rewrite_rule(op, left, right);
+    if (!rule) return EquationTable_node(table, TYPE_OP, { .op = op }, left, right);
+
+    double folded = 0.0;
+    Equation* product = NULL;
+    Equation* factor = NULL;
+
+    switch (rule->action) {
+    case ACT_FOLD:
+        fold_constants(op, left->value.dbl, right->value.dbl, &folded);
+        return sh_const(table, folded);
+    case ACT_LEFT:   return left;
+    case ACT_RIGHT:  return right;
+    case ACT_ZERO:   return sh_const(table, 0.0);
+    case ACT_ONE:    return sh_const(table, 1.0);
+    case ACT_NEGATE: return sh_op(table, OP_MUL, sh_const(table, -1.0), right);
+    case ACT_DOUBLE: return sh_op(table, OP_MUL, sh_const(table, 2.0), left);
+    case ACT_SQUARE: return sh_op(table, OP_POW, left, sh_const(table, 2.0));
+    case ACT_MERGE_MUL:
+        //* Table nodes are immutable, so the product is rebuilt with the merged factor on the same side.
+        product = left->type == TYPE_CONST ? right : left;
+        factor  = left->type == TYPE_CONST ? left  : right;
+        folded = const_mul_factor(product)->value.dbl * factor->value.dbl;
+        if (product->left->type == TYPE_CONST)
+            return sh_op(table, OP_MUL, sh_const(table, folded), const_mul_rest(product));
+        return sh_op(table, OP_MUL, const_mul_rest(product), sh_const(table, folded));
+    case ACT_MERGE_POW:
+        return sh_op(table, OP_POW, left->left, sh_const(table, left->right->value.dbl * right->value.dbl));
+    default:
+        log_printf(ERROR_REPORTS, "error", "Somehow RuleAction rule->action had an incorrect value of %d.\n", rule->action);
+        break;
+    }
+
+    return EquationTable_node(table, TYPE_OP, { .op = op }, left, right);
+}
+
+Equation* EquationTable_op(EquationTable* table, Operator op, Equation* left, Equation* right,
+                           int* const err_code) {
+    _LOG_FAIL_CHECK_(table, "error", ERROR_REPORTS, return NULL, err_code, EFAULT);
+
+    return sh_op(table, op, left, right);
+}
+
+Equation* EquationTable_simplify(EquationTable* table, const Equation* equation, int* const err_code) {
+    if (!equation) return NULL;
+    _LOG_FAIL_CHECK_(table, "error", ERROR_REPORTS, return NULL, err_code, EFAULT);
+
+    NodeMap roots = {}, images = {}, sizes = {};
+    NodeMap_ctor(&roots);
+    NodeMap_ctor(&images);
+    NodeMap_ctor(&sizes);
+
+    mark_polynomial_roots(equation, &roots, err_code);
+
+    TraversalStack stack = {};
+
+    bool fine = TraversalStack_push(&stack, { .node = equation }, err_code);
+    while (fine && stack.size) {
+        TraversalFrame frame = TraversalStack_pop(&stack);
+        const Equation* node = frame.node;
+
+        if (frame.stage == STAGE_ENTER) {
+            if (NodeMap_find(&images, node)) continue;
+
+            if (node->type == TYPE_OP) {
+                fine = TraversalStack_push(&stack, { .node = node, .stage = STAGE_EXIT }, err_code) &&
+                       TraversalStack_push(&stack, { .node = node->right }, err_code) &&
+                       TraversalStack_push(&stack, { .node = node->left  }, err_code);
+                continue;
+            }
+        }
+
+        //* Leaves are table nodes already, operations are rebuilt from the images of their arguments.
+        Equation* image = (Equation*)node;
+        if (node->type == TYPE_OP) {
+            image = sh_op(table, node->value.op, NodeMap_find(&images, node->left)->image,
+                                                 NodeMap_find(&images, node->right)->image);
+
+            NodeInfo* root = NodeMap_find(&roots, node);
+            if (image && root && root->slot && Equation_is_polynomial_op(image))
+                image = collect_polynomial(table, image, &sizes, err_code);
+        }
+
+        NodeInfo* info = NodeMap_get(&images, node, err_code);
+        fine = info != NULL;
+        if (info) info->image = image;
+    }
+
+    NodeInfo* info = fine ? NodeMap_find(&images, equation) : NULL;
+    Equation* simplified = info ? info->image : NULL;
+
+    TraversalStack_dtor(&stack);
+    NodeMap_dtor(&roots);
+    NodeMap_dtor(&images);
+    NodeMap_dtor(&sizes);
+
+    return simplified;
+}
+
+static void mark_polynomial_roots(const Equation* equation, NodeMap* roots, int* const err_code) {
+    //* Every node is entered once, but every edge to a polynomial node is checked.
+    NodeInfo* info = NodeMap_get(roots, equation, err_code);
+    if (!info) return;
+    info->slot = equation->type == TYPE_OP && Equation_is_polynomial_op(equation);
+
+    TraversalStack stack = {};
+
+    bool fine = TraversalStack_push(&stack, { .node = equation }, err_code);
+    while (fine && stack.size) {
+        const Equation* node = TraversalStack_pop(&stack).node;
+        if (node->type != TYPE_OP) continue;
+
+        bool polynomial = Equation_is_polynomial_op(node);
+
+        const Equation* branches[] = { node->left, node->right };
+        for (size_t branch_id = 0; fine && branch_id < ARR_SIZE(branches); ++branch_id) {
+            const Equation* branch = branches[branch_id];
+
+            bool is_new = NodeMap_find(roots, branch) == NULL;
+
+            info = NodeMap_get(roots, branch, err_code);
+            if (!info) {
+                fine = false;
+                break;
+            }
+
+            if (!polynomial && branch->type == TYPE_OP && Equation_is_polynomial_op(branch)) info->slot = 1;
+
+            if (is_new) fine = TraversalStack_push(&stack, { .node = branch }, err_code);
+        }
+    }
+
+    TraversalStack_dtor(&stack);
+}
+
+static Equation* collect_polynomial(EquationTable* table, Equation* equation, NodeMap* sizes, int* const err_code) {
+    PolyAtoms atoms = {};
+    Polynomial poly = {};
+    Polynomial_ctor(&poly, 0, err_code);
+
+    Equation* collected = equation;
+
+    if (Polynomial_from_equation(&poly, equation, &atoms, err_code)) {
+        Equation* expanded = Polynomial_to_table(&poly, &atoms, table, err_code);
+
+        if (expanded && tree_size(expanded, sizes, err_code) <= tree_size(equation, sizes, err_code))
+            collected = expanded;
+    }
+
+    Polynomial_dtor(&poly);
+
+    return collected;
+}
+
+static size_t tree_size(const Equation* equation, NodeMap* sizes, int* const err_code) {
+    TraversalStack stack = {};
+
+    bool fine = TraversalStack_push(&stack, { .node = equation }, err_code);
+    while (fine && stack.size) {
+        TraversalFrame frame = TraversalStack_pop(&stack);
+        const Equation* node = frame.node;
+
+        if (frame.stage == STAGE_ENTER) {
+            if (NodeMap_find(sizes, node)) continue;
+
+            if (node->left || node->right) {
+                fine = TraversalStack_push(&stack, { .node = node, .stage = STAGE_EXIT }, err_code) &&
+                       (!node->right || TraversalStack_push(&stack, { .node = node->right }, err_code)) &&
+                       (!node->left  || TraversalStack_push(&stack, { .node = node->left  }, err_code));
+                continue;
+            }
+        }
+
+        size_t size = 1;
+        const Equation* branches[] = { node->left, node->right };
+        for (size_t branch_id = 0; branch_id < ARR_SIZE(branches); ++branch_id) {
+            if (!branches[branch_id]) continue;
+
+            size_t branch_size = NodeMap_find(sizes, branches[branch_id])->slot;
+            size = branch_size > SIZE_MAX - size ? SIZE_MAX : size + branch_size;
+        }
+
+        NodeInfo* info = NodeMap_get(sizes, node, err_code);
+        fine = info != NULL;
+        if (info) info->slot = size;
+    }
+
+    TraversalStack_dtor(&stack);
+
+    NodeInfo* info = fine ? NodeMap_find(sizes, equation) : NULL;
+    return info ? info->slot : SIZE_MAX;
+}
+
+#define sh_L ( equation->left )
+#define sh_R ( equation->right )
+#define sh_dL ( left_diff  )
+#define sh_dR ( right_diff )
+
+#define sh_add(left, right) sh_op(table, OP_ADD, left, right)
+#define sh_sub(left, right) sh_op(table, OP_SUB, left, right)
+#define sh_mul(left, right) sh_op(table, OP_MUL, left, right)
+#define sh_div(left, right) sh_op(table, OP_DIV, left, right)
+#define sh_pow(left, right) sh_op(table, OP_POW, left, right)
+#define sh_sin(arg)         sh_op(table, OP_SIN, sh_const(table, 0),  arg)
+#define sh_cos(arg)         sh_op(table, OP_COS, sh_const(table, 0),  arg)
+#define sh_neg(arg)         sh_op(table, OP_MUL, sh_const(table, -1), arg)
+#define sh_ln(arg)          sh_op(table, OP_LN,  sh_const(table, 0),  arg)
+
+Equation* EquationTable_diff(EquationTable* table, const Equation* equation, const uintptr_t var_id,
+                             DiffCache* cache, int* const err_code) {
+    if (!equation) return NULL;
+    _LOG_FAIL_CHECK_(table, "error", ERROR_REPORTS, return NULL, err_code, EFAULT);
+
+    Equation* derivative = DiffCache_find(cache, equation, var_id);
+    if (derivative) return derivative;
+
+    //* Derivatives of the nodes met during this call, shared nodes are differentiated once even without a cache.
+    NodeMap derivatives = {};
+    NodeMap_ctor(&derivatives);
+
+    TraversalStack stack = {};
+
+    bool fine = TraversalStack_push(&stack, { .node = equation }, err_code);
+    while (fine && stack.size) {
+        TraversalFrame frame = TraversalStack_pop(&stack);
+        const Equation* node = frame.node;
+
+        bool visit_left = node->left && !has_placeholder(node);
+
+        if (frame.stage == STAGE_ENTER) {
+            if (NodeMap_find(&derivatives, node)) continue;
+
+            Equation* known = DiffCache_find(cache, node, var_id);
+            if (known) {
+                NodeInfo* info = NodeMap_get(&derivatives, node, err_code);
+                fine = info != NULL;
+                if (info) info->image = known;
+                continue;
+            }
+
+            if (node->left || node->right) {
+                fine = TraversalStack_push(&stack, { .node = node, .stage = STAGE_EXIT }, err_code) &&
+                       (!node->right || TraversalStack_push(&stack, { .node = node->right }, err_code)) &&
+                       (!visit_left  || TraversalStack_push(&stack, { .node = node->left  }, err_code));
+                continue;
+            }
+        }
+
+        Equation* left_diff  = visit_left  ? NodeMap_find(&derivatives, node->left)->image  : NULL;
+        Equation* right_diff = node->right ? NodeMap_find(&derivatives, node->right)->image : NULL;
+
+        derivative = diff_node(table, node, var_id, left_diff, right_diff, err_code);
+        if (cache) DiffCache_store(cache, node, var_id, derivative, err_code);
+
+        NodeInfo* info = NodeMap_get(&derivatives, node, err_code);
+        fine = info != NULL;
+        if (info) info->image = derivative;
+    }
+
+    NodeInfo* root = fine ? NodeMap_find(&derivatives, equation) : NULL;
+    derivative = root ? root->image : NULL;
+
+    TraversalStack_dtor(&stack);
+    NodeMap_dtor(&derivatives);
+
+    return derivative;
+}
+
+static Equation* diff_node(EquationTable* table, const Equation* equation, const uintptr_t var_id,
+                           Equation* left_diff, Equation* right_diff, int* const err_code) {
+    switch (equation->type) {
+    case TYPE_VAR:
+        return sh_const(table, equation->value.id == var_id ? 1 : 0);
+
+    case TYPE_CONST: return sh_const(table, 0);
+
+    case TYPE_OP:
+        switch (equation->value.op) {
+        case OP_ADD: return sh_add(sh_dL, sh_dR);
+        case OP_SUB: return sh_sub(sh_dL, sh_dR);
+
+        case OP_MUL: return sh_add(sh_mul(sh_dL, sh_R), sh_mul(sh_L, sh_dR));
+        case OP_DIV: return sh_div(sh_sub(sh_mul(sh_dL, sh_R), sh_mul(sh_dR, sh_L)), sh_pow(sh_R, sh_const(table, 2)));
+
+        case OP_SIN: return sh_mul(sh_dR, sh_cos(sh_R));
+        case OP_COS: return sh_mul(sh_dR, sh_neg(sh_sin(sh_R)));
+
+        case OP_POW: return sh_mul(sh_pow(sh_L, sh_sub(sh_R, sh_const(table, 1))),
+                                   sh_add( sh_mul(sh_R, sh_dL),  sh_mul(sh_mul(sh_L, sh_dR), sh_ln(sh_L)) ));
+        case OP_LN:  return sh_div(sh_dR, sh_R);
+        default:
+            if (err_code) *err_code = EINVAL;
+            log_printf(ERROR_REPORTS, "error",
+                "Somehow Operation equation->value.op had an incorrect value of %d.\n", equation->value.op);
+            break;
+        }
+        break;
+
+    default:
+        log_printf(ERROR_REPORTS, "error",
+            "Somehow NodeType equation->type had an incorrect value of %d.\n", equation->type);
+        break;
+    }
+    return NULL;
+}
+
+static hash_t node_hash(NodeType type, NodeValue value, const Equation* left, const Equation* right) {
+    hash_t hash = (hash_t)type + 1;
+
+    switch (type) {
+    case TYPE_CONST: hash ^= get_simple_hash(&value.dbl, &value.dbl + 1);   break;
+    case TYPE_VAR:   hash ^= (hash_t)value.id * 0x9E3779B97F4A7C15ULL;      break;
+    case TYPE_OP:    hash ^= (hash_t)value.op * 0xC2B2AE3D27D4EB4FULL;      break;
+    default: break;
+    }
+
+    hash = (hash ^ (hash >> 29)) * 0xBF58476D1CE4E5B9ULL + (hash_t)(uintptr_t)left;
+    hash = (hash ^ (hash >> 31)) * 0x94D049BB133111EBULL + (hash_t)(uintptr_t)right;
+
+    return hash ^ (hash >> 32);
+}
+
+static bool node_matches(const Equation* node, NodeType type, NodeValue value,
+                         const Equation* left, const Equation* right) {
+    if (node->type != type || node->left != left || node->right != right) return false;
+
+    switch (type) {
+    case TYPE_CONST: return memcmp(&node->value.dbl, &value.dbl, sizeof(value.dbl)) == 0;
+    case TYPE_VAR:   return node->value.id == value.id;
+    case TYPE_OP:    return node->value.op == value.op;
+    default: return false;
+    }
+}
+
+static void grow(EquationTable* table, int* const err_code) {
+    size_t new_capacity = table->capacity * 2;
+    EquationTableSlot* new_slots = (EquationTableSlot*) calloc(new_capacity, sizeof(*new_slots));
+    _LOG_FAIL_CHECK_(new_slots, "error", ERROR_REPORTS, return, err_code, ENOMEM);
+
+    size_t mask = new_capacity - 1;
+    for (size_t id = 0; id < table->capacity; ++id) {
+        if (!table->slots[id].node) continue;
+
+        size_t index = (size_t)table->slots[id].hash & mask;
+        while (new_slots[index].node) index = (index + 1) & mask;
+        new_slots[index] = table->slots[id];
+    }
+
+    free(table->slots);
+    table->slots = new_slots;
+    table->capacity = new_capacity;
+}
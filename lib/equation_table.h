@@ -0,0 +1,123 @@
+/**
+ * @file equation_table.h
+ * @author Kudryashov Ilya (kudriashov.it@phystech.edu)
+ * @brief Hash-consing table for sharing equal subexpressions.
+ * @version 0.1
+ * @date 2022-12-04
+ * 
+ * @copyright Copyright (c) 2022
+ * 
+ */
+
+#ifndef EQUATION_TABLE_H
+#define EQUATION_TABLE_H
+
+#include <stdlib.h>
+#include <errno.h>
+
+#include "bin_tree.h"
+#include "equation_arena.h"
+#include "diff_cache.h"
+#include "util/dbg/debug.h"
+
+static const size_t EQ_TABLE_DEFAULT_CAPACITY = 1024;
+
+struct EquationTableSlot {
+    hash_t hash = 0;
+    Equation* node = NULL;
+};
+
+/**
+ * @brief Storage of unique equation nodes.
+ * Every node in the table is stored exactly once, so equations built through it form a DAG
+ * where equal subexpressions are represented by the same pointer.
+ * Table nodes are immutable and are released together with the table.
+ */
+struct EquationTable {
+    EquationArena arena = {};
+
+    EquationTableSlot* slots = NULL;
+    size_t capacity = 0;
+    size_t size = 0;
+};
+
+/**
+ * @brief Initialize the table.
+ * 
+ * @param table
+ * @param capacity initial number of slots (0 = default)
+ */
+void EquationTable_ctor(EquationTable* table, size_t capacity = 0);
+
+/**
+ * @brief Release the table with all of its nodes.
+ * 
+ * @param table
+ */
+void EquationTable_dtor(EquationTable* table);
+
+/**
+ * @brief Get the unique node with specified content.
+ * 
+ * @param table
+ * @param type node type
+ * @param value node value
+ * @param left left branch (must belong to the table)
+ * @param right right branch (must belong to the table)
+ * @param err_code variable to use as errno
+ * @return shared node (NULL on failure)
+ */
+Equation* EquationTable_node(EquationTable* table, NodeType type, NodeValue value,
+                             Equation* left, Equation* right, int* const err_code = &errno);
+
+/**
+ * @brief Put the equation into the table.
+ * Structurally equal subtrees of the equation become one shared node, so this is also
+ * the common subexpression elimination pass. The source can be a DAG itself.
+ * 
+ * @param table
+ * @param equation equation to import (is not modified)
+ * @param err_code variable to use as errno
+ * @return shared copy of the equation
+ */
+Equation* EquationTable_import(EquationTable* table, const Equation* equation, int* const err_code = &errno);
+
+/**
+ * @brief Get the shared operation node, simplified by REWRITE_RULES.
+ * 
+ * @param table
+ * @param op
+ * @param left left argument (must belong to the table)
+ * @param right right argument (must belong to the table)
+ * @param err_code variable to use as errno
+ * @return shared node
+ */
+Equation* EquationTable_op(EquationTable* table, Operator op, Equation* left, Equation* right,
+                           int* const err_code = &errno);
+
+/**
+ * @brief Simplify the shared equation by REWRITE_RULES and collect like terms in its polynomial parts.
+ * Same as Equation_simplify(), but shared subexpressions are simplified once and are never copied.
+ * 
+ * @param table
+ * @param equation equation to simplify (must belong to the table)
+ * @param err_code variable to use as errno
+ * @return shared simplified equation
+ */
+Equation* EquationTable_simplify(EquationTable* table, const Equation* equation, int* const err_code = &errno);
+
+/**
+ * @brief Differentiate the equation, sharing equal subexpressions of the result.
+ * Nodes are simplified by REWRITE_RULES while the result is built.
+ * 
+ * @param table
+ * @param equation equation to differentiate (must belong to the table)
+ * @param var_id ID of the variable to differentiate from
+ * @param cache (OPTIONAL) derivatives of subexpressions to reuse and fill (must be used with this table only)
+ * @param err_code variable to use as errno
+ * @return shared derivative of the equation
+ */
+Equation* EquationTable_diff(EquationTable* table, const Equation* equation, const uintptr_t var_id,
+                             DiffCache* cache = NULL, int* const err_code = &errno);
+
+#endif
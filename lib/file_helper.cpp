@@ -1,8 +1,10 @@
 #include "file_helper.h"
 
 #include <sys/stat.h>
+#include <sys/mman.h>
 #include <stdarg.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "util/dbg/debug.h"
 
@@ -45,21 +47,184 @@ int caret_printf(caret_t* caret, const char* format, ...) {
     return delta;
 }
 
+/**
+ * @brief Read the descriptor until the end of the stream.
+ * 
+ * @param fd descriptor to read from
+ * @param size_hint expected size of the content
+ * @param size (OPTIONAL) where to put the size of the content
+ * @return '\0'-terminated content, NULL in case of error
+ */
+static char* read_descriptor(int fd, size_t size_hint, size_t* size) {
+    size_t capacity = size_hint + 1;
+    size_t filled = 0;
+
+    char* buffer = (char*) calloc(capacity, sizeof(*buffer));
+    _LOG_FAIL_CHECK_(buffer, "error", ERROR_REPORTS, return NULL, &errno, ENOMEM);
+
+    while (true) {
+        if (filled + 1 >= capacity) {
+            char* new_buffer = (char*) realloc(buffer, capacity * 2 * sizeof(*buffer));
+            _LOG_FAIL_CHECK_(new_buffer, "error", ERROR_REPORTS, free(buffer); return NULL, &errno, ENOMEM);
+            buffer = new_buffer;
+            capacity *= 2;
+        }
+
+        ssize_t delta = read(fd, buffer + filled, capacity - filled - 1);
+
+        if (delta < 0 && errno == EINTR) continue;
+        _LOG_FAIL_CHECK_(delta >= 0, "error", ERROR_REPORTS, free(buffer); return NULL, &errno, EIO);
+
+        if (delta == 0) break;
+        filled += (size_t)delta;
+    }
+
+    buffer[filled] = '\0';
+    if (size) *size = filled;
+
+    return buffer;
+}
+
 char* read_whole(const char* fname) {
     int fd = open(fname, O_RDONLY);
 
-    if (!fd) return NULL;
+    if (fd < 0) return NULL;
 
-    size_t buf_size = get_file_size(fd) + 1;
-    char* buffer = (char*) calloc(buf_size, sizeof(buffer));
+    char* buffer = read_descriptor(fd, get_file_size(fd), NULL);
 
-    if (!buffer) return 0;
+    close(fd);
 
-    read(fd, buffer, buf_size);
+    return buffer;
+}
 
-    buffer[buf_size - 1] = '\0';
+bool MappedFile_ctor(MappedFile* file, const char* fname, int* const err_code) {
+    _LOG_FAIL_CHECK_(file && fname, "error", ERROR_REPORTS, return false, err_code, EFAULT);
 
-    return buffer;
+    *file = {};
+
+    int fd = open(fname, O_RDONLY);
+    _LOG_FAIL_CHECK_(fd >= 0, "error", ERROR_REPORTS, return false, err_code, ENOENT);
+
+    struct stat status = {};
+    bool is_regular = fstat(fd, &status) == 0 && S_ISREG(status.st_mode);
+    size_t size = is_regular ? (size_t)status.st_size : 0;
+
+    if (size > 0) {
+        void* data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        //* The rest of the last page is filled with zeros, lines can be parsed in place
+        //  unless the last one does not end with a line feed and fills the page completely.
+        if (data != MAP_FAILED && (size % (size_t)sysconf(_SC_PAGESIZE) != 0 || ((char*)data)[size - 1] == '\n')) {
+            madvise(data, size, MADV_SEQUENTIAL);
+
+            file->data = (const char*)data;
+            file->size = size;
+            file->is_mapped = true;
+
+            close(fd);
+            return true;
+        }
+
+        if (data != MAP_FAILED) munmap(data, size);
+    }
+
+    file->data = read_descriptor(fd, size, &file->size);
+
+    close(fd);
+
+    _LOG_FAIL_CHECK_(file->data, "error", ERROR_REPORTS, return false, err_code, EIO);
+
+    return true;
+}
+
+void MappedFile_dtor(MappedFile* file) {
+    if (!file || !file->data) return;
+
+    if (file->is_mapped) munmap((void*)file->data, file->size);
+    else free((void*)file->data);
+
+    *file = {};
+}
+
+void LineReader_ctor(LineReader* reader, int fd, size_t capacity, int* const err_code) {
+    _LOG_FAIL_CHECK_(reader, "error", ERROR_REPORTS, return, err_code, EFAULT);
+
+    *reader = {};
+
+    reader->fd = fd;
+    reader->capacity = capacity ? capacity : LINE_READER_DEFAULT_CAPACITY;
+
+    //* Extra character for the terminator of the last line.
+    reader->buffer = (char*) calloc(reader->capacity + 1, sizeof(*reader->buffer));
+    _LOG_FAIL_CHECK_(reader->buffer, "error", ERROR_REPORTS, reader->is_eof = true, err_code, ENOMEM);
+}
+
+void LineReader_dtor(LineReader* reader) {
+    if (!reader) return;
+
+    free(reader->buffer);
+    *reader = {};
+}
+
+char* LineReader_next(LineReader* reader, size_t* length, int* const err_code) {
+    _LOG_FAIL_CHECK_(reader, "error", ERROR_REPORTS, return NULL, err_code, EFAULT);
+
+    while (reader->buffer) {
+        char* begin = reader->buffer + reader->start;
+        size_t available = reader->end - reader->start;
+        char* line_end = (char*) memchr(begin, '\n', available);
+
+        if (reader->is_skipping) {
+            if (line_end) {
+                reader->start += (size_t)(line_end - begin) + 1;
+                reader->is_skipping = false;
+                continue;
+            }
+
+            reader->start = reader->end = 0;
+        } else if (line_end || (reader->is_eof && available > 0)) {
+            size_t line_length = line_end ? (size_t)(line_end - begin) : available;
+
+            begin[line_length] = '\0';
+            reader->start += line_end ? line_length + 1 : line_length;
+            ++reader->line_id;
+
+            if (length) *length = line_length;
+            return begin;
+        }
+
+        if (reader->is_eof) return NULL;
+
+        if (!reader->is_skipping) {
+            memmove(reader->buffer, begin, available);
+            reader->start = 0;
+            reader->end = available;
+        }
+
+        if (reader->end == reader->capacity) {
+            log_printf(ERROR_REPORTS, "error", "Line %ld is longer than %ld characters, skipping it.\n",
+                       (long int)reader->line_id + 1, (long int)reader->capacity);
+            *err_code = EFBIG;
+
+            ++reader->line_id;
+            reader->is_skipping = true;
+            reader->start = reader->end = 0;
+        }
+
+        ssize_t delta = read(reader->fd, reader->buffer + reader->end, reader->capacity - reader->end);
+
+        if (delta < 0 && errno == EINTR) continue;
+
+        if (delta < 0) {
+            log_printf(ERROR_REPORTS, "error", "Failed to read the stream.\n");
+            *err_code = EIO;
+        }
+
+        if (delta <= 0) reader->is_eof = true;
+        else reader->end += (size_t)delta;
+    }
+
+    return NULL;
 }
 
 char* dynamic_sprintf(const char* format, ...) {
@@ -15,6 +15,7 @@
 #include <stdio.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <errno.h>
 
 /**
  * @brief Jump file reading point to the first mentioned specified character.
@@ -50,10 +51,77 @@ int caret_printf(caret_t* caret, const char* format, ...) __attribute__((format
  * @brief Read whole content of the file and return pointer to the buffer.
  * 
  * @param fname name of the file to open
- * @return char* pointer to the file buffer
+ * @return char* pointer to the '\0'-terminated file buffer, NULL if the file could not be read
  */
 char* read_whole(const char* fname);
 
+//* File content mapped into memory or, if the file can not be mapped, read into a buffer.
+struct MappedFile {
+    const char* data = NULL;
+    size_t size = 0;
+    bool is_mapped = false;
+};
+
+/**
+ * @brief Map the file into memory for sequential reading.
+ * Content is followed by '\0' unless it ends with a line feed, so every line can be parsed in place.
+ * Pipes, character devices and empty files are read into a buffer instead.
+ * 
+ * @param file
+ * @param fname name of the file to open
+ * @param err_code variable to use as errno
+ * @return true if the content is available
+ */
+bool MappedFile_ctor(MappedFile* file, const char* fname, int* const err_code = &errno);
+
+/**
+ * @brief Unmap or free the file content.
+ * 
+ * @param file
+ */
+void MappedFile_dtor(MappedFile* file);
+
+static const size_t LINE_READER_DEFAULT_CAPACITY = 1 << 16;
+
+//* Reader of a stream line by line through a buffer of fixed size.
+struct LineReader {
+    int fd = -1;
+    char* buffer = NULL;
+    size_t capacity = 0;
+    size_t start = 0;           //* Beginning of unread data in the buffer.
+    size_t end = 0;             //* End of read data in the buffer.
+    size_t line_id = 0;         //* Number of the last returned line.
+    bool is_eof = false;
+    bool is_skipping = false;   //* Buffer was filled by one line, the rest of it is being dropped.
+};
+
+/**
+ * @brief Start reading lines from the stream.
+ * 
+ * @param reader
+ * @param fd descriptor to read from (is not closed by the reader)
+ * @param capacity maximum line length (0 = default)
+ * @param err_code variable to use as errno
+ */
+void LineReader_ctor(LineReader* reader, int fd, size_t capacity = 0, int* const err_code = &errno);
+
+/**
+ * @brief Free the buffer of the reader.
+ * 
+ * @param reader
+ */
+void LineReader_dtor(LineReader* reader);
+
+/**
+ * @brief Read the next line. Lines longer than the buffer are reported and skipped.
+ * 
+ * @param reader
+ * @param length (OPTIONAL) where to put the length of the line
+ * @param err_code variable to use as errno
+ * @return line without the line feed terminated with '\0' (valid until the next call), NULL at the end of the stream
+ */
+char* LineReader_next(LineReader* reader, size_t* length = NULL, int* const err_code = &errno);
+
 /**
  * @brief Allocate string of required length and print to it.
  * 
@@ -0,0 +1,211 @@
+#include "gradient.h"
+
+#include <cstring>
+#include <math.h>
+
+#include "util/util.h"
+#include "util/dbg/debug.h"
+
+//* Record of one executed instruction.
+struct TapeEntry {
+    double value = 0.0;
+    double adjoint = 0.0;   //* Derivative of the result by the value of this instruction.
+    size_t left = 0;        //* Index of the instruction that calculated the left argument.
+    size_t right = 0;       //* Index of the instruction that calculated the right argument.
+};
+
+/**
+ * @brief Divide the values, division by zero gives infinity as in Equation_calculate().
+ * 
+ * @param alpha
+ * @param beta
+ * @return quotient
+ */
+static inline double quotient(double alpha, double beta) {
+    return is_equal(beta, 0.0) ? INFINITY : alpha / beta;
+}
+
+/**
+ * @brief Execute the program, recording every instruction to the tape.
+ * 
+ * @param program
+ * @param vars
+ * @param tape where to record instructions (program->size entries)
+ * @param stack stack of instruction indices (program->stack_depth + program->slot_count entries)
+ * @param err_code variable to use as errno
+ */
+static void forward_sweep(const EquationProgram* program, const VarTable* vars, TapeEntry* tape, size_t* stack,
+                          int* const err_code);
+
+/**
+ * @brief Pass derivatives of the result from the last instruction of the tape to the first one.
+ * 
+ * @param program
+ * @param vars
+ * @param tape recorded execution
+ * @param gradient where to accumulate derivatives by variables
+ */
+static void backward_sweep(const EquationProgram* program, const VarTable* vars, TapeEntry* tape, double* gradient);
+
+double EquationProgram_gradient(const EquationProgram* program, const VarTable* vars, double* gradient,
+                                int* const err_code) {
+    _LOG_FAIL_CHECK_(program && program->code, "error", ERROR_REPORTS, return 0.0, err_code, EFAULT);
+    _LOG_FAIL_CHECK_(vars && gradient, "error", ERROR_REPORTS, return 0.0, err_code, EFAULT);
+
+    memset(gradient, 0, vars->size * sizeof(*gradient));
+    if (program->size == 0) return 0.0;
+
+    TapeEntry* tape = (TapeEntry*) calloc(program->size, sizeof(*tape));
+    size_t* stack = (size_t*) calloc(program->stack_depth + program->slot_count, sizeof(*stack));
+    if (!tape || !stack) {
+        free(tape);
+        free(stack);
+        _LOG_FAIL_CHECK_(false, "error", ERROR_REPORTS, return 0.0, err_code, ENOMEM);
+    }
+
+    forward_sweep(program, vars, tape, stack, err_code);
+
+    tape[program->size - 1].adjoint = 1.0;
+    backward_sweep(program, vars, tape, gradient);
+
+    double value = tape[program->size - 1].value;
+
+    free(tape);
+    free(stack);
+
+    return value;
+}
+
+double Equation_gradient(const Equation* equation, const VarTable* vars, double* gradient, int* const err_code) {
+    _LOG_FAIL_CHECK_(!Equation_get_error(equation), "error", ERROR_REPORTS, return 0.0, err_code, EINVAL);
+
+    EquationProgram program = {};
+    EquationProgram_ctor(&program, equation, err_code);
+    double value = EquationProgram_gradient(&program, vars, gradient, err_code);
+    EquationProgram_dtor(&program);
+
+    return value;
+}
+
+static void forward_sweep(const EquationProgram* program, const VarTable* vars, TapeEntry* tape, size_t* stack,
+                          int* const err_code) {
+    size_t* top = stack;  //* Points to the first free cell of the stack.
+
+    //* Indices of instructions that saved slot values are kept after the stack.
+    size_t* slot_entries = stack + program->stack_depth;
+
+    for (size_t id = 0; id < program->size; ++id) {
+        const ProgramInstruction* instr = &program->code[id];
+        TapeEntry* entry = &tape[id];
+
+        switch (instr->code) {
+        case PROG_CONST:
+        case PROG_VAR:
+            break;
+        case PROG_STORE:
+            entry->right = *--top;
+            slot_entries[instr->arg.id] = id;
+            break;
+        case PROG_LOAD:
+            entry->left = slot_entries[instr->arg.id];
+            break;
+        case PROG_SIN:
+        case PROG_COS:
+        case PROG_LN:
+            entry->right = *--top;
+            break;
+        case PROG_ADD:
+        case PROG_SUB:
+        case PROG_MUL:
+        case PROG_DIV:
+        case PROG_POW:
+            entry->right = *--top;
+            entry->left  = *--top;
+            break;
+        default: break;
+        }
+
+        double alpha = tape[entry->left].value;
+        double beta  = tape[entry->right].value;
+
+        switch (instr->code) {
+        case PROG_CONST: entry->value = instr->arg.dbl; break;
+        case PROG_VAR: {
+            size_t index = VarTable_find(vars, instr->arg.id);
+            entry->value = index < vars->size ? vars->vars[index].value : 0.0;
+            break;
+        }
+
+        case PROG_STORE: entry->value = beta;  break;
+        case PROG_LOAD:  entry->value = alpha; break;
+
+        case PROG_ADD: entry->value = alpha + beta; break;
+        case PROG_SUB: entry->value = alpha - beta; break;
+        case PROG_MUL: entry->value = alpha * beta; break;
+        case PROG_DIV:
+            _LOG_FAIL_CHECK_(!is_equal(beta, 0.0), "error", ERROR_REPORTS, /* result is infinite */, err_code, EINVAL);
+            entry->value = quotient(alpha, beta);
+            break;
+        case PROG_POW: entry->value = pow(alpha, beta); break;
+
+        case PROG_SIN: entry->value = sin(beta); break;
+        case PROG_COS: entry->value = cos(beta); break;
+        case PROG_LN:  entry->value = log(beta); break;
+
+        default:
+            if (err_code) *err_code = EINVAL;
+            log_printf(ERROR_REPORTS, "error", "Invalid opcode %d.\n", (int)instr->code);
+            break;
+        }
+
+        *top++ = id;
+    }
+}
+
+static void backward_sweep(const EquationProgram* program, const VarTable* vars, TapeEntry* tape, double* gradient) {
+    for (size_t id = program->size; id-- > 0;) {
+        const ProgramInstruction* instr = &program->code[id];
+        const TapeEntry* entry = &tape[id];
+
+        //* Only exact zeros are skipped, small adjoints still add up to small derivatives.
+        double adjoint = entry->adjoint;
+        if (fpclassify(adjoint) == FP_ZERO) continue;
+
+        TapeEntry* left  = &tape[entry->left];
+        TapeEntry* right = &tape[entry->right];
+
+        switch (instr->code) {
+        case PROG_CONST: break;
+        case PROG_VAR: {
+            size_t index = VarTable_find(vars, instr->arg.id);
+            if (index < vars->size) gradient[index] += adjoint;
+            break;
+        }
+
+        case PROG_STORE: right->adjoint += adjoint; break;
+        case PROG_LOAD:  left->adjoint  += adjoint; break;
+
+        case PROG_ADD: left->adjoint += adjoint; right->adjoint += adjoint; break;
+        case PROG_SUB: left->adjoint += adjoint; right->adjoint -= adjoint; break;
+        case PROG_MUL:
+            left->adjoint  += adjoint * right->value;
+            right->adjoint += adjoint * left->value;
+            break;
+        case PROG_DIV:
+            left->adjoint  += adjoint * quotient(1.0, right->value);
+            right->adjoint -= adjoint * quotient(left->value, right->value * right->value);
+            break;
+        case PROG_POW:
+            left->adjoint += adjoint * right->value * pow(left->value, right->value - 1);
+            //* Exponent derivative only exists for positive bases, for others exponent is treated as constant.
+            if (left->value > 0) right->adjoint += adjoint * entry->value * log(left->value);
+            break;
+
+        case PROG_SIN: right->adjoint += adjoint * cos(right->value); break;
+        case PROG_COS: right->adjoint -= adjoint * sin(right->value); break;
+        case PROG_LN:  right->adjoint += adjoint * quotient(1.0, right->value); break;
+
+        default: break;
+        }
+    }
+}
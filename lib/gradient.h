@@ -0,0 +1,47 @@
+/**
+ * @file gradient.h
+ * @author Kudryashov Ilya (kudriashov.it@phystech.edu)
+ * @brief Reverse-mode differentiation by all variables at once.
+ * @version 0.1
+ * @date 2022-12-09
+ * 
+ * @copyright Copyright (c) 2022
+ * 
+ */
+
+#ifndef GRADIENT_H
+#define GRADIENT_H
+
+#include <errno.h>
+
+#include "bin_tree.h"
+#include "equation_program.h"
+#include "var_table.h"
+
+/**
+ * @brief Get program value and its gradient by every variable of the table.
+ * The program is executed once to record values of every instruction,
+ * then derivatives of the result are passed back from the last instruction to the first one.
+ * 
+ * @param program
+ * @param vars values of the variables
+ * @param gradient where to write derivatives (vars->size values, gradient[i] = df / d(vars->vars[i]))
+ * @param err_code variable to use as errno
+ * @return value of the expression
+ */
+double EquationProgram_gradient(const EquationProgram* program, const VarTable* vars, double* gradient,
+                                int* const err_code = &errno);
+
+/**
+ * @brief Get expression value and its gradient by every variable of the table.
+ * 
+ * @param equation
+ * @param vars values of the variables
+ * @param gradient where to write derivatives (vars->size values, gradient[i] = df / d(vars->vars[i]))
+ * @param err_code variable to use as errno
+ * @return value of the expression
+ */
+double Equation_gradient(const Equation* equation, const VarTable* vars, double* gradient,
+                         int* const err_code = &errno);
+
+#endif
@@ -1,94 +1,189 @@
 #include "grammar.h"
 
-#include <ctype.h>
 #include <cstring>
 
 #include "util/dbg/debug.h"
+#include "text_scan.h"
 
-#define GRAM(name) Equation* name(const LexStack stack, int* caret)
+#define GRAM(name) Equation* name(LexCursor* cursor)
 #define CHECK_INPUT() do {                                                                          \
-    _LOG_FAIL_CHECK_(stack.buffer, "error", ERROR_REPORTS, return NULL, NULL, EINVAL);              \
-    _LOG_FAIL_CHECK_(*caret < (int)stack.size, "error", ERROR_REPORTS, return NULL, NULL, EINVAL);  \
-    log_printf(STATUS_REPORTS, "status", "Called parsing of lexeme at index %d (type: %d).\n",      \
-                                          *caret, (int)stack.buffer[*caret].type);                  \
+    _LOG_FAIL_CHECK_(cursor && cursor->next, "error", ERROR_REPORTS, return NULL, NULL, EINVAL);    \
 }while (0)
 #define CERROR(...) do {                                                        \
-    log_dup(ERROR_REPORTS, "error", "%-20s\n", stack.buffer[*caret].address);   \
+    log_dup(ERROR_REPORTS, "error", "%-20.20s\n", cursor->lexeme.address);     \
     log_dup(ERROR_REPORTS, "error", __VA_ARGS__);                               \
     return value;                                                               \
 }while (0)
 
-void LexStack_ctor(LexStack* stack, size_t start_size) {
-    stack->capacity = start_size;
-    stack->buffer = (Lex*) calloc(stack->capacity, sizeof(*stack->buffer));
+enum CharClass {
+    CHAR_OTHER      = 0,
+    CHAR_BLANK      = 1 << 0,
+    CHAR_ALPHA      = 1 << 1,
+    CHAR_DIGIT      = 1 << 2,
+    CHAR_LINE_END   = 1 << 3,
+    CHAR_NAME       = 1 << 4,   // <-- can continue a variable name
+};
+
+struct CharClassTable {
+    unsigned char classes[256] = {};
+};
+
+//* Same classes as isblank, isalpha and isdigit give in the "C" locale.
+static constexpr CharClassTable make_char_classes() {
+    CharClassTable table = {};
+
+    table.classes[(unsigned char)' '] = CHAR_BLANK;
+    table.classes[(unsigned char)'\t'] = CHAR_BLANK;
+
+    for (char letter = 'a'; letter <= 'z'; ++letter) table.classes[(unsigned char)letter] = CHAR_ALPHA | CHAR_NAME;
+    for (char letter = 'A'; letter <= 'Z'; ++letter) table.classes[(unsigned char)letter] = CHAR_ALPHA | CHAR_NAME;
+    for (char letter = '0'; letter <= '9'; ++letter) table.classes[(unsigned char)letter] = CHAR_DIGIT | CHAR_NAME;
+    table.classes[(unsigned char)'_'] = CHAR_NAME;
+
+    table.classes[(unsigned char)'\n'] = CHAR_LINE_END;
+    table.classes[(unsigned char)'\0'] = CHAR_LINE_END;
+    table.classes[(unsigned char)EOF] = CHAR_LINE_END;
+
+    return table;
 }
 
-void LexStack_dtor(LexStack* stack) {
-    free(stack->buffer);
-    stack->capacity = 0;
-    stack->size = 0;
+static constexpr CharClassTable CHAR_CLASSES = make_char_classes();
+
+static inline bool is_of_class(char letter, int char_class) {
+    return CHAR_CLASSES.classes[(unsigned char)letter] & char_class;
 }
 
-void LexStack_push(LexStack* stack, Lex lexeme) {
-    if (stack->size + 1 >= stack->capacity) {
-        stack->capacity *= 2;
-        Lex* new_buf = (Lex*)calloc(stack->capacity, sizeof(*stack->buffer));
-        _LOG_FAIL_CHECK_(new_buf, "error", ERROR_REPORTS, return, &errno, ENOMEM);
-        memcpy(new_buf, stack->buffer, stack->size * sizeof(*stack->buffer));
-        free(stack->buffer);
-        stack->buffer = new_buf;
-        for (size_t id = stack->size; id < stack->capacity; ++id) {
-            stack->buffer[id] = {};
+static constexpr size_t keyword_length(const char* keyword) {
+    size_t length = 0;
+    while (keyword[length] != '\0') ++length;
+    return length;
+}
+
+static constexpr size_t count_trie_nodes() {
+    size_t count = 1;
+    for (size_t id = 0; id < OP_TYPE_COUNT; ++id) count += keyword_length(OP_TEXT_REPS[id]);
+    return count;
+}
+
+//* Upper bound of the number of nodes, the root plus one node per keyword character.
+static constexpr size_t KEYWORD_TRIE_SIZE = count_trie_nodes();
+static_assert(KEYWORD_TRIE_SIZE <= 256, "Operator names do not fit into the keyword trie.");
+
+//* Trie of operator names, node 0 is the root, so transition to 0 means there is none.
+struct KeywordTrie {
+    unsigned char next[KEYWORD_TRIE_SIZE][128] = {};
+    int keyword[KEYWORD_TRIE_SIZE] = {};    //* Operator ending at the node, -1 if there is none.
+};
+
+static constexpr KeywordTrie make_keyword_trie() {
+    KeywordTrie trie = {};
+    size_t node_count = 1;
+
+    for (size_t node = 0; node < KEYWORD_TRIE_SIZE; ++node) trie.keyword[node] = -1;
+
+    for (size_t id = 0; id < OP_TYPE_COUNT; ++id) {
+        size_t node = 0;
+
+        for (const char* letter = OP_TEXT_REPS[id]; *letter != '\0'; ++letter) {
+            unsigned char& next = trie.next[node][(unsigned char)*letter & 0x7F];
+            if (next == 0) next = (unsigned char)node_count++;
+            node = next;
+        }
+
+        //* First operator of the table wins, as it did when they were compared one by one.
+        if (trie.keyword[node] < 0) trie.keyword[node] = (int)id;
+    }
+
+    return trie;
+}
+
+static constexpr KeywordTrie KEYWORD_TRIE = make_keyword_trie();
+
+/**
+ * @brief Find the longest operator name at the beginning of the text.
+ * 
+ * @param text
+ * @param length where to put the length of the name
+ * @return operator id, -1 if the text does not start with an operator
+ */
+static int match_keyword(const char* text, int* length) {
+    int keyword = -1;
+    size_t node = 0;
+
+    for (int shift = 0; (unsigned char)text[shift] < 128; ++shift) {
+        node = KEYWORD_TRIE.next[node][(unsigned char)text[shift]];
+        if (node == 0) break;
+
+        if (KEYWORD_TRIE.keyword[node] >= 0) {
+            keyword = KEYWORD_TRIE.keyword[node];
+            *length = shift + 1;
         }
     }
-    stack->buffer[stack->size++] = lexeme;
-    log_printf(STATUS_REPORTS, "status", "Pushed lexeme of type %d {.value = { .ch = %d, .dbl = %lg }} "
-                "at \"%-10s\" to index %ld.\n",
-                (int) lexeme.type, (int) lexeme.value.ch, lexeme.value.dbl, lexeme.address, (long int)stack->size - 1);
+
+    return keyword;
 }
 
+void LexCursor_ctor(LexCursor* cursor, const char* line) {
+    cursor->lexeme = {};
+    cursor->next = line;
+    LexCursor_advance(cursor);
+}
 
-LexStack lexify(const char* line) {
-    LexStack stack = {};
-    LexStack_ctor(&stack, 1);
+void LexCursor_advance(LexCursor* cursor) {
+    const char* iter = cursor->next;
 
-    const char* iter = line;
+    for (int shift = 1; ; iter += shift, shift = 1) {
+        iter = skip_blanks(iter);
 
-    for (int shift = 1; *iter != '\n' && *iter != '\0' && *iter != EOF; iter += shift, shift = 1) {
         char letter = *iter;
+        if (is_of_class(letter, CHAR_LINE_END)) break;
 
-        if (isblank(letter)) continue;
+        Lex lexeme = { .type = LEX_OP_TERM, .address = iter };
+        bool is_found = false;
 
-        for (size_t id = 0; id < OP_TYPE_COUNT; id++) {
-            if (strncmp(iter, OP_TEXT_REPS[id], strlen(OP_TEXT_REPS[id])))
-                continue;
-            LexStack_push(&stack, { .type = (LexType)id, .address = iter });
-            shift = (int)strlen(OP_TEXT_REPS[id]);
-            break;
+        int keyword = match_keyword(iter, &shift);
+        if (keyword >= 0) {
+            lexeme.type = (LexType)keyword;
+            is_found = true;
         }
 
-        if (isalpha(letter)) {
-            if (!isalpha(iter[1]))
-                LexStack_push(&stack, { .type = LEX_VAR, .value = { .ch = letter }, .address = iter });
-            else
-                while (isalpha(iter[shift])) ++shift;
+        //* Names start with a letter and go on with letters, digits and underscores,
+        //  every name that is not exactly an operator is a variable.
+        if (is_of_class(letter, CHAR_ALPHA)) {
+            int name_length = 1;
+            while (is_of_class(iter[name_length], CHAR_NAME)) ++name_length;
+
+            if (!is_found || shift != name_length) {
+                symbol_t id = Symbol_intern(iter, (size_t)name_length);
+                lexeme = { .type = LEX_VAR, .value = { .id = id }, .address = iter };
+                is_found = true;
+            }
+
+            shift = name_length;
         }
 
-        if (isdigit(letter)) {
-            const char* dbl_end = iter;  // v~~~~ Why the F this function demands non-const pointers?
-            double value = strtod(iter, (char**)&dbl_end);
-            LexStack_push(&stack, { .type = LEX_NUM, .value = { .dbl = value }, .address = iter });
+        if (is_of_class(letter, CHAR_DIGIT)) {
+            const char* dbl_end = iter;
+            double value = scan_number(iter, &dbl_end);
+            lexeme = { .type = LEX_NUM, .value = { .dbl = value }, .address = iter };
+            is_found = true;
             shift = (int)(dbl_end - iter);
         }
 
-        if (letter == '(')
-            LexStack_push(&stack, { .type = LEX_OP_BRACKET, .address = iter });
-        if (letter == ')')
-            LexStack_push(&stack, { .type = LEX_CL_BRACKET, .address = iter });
+        if (letter == '(' || letter == ')') {
+            lexeme.type = letter == '(' ? LEX_OP_BRACKET : LEX_CL_BRACKET;
+            is_found = true;
+        }
+
+        if (is_found) {
+            cursor->lexeme = lexeme;
+            cursor->next = iter + shift;
+            return;
+        }
     }
-    LexStack_push(&stack, { .type = LEX_OP_TERM, .address = iter });
 
-    return stack;
+    cursor->lexeme = { .type = LEX_OP_TERM, .address = iter };
+    cursor->next = iter;
 }
 
 
@@ -97,67 +192,69 @@ LexStack lexify(const char* line) {
     _LOG_FAIL_CHECK_(variable, "error", ERROR_REPORTS, return NULL, NULL, EAGAIN);  \
 } while (0);
 
+//* Same as ASSIGN_AND_CHECK, but also destroys the already parsed left argument on failure.
+#define ASSIGN_ARG_AND_CHECK(variable, expression) do {                             \
+    variable = expression;                                                          \
+    if (!variable) Equation_dtor(&value);                                           \
+    _LOG_FAIL_CHECK_(variable, "error", ERROR_REPORTS, return NULL, NULL, EAGAIN);  \
+} while (0);
+
 GRAM(parse) {
     Equation* value = NULL;
-    ASSIGN_AND_CHECK(value, parse_expr(stack, caret));
+    ASSIGN_AND_CHECK(value, parse_expr(cursor));
 
-    if (stack.buffer[*caret].type != LEX_OP_TERM) {
+    if (cursor->lexeme.type != LEX_OP_TERM) {
         CERROR("Redundant lexeme detected after equation parsing has ended.\n");
     }
 
     return value;
 }
 
-GRAM(parse_expr) {
-    CHECK_INPUT();
-    Equation* value = NULL;
-    ASSIGN_AND_CHECK(value, parse_mult(stack, caret));
-    while (stack.buffer[*caret].type == LEX_PLUS || stack.buffer[*caret].type == LEX_MINUS) {
-        LexType type = stack.buffer[*caret++].type;
-        Equation* next_arg = NULL;
-        ASSIGN_AND_CHECK(next_arg, parse_mult(stack, caret));
-        value = Equation_new(TYPE_OP, { .op = type==LEX_PLUS ? OP_ADD : OP_SUB }, value, next_arg);
-    }
-    return value;
+static bool is_infix(LexType type) {
+    return (size_t)type < OP_TYPE_COUNT && OP_ASSOCIATIVITY[type] != ASSOC_NONE;
 }
 
-GRAM(parse_mult) {
+/**
+ * @brief Parse the expression consisting of operators of at least the specified priority (precedence climbing).
+ * Operators of the same priority are gathered in a loop if they are left-associative
+ * and by recursion if they are right-associative.
+ * 
+ * @param cursor
+ * @param min_priority minimal priority of operators to take
+ * @return parsed expression
+ */
+static Equation* parse_infix(LexCursor* cursor, int min_priority) {
     CHECK_INPUT();
     Equation* value = NULL;
-    ASSIGN_AND_CHECK(value, parse_pow(stack, caret));
-    while (stack.buffer[*caret].type == LEX_MUL || stack.buffer[*caret].type == LEX_DIV) {
-        LexType type = stack.buffer[*caret++].type;
+    ASSIGN_AND_CHECK(value, parse_brackets(cursor));
+
+    while (is_infix(cursor->lexeme.type) && OP_PRIORITY[cursor->lexeme.type] >= min_priority) {
+        Operator op = (Operator)cursor->lexeme.type;
+        LexCursor_advance(cursor);
+
+        int next_priority = OP_ASSOCIATIVITY[op] == ASSOC_RIGHT ? OP_PRIORITY[op] : OP_PRIORITY[op] + 1;
+
         Equation* next_arg = NULL;
-        ASSIGN_AND_CHECK(next_arg, parse_pow(stack, caret));
-        value = Equation_new(TYPE_OP, { .op = type==LEX_MUL ? OP_MUL : OP_DIV }, value, next_arg);
+        ASSIGN_ARG_AND_CHECK(next_arg, parse_infix(cursor, next_priority));
+        value = Equation_new(TYPE_OP, { .op = op }, value, next_arg);
     }
     return value;
 }
 
-GRAM(parse_pow) {
-    CHECK_INPUT();
-    Equation* value = NULL;
-    ASSIGN_AND_CHECK(value, parse_brackets(stack, caret));
-    
-    while (stack.buffer[*caret].type == LEX_POW) {
-        ++*caret;
-        Equation* next_arg = NULL;
-        ASSIGN_AND_CHECK(next_arg, parse_brackets(stack, caret));
-        value = Equation_new(TYPE_OP, { .op = OP_POW }, value, next_arg);
-    }
-    return value;
+GRAM(parse_expr) {
+    return parse_infix(cursor, 0);
 }
 
 GRAM(parse_brackets) {
     CHECK_INPUT();
     Equation* value = NULL;
-    if (stack.buffer[*caret].type == LEX_OP_BRACKET) {
-        ++*caret;
-        ASSIGN_AND_CHECK(value, parse_expr(stack, caret));
-        if (stack.buffer[*caret].type != LEX_CL_BRACKET) CERROR("Expected closing bracket.\n");
-        ++*caret;
+    if (cursor->lexeme.type == LEX_OP_BRACKET) {
+        LexCursor_advance(cursor);
+        ASSIGN_AND_CHECK(value, parse_expr(cursor));
+        if (cursor->lexeme.type != LEX_CL_BRACKET) CERROR("Expected closing bracket.\n");
+        LexCursor_advance(cursor);
     } else {
-        ASSIGN_AND_CHECK(value, parse_function(stack, caret));
+        ASSIGN_AND_CHECK(value, parse_function(cursor));
     }
     return value;
 }
@@ -165,19 +262,19 @@ GRAM(parse_brackets) {
 GRAM(parse_function) {
     CHECK_INPUT();
     Equation* value = NULL;
-    LexType type = stack.buffer[*caret].type;
+    LexType type = cursor->lexeme.type;
     if (type == LEX_SIN || type == LEX_COS || type == LEX_LN) {
-        ++*caret;
-        if (stack.buffer[*caret].type == LEX_OP_BRACKET) {
-            ++*caret;
-            ASSIGN_AND_CHECK(value, parse_expr(stack, caret));
-            if (stack.buffer[*caret].type != LEX_CL_BRACKET) CERROR("Expected closing bracket.\n");
+        LexCursor_advance(cursor);
+        if (cursor->lexeme.type == LEX_OP_BRACKET) {
+            LexCursor_advance(cursor);
+            ASSIGN_AND_CHECK(value, parse_expr(cursor));
+            if (cursor->lexeme.type != LEX_CL_BRACKET) CERROR("Expected closing bracket.\n");
             value = Equation_new(TYPE_OP, { .op = (Operator)type }, Equation_new(TYPE_CONST, {}, NULL, NULL), value);
-            ++*caret;
+            LexCursor_advance(cursor);
         } else
             CERROR("Expected opening bracket.\n");
     } else if (type == LEX_NUM || type == LEX_VAR) {
-        ASSIGN_AND_CHECK(value, parse_number(stack, caret));
+        ASSIGN_AND_CHECK(value, parse_number(cursor));
     }
     return value;
 }
@@ -185,15 +282,15 @@ GRAM(parse_function) {
 GRAM(parse_number) {
     CHECK_INPUT();
     Equation* value = NULL;
-    if (stack.buffer[*caret].type == LEX_NUM) {
-        ASSIGN_AND_CHECK(value, Equation_new(TYPE_CONST, { .dbl = stack.buffer[*caret].value.dbl }, NULL, NULL));
-        ++*caret;
-    } else if (stack.buffer[*caret].type == LEX_VAR) {
-        ASSIGN_AND_CHECK(value, Equation_new(TYPE_VAR, { .id = (unsigned long)stack.buffer[*caret].value.ch },
-            NULL, NULL));
-        ++*caret;
+    if (cursor->lexeme.type == LEX_NUM) {
+        ASSIGN_AND_CHECK(value, Equation_new(TYPE_CONST, { .dbl = cursor->lexeme.value.dbl }, NULL, NULL));
+        LexCursor_advance(cursor);
+    } else if (cursor->lexeme.type == LEX_VAR) {
+        if (cursor->lexeme.value.id == SYMBOL_NONE) CERROR("Variable name could not be interned.\n");
+        ASSIGN_AND_CHECK(value, Equation_new(TYPE_VAR, { .id = cursor->lexeme.value.id }, NULL, NULL));
+        LexCursor_advance(cursor);
     } else {
-        CERROR("Expected number or variable, got lexeme of type %d instead.\n", (int)stack.buffer[*caret].type);
+        CERROR("Expected number or variable, got lexeme of type %d instead.\n", (int)cursor->lexeme.type);
     }
     return value;
 }
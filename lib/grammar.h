@@ -35,50 +35,51 @@ enum LexType {
 
 union LexValue {
     double dbl;
-    char ch;
+    symbol_t id;
 };
 
 struct Lex {
     LexType type = LEX_OP_TERM;
-    LexValue value = { .ch = 0 };
+    LexValue value = { .dbl = 0.0 };
     const char* address = NULL;
 };
 
-struct LexStack {
-    Lex* buffer = NULL;
-    size_t size = 0;
-    size_t capacity = 0;
+//* Position in the text with the lexeme at it, lexemes are read one at a time as the parser asks for them.
+struct LexCursor {
+    Lex lexeme = {};            //* Current lexeme (LEX_OP_TERM at the end of the line).
+    const char* next = NULL;    //* Text right after the current lexeme.
 };
 
-void LexStack_ctor(LexStack* stack, size_t start_size);
-void LexStack_dtor(LexStack* stack);
-
-void LexStack_push(LexStack* stack, Lex lexeme);
-
+/**
+ * @brief Start reading lexemes of the line.
+ * 
+ * @param cursor
+ * @param line text terminated with '\n' or '\0'
+ */
+void LexCursor_ctor(LexCursor* cursor, const char* line);
 
-LexStack lexify(const char* line);
+/**
+ * @brief Move to the next lexeme, staying at the end of the line once it is reached.
+ * 
+ * @param cursor
+ */
+void LexCursor_advance(LexCursor* cursor);
 
-#define GRAM_FUNCTION(name) Equation* name(const LexStack stack, int* caret);
+#define GRAM_FUNCTION(name) Equation* name(LexCursor* cursor);
 
 //* G = eq
 GRAM_FUNCTION(parse); 
 
-//* eq = mult ([+-]mult)*
+//* eq = brackets (infix brackets)*, infix operators are ordered by OP_PRIORITY and OP_ASSOCIATIVITY
 GRAM_FUNCTION(parse_expr);
 
-//* mult = pow ([*/]pow)*
-GRAM_FUNCTION(parse_mult);
-
-//* pow = brackets ([^]brackets)*
-GRAM_FUNCTION(parse_pow);
-
 //* brackets = number | '('eq')'
 GRAM_FUNCTION(parse_brackets);
 
 //* function = number | ((sin|cos|ln)'('eq')')
 GRAM_FUNCTION(parse_function);
 
-//* number = std::double | std::alpha
+//* number = std::double | name, name = std::alpha (std::alpha | std::digit | '_')*
 GRAM_FUNCTION(parse_number);
 
 #undef GRAM_FUNCTION
@@ -0,0 +1,196 @@
+#include "native.h"
+
+#include <cstring>
+#include <unistd.h>
+#include <dlfcn.h>
+#include <sys/stat.h>
+
+#include "util/util.h"
+#include "util/dbg/debug.h"
+#include "equation_table.h"
+
+//* Number of started library builds (updated atomically).
+static unsigned long BuildCount = 0;
+
+/**
+ * @brief Write C source with functions eq_d0 ... eq_d<order> for the equation and its derivatives.
+ * 
+ * @param equation
+ * @param order maximum derivative power
+ * @param length where to write the length of the source
+ * @param err_code variable to use as errno
+ * @return source text (should be freed)
+ */
+static char* generate_source(const Equation* equation, size_t order, size_t* length, int* const err_code);
+
+/**
+ * @brief Compile the source into the shared library with the given name.
+ * The library is built under a temporary name and then renamed, so other processes never load it half-written.
+ * 
+ * @param source
+ * @param length length of the source
+ * @param lib_name name of the library file
+ * @param err_code variable to use as errno
+ * @return true if the library was built
+ */
+static bool build_library(const char* source, size_t length, const char* lib_name, int* const err_code);
+
+void NativeEquation_ctor(NativeEquation* native, const Equation* equation, size_t order, int* const err_code) {
+    _LOG_FAIL_CHECK_(native, "error", ERROR_REPORTS, return, err_code, EFAULT);
+    _LOG_FAIL_CHECK_(!Equation_get_error(equation), "error", ERROR_REPORTS, return, err_code, EINVAL);
+    _LOG_FAIL_CHECK_(order <= NATIVE_MAX_ORDER, "error", ERROR_REPORTS, return, err_code, EINVAL);
+
+    size_t length = 0;
+    char* source = generate_source(equation, order, &length, err_code);
+    _LOG_FAIL_CHECK_(source, "error", ERROR_REPORTS, return, err_code, ENOMEM);
+
+    char lib_name[NATIVE_MAX_PATH] = "";
+    snprintf(lib_name, sizeof(lib_name), "%s/eq_%016llx_%lu.so", NATIVE_CACHE_FOLDER,
+             get_simple_hash(source, source + length), length);
+
+    if (access(lib_name, F_OK) == 0) {
+        log_printf(STATUS_REPORTS, "status", "Using cached library %s.\n", lib_name);
+    } else if (!build_library(source, length, lib_name, err_code)) {
+        free(source);
+        return;
+    }
+
+    free(source);
+
+    native->handle = dlopen(lib_name, RTLD_NOW | RTLD_LOCAL);
+    if (!native->handle) log_printf(ERROR_REPORTS, "error", "Failed to load %s: %s.\n", lib_name, dlerror());
+    _LOG_FAIL_CHECK_(native->handle, "error", ERROR_REPORTS, return, err_code, ENOENT);
+
+    native->functions = (native_function_t**) calloc(order + 1, sizeof(*native->functions));
+    _LOG_FAIL_CHECK_(native->functions, "error", ERROR_REPORTS, {
+        NativeEquation_dtor(native);
+        return;
+    }, err_code, ENOMEM);
+
+    native->order = order;
+
+    for (size_t power = 0; power <= order; ++power) {
+        char name[32] = "";
+        snprintf(name, sizeof(name), "eq_d%lu", power);
+
+        //* dlsym() returns an object pointer, POSIX guarantees it can be reinterpreted as a function pointer.
+        void* symbol = dlsym(native->handle, name);
+        memcpy(&native->functions[power], &symbol, sizeof(symbol));
+
+        _LOG_FAIL_CHECK_(native->functions[power], "error", ERROR_REPORTS, {
+            NativeEquation_dtor(native);
+            return;
+        }, err_code, ENOENT);
+    }
+}
+
+void NativeEquation_dtor(NativeEquation* native) {
+    if (!native) return;
+
+    free(native->functions);
+    native->functions = NULL;
+    native->order = 0;
+
+    if (native->handle) dlclose(native->handle);
+    native->handle = NULL;
+}
+
+native_function_t* NativeEquation_get(const NativeEquation* native, size_t order) {
+    if (!native || !native->functions || order > native->order) return NULL;
+    return native->functions[order];
+}
+
+static char* generate_source(const Equation* equation, size_t order, size_t* length, int* const err_code) {
+    Equation** stages = (Equation**) calloc(order + 1, sizeof(*stages));
+    _LOG_FAIL_CHECK_(stages, "error", ERROR_REPORTS, return NULL, err_code, ENOMEM);
+
+    EquationTable table = {};
+    EquationTable_ctor(&table);
+    DiffCache cache = {};
+    DiffCache_ctor(&cache);
+
+    //* Derivatives are built the same way the article builds them, so the code matches the printed formulas.
+    //* Writers keep space for the longest node part free, so it is added once on top of the estimate.
+    size_t capacity = 64 + EQ_WRITE_STEP_LENGTH;
+    const Equation* current = EquationTable_import(&table, equation, err_code);
+    for (size_t power = 0; power <= order; ++power) {
+        stages[power] = Equation_copy(current);
+        Equation_simplify(stages[power], err_code);
+        capacity += Equation_size(stages[power]) * NATIVE_NODE_LENGTH + 64;
+
+        if (power < order) {
+            current = EquationTable_diff(&table, EquationTable_import(&table, stages[power], err_code),
+                                         SYMBOL_X, &cache, err_code);
+        }
+    }
+
+    DiffCache_dtor(&cache);
+    EquationTable_dtor(&table);
+
+    char* source = (char*) calloc(capacity, sizeof(*source));
+    _LOG_FAIL_CHECK_(source, "error", ERROR_REPORTS, {
+        for (size_t power = 0; power <= order; ++power) Equation_dtor(&stages[power]);
+        free(stages);
+        return NULL;
+    }, err_code, ENOMEM);
+
+    caret_t caret = source;
+    caret_printf(&caret, "#include <math.h>\n");
+
+    bool is_written = true;
+    for (size_t power = 0; power <= order; ++power) {
+        caret_printf(&caret, "\ndouble eq_d%lu(double x) {\n    (void) x;\n    return ", power);
+        is_written = is_written && Equation_write_as_c(stages[power], &caret, source + capacity, err_code);
+        caret_printf(&caret, ";\n}\n");
+
+        Equation_dtor(&stages[power]);
+    }
+
+    free(stages);
+
+    _LOG_FAIL_CHECK_(is_written, "error", ERROR_REPORTS, {
+        free(source);
+        return NULL;
+    }, err_code, EFBIG);
+
+    *length = (size_t)(caret - source);
+    return source;
+}
+
+static bool build_library(const char* source, size_t length, const char* lib_name, int* const err_code) {
+    if (mkdir(NATIVE_CACHE_FOLDER, 0755) != 0) {
+        _LOG_FAIL_CHECK_(errno == EEXIST, "error", ERROR_REPORTS, return false, err_code, errno);
+    }
+
+    char src_name[NATIVE_MAX_PATH] = "";
+    char tmp_name[NATIVE_MAX_PATH] = "";
+    //* Threads of one process can build the same library at once, so they need names of their own too.
+    unsigned long build_id = __atomic_add_fetch(&BuildCount, 1, __ATOMIC_RELAXED);
+    snprintf(src_name, sizeof(src_name), "%s.%d.%lu.c", lib_name, getpid(), build_id);
+    snprintf(tmp_name, sizeof(tmp_name), "%s.%d.%lu.tmp", lib_name, getpid(), build_id);
+
+    FILE* file = fopen(src_name, "w");
+    _LOG_FAIL_CHECK_(file, "error", ERROR_REPORTS, return false, err_code, ENOENT);
+    fwrite(source, sizeof(*source), length, file);
+    fclose(file);
+
+    char command[3 * NATIVE_MAX_PATH] = "";
+    snprintf(command, sizeof(command), NATIVE_COMPILE_COMMAND, tmp_name, src_name);
+
+    log_printf(STATUS_REPORTS, "status", "Compiling %s.\n", lib_name);
+
+    int status = system(command);
+    remove(src_name);
+
+    _LOG_FAIL_CHECK_(status == 0, "error", ERROR_REPORTS, {
+        remove(tmp_name);
+        return false;
+    }, err_code, ECHILD);
+
+    _LOG_FAIL_CHECK_(rename(tmp_name, lib_name) == 0, "error", ERROR_REPORTS, {
+        remove(tmp_name);
+        return false;
+    }, err_code, errno);
+
+    return true;
+}
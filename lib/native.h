@@ -0,0 +1,74 @@
+/**
+ * @file native.h
+ * @author Kudryashov Ilya (kudriashov.it@phystech.edu)
+ * @brief Compilation of equations into native code.
+ * @version 0.1
+ * @date 2022-12-12
+ * 
+ * @copyright Copyright (c) 2022
+ * 
+ */
+
+#ifndef NATIVE_H
+#define NATIVE_H
+
+#include <stdlib.h>
+#include <errno.h>
+
+#include "bin_tree.h"
+
+//* Folder compiled libraries are cached in.
+static const char NATIVE_CACHE_FOLDER[] = "native_cache";
+
+//* Command used to build the library, receives output and source file names.
+static const char NATIVE_COMPILE_COMMAND[] = "cc -O2 -shared -fPIC -o %s %s -lm";
+
+//* Maximum length of names of cached files.
+static const size_t NATIVE_MAX_PATH = 512;
+
+//* Maximum derivative power to compile.
+static const size_t NATIVE_MAX_ORDER = 16;
+
+//* Upper estimate of the number of characters a single node takes in C code.
+static const size_t NATIVE_NODE_LENGTH = 40;
+
+//* Compiled function of X.
+typedef double native_function_t(double x);
+
+//* Shared library with an equation and its derivatives.
+struct NativeEquation {
+    void* handle = NULL;
+
+    native_function_t** functions = NULL;   //* functions[k] is the k-th derivative of the equation.
+    size_t order = 0;
+};
+
+/**
+ * @brief Compile the equation and its derivatives into native code.
+ * Libraries are cached on disk by the hash of their source, so equal equations are compiled only once.
+ * 
+ * @param native
+ * @param equation
+ * @param order maximum derivative power to compile
+ * @param err_code variable to use as errno
+ */
+void NativeEquation_ctor(NativeEquation* native, const Equation* equation, size_t order = 0,
+                         int* const err_code = &errno);
+
+/**
+ * @brief Unload the library.
+ * 
+ * @param native
+ */
+void NativeEquation_dtor(NativeEquation* native);
+
+/**
+ * @brief Get the compiled derivative.
+ * 
+ * @param native
+ * @param order derivative power (0 = the equation itself)
+ * @return function pointer (NULL if the derivative was not compiled)
+ */
+native_function_t* NativeEquation_get(const NativeEquation* native, size_t order);
+
+#endif
@@ -0,0 +1,89 @@
+#include "node_map.h"
+
+#include "util/dbg/debug.h"
+
+/**
+ * @brief Get the first slot to look for the node in.
+ * 
+ * @param node
+ * @param mask capacity of the slot array minus one
+ * @return slot index
+ */
+static inline size_t key_index(const Equation* node, size_t mask) {
+    hash_t hash = (hash_t)(uintptr_t)node * 0x9E3779B97F4A7C15ULL;
+    return (size_t)(hash ^ (hash >> 29)) & mask;
+}
+
+/**
+ * @brief Double the capacity of the map.
+ * 
+ * @param map
+ * @param err_code variable to use as errno
+ */
+static void grow(NodeMap* map, int* const err_code = &errno);
+
+void NodeMap_ctor(NodeMap* map, size_t capacity) {
+    _LOG_FAIL_CHECK_(map, "error", ERROR_REPORTS, return, &errno, EFAULT);
+
+    map->capacity = 1;
+    while (map->capacity < (capacity ? capacity : NODE_MAP_DEFAULT_CAPACITY)) map->capacity <<= 1;
+
+    map->size = 0;
+    map->slots = (NodeInfo*) calloc(map->capacity, sizeof(*map->slots));
+    _LOG_FAIL_CHECK_(map->slots, "error", ERROR_REPORTS, map->capacity = 0, &errno, ENOMEM);
+}
+
+void NodeMap_dtor(NodeMap* map) {
+    if (!map) return;
+
+    free(map->slots);
+    map->slots = NULL;
+    map->capacity = 0;
+    map->size = 0;
+}
+
+NodeInfo* NodeMap_find(const NodeMap* map, const Equation* node) {
+    if (!map || !map->slots || !node) return NULL;
+
+    size_t mask = map->capacity - 1;
+    for (size_t index = key_index(node, mask); map->slots[index].node; index = (index + 1) & mask) {
+        if (map->slots[index].node == node) return &map->slots[index];
+    }
+
+    return NULL;
+}
+
+NodeInfo* NodeMap_get(NodeMap* map, const Equation* node, int* const err_code) {
+    _LOG_FAIL_CHECK_(map && map->slots && node, "error", ERROR_REPORTS, return NULL, err_code, EFAULT);
+
+    if ((map->size + 1) * 2 > map->capacity) grow(map, err_code);
+
+    size_t mask = map->capacity - 1;
+    size_t index = key_index(node, mask);
+    for (; map->slots[index].node; index = (index + 1) & mask) {
+        if (map->slots[index].node == node) return &map->slots[index];
+    }
+
+    ++map->size;
+    map->slots[index] = { .node = node, .image = NULL, .uses = 0, .slot = 0 };
+    return &map->slots[index];
+}
+
+static void grow(NodeMap* map, int* const err_code) {
+    size_t new_capacity = map->capacity * 2;
+    NodeInfo* new_slots = (NodeInfo*) calloc(new_capacity, sizeof(*new_slots));
+    _LOG_FAIL_CHECK_(new_slots, "error", ERROR_REPORTS, return, err_code, ENOMEM);
+
+    size_t mask = new_capacity - 1;
+    for (size_t id = 0; id < map->capacity; ++id) {
+        if (!map->slots[id].node) continue;
+
+        size_t index = key_index(map->slots[id].node, mask);
+        while (new_slots[index].node) index = (index + 1) & mask;
+        new_slots[index] = map->slots[id];
+    }
+
+    free(map->slots);
+    map->slots = new_slots;
+    map->capacity = new_capacity;
+}
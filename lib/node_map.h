@@ -0,0 +1,75 @@
+/**
+ * @file node_map.h
+ * @author Kudryashov Ilya (kudriashov.it@phystech.edu)
+ * @brief Map from equation nodes to information about them.
+ * @version 0.1
+ * @date 2022-12-10
+ * 
+ * @copyright Copyright (c) 2022
+ * 
+ */
+
+#ifndef NODE_MAP_H
+#define NODE_MAP_H
+
+#include <stdlib.h>
+#include <errno.h>
+
+#include "bin_tree.h"
+
+static const size_t NODE_MAP_DEFAULT_CAPACITY = 256;
+
+//* Information attached to a node of a shared equation.
+struct NodeInfo {
+    const Equation* node = NULL;
+    Equation* image = NULL;     //* Node the key was translated to.
+    size_t uses = 0;            //* Number of references to the node.
+    size_t slot = 0;            //* Index of the cell the node value is saved to.
+};
+
+/**
+ * @brief Hash map keyed by node addresses.
+ * Lets passes over shared equations visit every node once, no matter how many parents reference it.
+ */
+struct NodeMap {
+    NodeInfo* slots = NULL;
+    size_t capacity = 0;
+    size_t size = 0;
+};
+
+/**
+ * @brief Initialize the map.
+ * 
+ * @param map
+ * @param capacity initial number of slots (0 = default)
+ */
+void NodeMap_ctor(NodeMap* map, size_t capacity = 0);
+
+/**
+ * @brief Release the map.
+ * 
+ * @param map
+ */
+void NodeMap_dtor(NodeMap* map);
+
+/**
+ * @brief Find information about the node.
+ * 
+ * @param map
+ * @param node
+ * @return node information (NULL if the node is not in the map)
+ */
+NodeInfo* NodeMap_find(const NodeMap* map, const Equation* node);
+
+/**
+ * @brief Get information about the node, adding empty record if there is none.
+ * Pointers to records become invalid after the next insertion.
+ * 
+ * @param map
+ * @param node
+ * @param err_code variable to use as errno
+ * @return node information (NULL on failure)
+ */
+NodeInfo* NodeMap_get(NodeMap* map, const Equation* node, int* const err_code = &errno);
+
+#endif
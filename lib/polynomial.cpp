@@ -0,0 +1,575 @@
+#include "polynomial.h"
+
+#include <cstring>
+#include <math.h>
+
+#include "util/util.h"
+#include "util/dbg/debug.h"
+
+#include "traversal.h"
+#include "equation_table.h"
+#include "node_map.h"
+
+/**
+ * @brief Compare monomials of two terms in order of decreasing degree.
+ * 
+ * @param alpha
+ * @param beta
+ * @return negative if alpha goes first, positive if beta goes first, 0 if monomials are equal
+ */
+static int compare_monomials(const Monomial* alpha, const Monomial* beta);
+
+//* Polynomials of visited branches, waiting for their parents to be expanded.
+struct PolyStack {
+    Polynomial* items = NULL;
+    size_t size = 0;
+    size_t capacity = 0;
+};
+
+/**
+ * @brief Put the polynomial on top of the stack, the stack owns it afterwards.
+ * 
+ * @param stack
+ * @param poly
+ * @param err_code variable to use as errno
+ * @return false if the stack could not grow (polynomial is destroyed then)
+ */
+static bool PolyStack_push(PolyStack* stack, Polynomial poly, int* const err_code);
+
+/**
+ * @brief Destroy the stack and every polynomial left in it.
+ * 
+ * @param stack
+ */
+static void PolyStack_dtor(PolyStack* stack);
+
+/**
+ * @brief Expand the equation into empty polynomial.
+ * 
+ * @param poly
+ * @param equation
+ * @param atoms
+ * @param err_code variable to use as errno
+ * @return false if the expansion is too big
+ */
+static bool expand(Polynomial* poly, const Equation* equation, PolyAtoms* atoms, int* const err_code);
+
+/**
+ * @brief Expand the polynomial operation, given the expansions of its operands.
+ * 
+ * @param poly where to write the expansion
+ * @param equation polynomial operation
+ * @param alpha expansion of the left operand (consumed)
+ * @param beta expansion of the right operand (consumed, NULL if the operand is a constant parameter)
+ * @param err_code variable to use as errno
+ * @return false if the expansion is too big
+ */
+static bool expand_op(Polynomial* poly, const Equation* equation, Polynomial* alpha, Polynomial* beta,
+                      int* const err_code);
+
+/**
+ * @brief Put the subexpression into empty polynomial as a single atom.
+ * 
+ * @param poly
+ * @param equation
+ * @param atoms
+ * @param err_code variable to use as errno
+ * @return false if there is no space left for a new atom
+ */
+static bool expand_atom(Polynomial* poly, const Equation* equation, PolyAtoms* atoms, int* const err_code);
+
+/**
+ * @brief Add product of two polynomials to the polynomial.
+ * 
+ * @param poly
+ * @param alpha
+ * @param beta
+ * @param err_code variable to use as errno
+ * @return false if the product is too big
+ */
+static bool add_product(Polynomial* poly, const Polynomial* alpha, const Polynomial* beta, int* const err_code);
+
+/**
+ * @brief Find the smallest number turning every coefficient of the polynomial into an integer.
+ * 
+ * @param poly
+ * @return common denominator (1 if there is none below POLY_MAX_DENOMINATOR)
+ */
+static double common_denominator(const Polynomial* poly);
+
+/**
+ * @brief Replace the polynomial subtree with its collected form, if the form is different and not bigger.
+ * 
+ * @param equation
+ * @param err_code variable to use as errno
+ * @return true if the subtree was replaced
+ */
+static bool collect(Equation* equation, int* const err_code);
+
+/**
+ * @brief Build the equation of the polynomial.
+ * 
+ * @param poly
+ * @param atoms
+ * @param table table to build the equation in (NULL to build a tree of copied atoms)
+ * @param err_code variable to use as errno
+ * @return new equation
+ */
+static Equation* build(const Polynomial* poly, const PolyAtoms* atoms, EquationTable* table, int* const err_code);
+
+/**
+ * @brief Copy terms of the polynomial into empty polynomial.
+ * 
+ * @param poly
+ * @param source
+ * @param err_code variable to use as errno
+ */
+static void copy(Polynomial* poly, const Polynomial* source, int* const err_code);
+
+void Polynomial_ctor(Polynomial* poly, size_t capacity, int* const err_code) {
+    _LOG_FAIL_CHECK_(poly, "error", ERROR_REPORTS, return, err_code, EFAULT);
+
+    poly->size = 0;
+    poly->capacity = capacity ? capacity : POLY_DEFAULT_CAPACITY;
+    poly->terms = (Monomial*) calloc(poly->capacity, sizeof(*poly->terms));
+    _LOG_FAIL_CHECK_(poly->terms, "error", ERROR_REPORTS, poly->capacity = 0, err_code, ENOMEM);
+}
+
+void Polynomial_dtor(Polynomial* poly) {
+    if (!poly) return;
+
+    free(poly->terms);
+    poly->terms = NULL;
+    poly->size = 0;
+    poly->capacity = 0;
+}
+
+void Polynomial_add_term(Polynomial* poly, const Monomial* term, int* const err_code) {
+    _LOG_FAIL_CHECK_(poly && term, "error", ERROR_REPORTS, return, err_code, EFAULT);
+
+    if (is_equal(term->coef, 0.0)) return;
+
+    size_t left = 0, right = poly->size;
+    while (left < right) {
+        size_t middle = (left + right) / 2;
+        int order = compare_monomials(&poly->terms[middle], term);
+
+        if (order == 0) {
+            poly->terms[middle].coef += term->coef;
+            if (is_equal(poly->terms[middle].coef, 0.0)) {
+                memmove(poly->terms + middle, poly->terms + middle + 1,
+                        (poly->size - middle - 1) * sizeof(*poly->terms));
+                --poly->size;
+            }
+            return;
+        }
+
+        if (order < 0) left = middle + 1;
+        else right = middle;
+    }
+
+    if (poly->size >= poly->capacity) {
+        size_t new_capacity = poly->capacity ? poly->capacity * 2 : POLY_DEFAULT_CAPACITY;
+        Monomial* new_terms = (Monomial*) realloc(poly->terms, new_capacity * sizeof(*poly->terms));
+        _LOG_FAIL_CHECK_(new_terms, "error", ERROR_REPORTS, return, err_code, ENOMEM);
+
+        poly->terms = new_terms;
+        poly->capacity = new_capacity;
+    }
+
+    memmove(poly->terms + left + 1, poly->terms + left, (poly->size - left) * sizeof(*poly->terms));
+    poly->terms[left] = *term;
+    ++poly->size;
+}
+
+bool Polynomial_from_equation(Polynomial* poly, const Equation* equation, PolyAtoms* atoms, int* const err_code) {
+    _LOG_FAIL_CHECK_(poly && equation && atoms, "error", ERROR_REPORTS, return false, err_code, EFAULT);
+
+    if (expand(poly, equation, atoms, err_code)) return true;
+
+    poly->size = 0;
+    return false;
+}
+
+Equation* Polynomial_to_equation(const Polynomial* poly, const PolyAtoms* atoms, int* const err_code) {
+    _LOG_FAIL_CHECK_(poly && atoms, "error", ERROR_REPORTS, return NULL, err_code, EFAULT);
+
+    return build(poly, atoms, NULL, err_code);
+}
+
+Equation* Polynomial_to_table(const Polynomial* poly, const PolyAtoms* atoms, EquationTable* table,
+                              int* const err_code) {
+    _LOG_FAIL_CHECK_(poly && atoms && table, "error", ERROR_REPORTS, return NULL, err_code, EFAULT);
+
+    return build(poly, atoms, table, err_code);
+}
+
+void Equation_collect_terms(Equation* equation, NodeMap* collected, int* const err_code) {
+    if (!equation) return;
+
+    //* Index of a frame is set if the parent of the node is a polynomial operation.
+    TraversalStack stack = {};
+
+    bool fine = TraversalStack_push(&stack, { .node = equation }, err_code);
+    while (fine && stack.size) {
+        TraversalFrame frame = TraversalStack_pop(&stack);
+        Equation* node = (Equation*)frame.node;
+
+        if (node->type != TYPE_OP) continue;
+
+        bool polynomial = Equation_is_polynomial_op(node);
+
+        if (frame.stage == STAGE_ENTER) {
+            fine = TraversalStack_push(&stack, { .node = node, .stage = STAGE_EXIT, .index = frame.index }, err_code) &&
+                   (!node->right || TraversalStack_push(&stack, { .node = node->right, .index = polynomial }, err_code)) &&
+                   (!node->left  || TraversalStack_push(&stack, { .node = node->left,  .index = polynomial }, err_code));
+            continue;
+        }
+
+        if (polynomial && !frame.index && collect(node, err_code) && collected) NodeMap_get(collected, node, err_code);
+    }
+
+    TraversalStack_dtor(&stack);
+}
+
+static inline Equation* poly_const(EquationTable* table, double value, int* const err_code) {
+    if (table) return EquationTable_node(table, TYPE_CONST, { .dbl = value }, NULL, NULL, err_code);
+    return Equation_new(TYPE_CONST, { .dbl = value }, NULL, NULL, err_code);
+}
+
+static inline Equation* poly_op(EquationTable* table, Operator op, Equation* left, Equation* right,
+                                int* const err_code) {
+    if (table) return EquationTable_op(table, op, left, right, err_code);
+    return Equation_new(TYPE_OP, { .op = op }, left, right, err_code);
+}
+
+static inline Equation* poly_atom(EquationTable* table, const Equation* atom) {
+    //* Shared atoms are immutable, so they are referenced instead of being copied.
+    return table ? (Equation*)atom : Equation_copy(atom);
+}
+
+static Equation* build(const Polynomial* poly, const PolyAtoms* atoms, EquationTable* table, int* const err_code) {
+    if (poly->size == 0) return poly_const(table, 0.0, err_code);
+
+    //* Fractional coefficients are brought to a common denominator, so they are written exactly.
+    double denominator = common_denominator(poly);
+
+    Equation* sum = NULL;
+
+    for (size_t term_id = 0; term_id < poly->size; ++term_id) {
+        const Monomial* term = &poly->terms[term_id];
+
+        Equation* factor = NULL;
+        for (size_t atom_id = 0; atom_id < atoms->size; ++atom_id) {
+            if (!term->powers[atom_id]) continue;
+
+            Equation* power = poly_atom(table, atoms->list[atom_id]);
+            if (term->powers[atom_id] > 1)
+                power = poly_op(table, OP_POW, power, poly_const(table, term->powers[atom_id], err_code), err_code);
+
+            factor = factor ? poly_op(table, OP_MUL, factor, power, err_code) : power;
+        }
+
+        //* Negative terms after the first one are subtracted instead of being added with negative coefficient.
+        double coef = (sum ? fabs(term->coef) : term->coef) * denominator;
+        if (!is_equal(denominator, 1.0)) coef = round(coef);
+
+        Equation* member = NULL;
+        if (!factor) member = poly_const(table, coef, err_code);
+        else if (is_equal(coef, 1.0)) member = factor;
+        else member = poly_op(table, OP_MUL, poly_const(table, coef, err_code), factor, err_code);
+
+        if (!sum) sum = member;
+        else sum = poly_op(table, term->coef < 0.0 ? OP_SUB : OP_ADD, sum, member, err_code);
+    }
+
+    if (!is_equal(denominator, 1.0))
+        sum = poly_op(table, OP_DIV, sum, poly_const(table, denominator, err_code), err_code);
+
+    return sum;
+}
+
+static void copy(Polynomial* poly, const Polynomial* source, int* const err_code) {
+    //* Terms of the source are sorted already, so every one of them is appended to the end.
+    for (size_t term_id = 0; term_id < source->size; ++term_id)
+        Polynomial_add_term(poly, &source->terms[term_id], err_code);
+}
+
+static int compare_monomials(const Monomial* alpha, const Monomial* beta) {
+    unsigned int alpha_degree = 0, beta_degree = 0;
+    for (size_t atom_id = 0; atom_id < POLY_MAX_ATOMS; ++atom_id) {
+        alpha_degree += alpha->powers[atom_id];
+        beta_degree  += beta->powers[atom_id];
+    }
+
+    if (alpha_degree != beta_degree) return alpha_degree > beta_degree ? -1 : 1;
+
+    for (size_t atom_id = 0; atom_id < POLY_MAX_ATOMS; ++atom_id) {
+        if (alpha->powers[atom_id] != beta->powers[atom_id])
+            return alpha->powers[atom_id] > beta->powers[atom_id] ? -1 : 1;
+    }
+
+    return 0;
+}
+
+static double common_denominator(const Polynomial* poly) {
+    for (double denominator = 1.0; denominator <= POLY_MAX_DENOMINATOR; denominator += 1.0) {
+        size_t term_id = 0;
+        while (term_id < poly->size) {
+            double scaled = poly->terms[term_id].coef * denominator;
+            if (!is_equal(scaled, round(scaled))) break;
+            ++term_id;
+        }
+
+        if (term_id == poly->size) return denominator;
+    }
+
+    return 1.0;
+}
+
+static bool PolyStack_push(PolyStack* stack, Polynomial poly, int* const err_code) {
+    if (stack->size == stack->capacity) {
+        size_t new_capacity = stack->capacity ? stack->capacity * 2 : POLY_DEFAULT_CAPACITY;
+        Polynomial* new_items = (Polynomial*) realloc(stack->items, new_capacity * sizeof(*stack->items));
+        _LOG_FAIL_CHECK_(new_items, "error", ERROR_REPORTS, { Polynomial_dtor(&poly); return false; },
+                         err_code, ENOMEM);
+
+        stack->items = new_items;
+        stack->capacity = new_capacity;
+    }
+
+    stack->items[stack->size++] = poly;
+    return true;
+}
+
+static void PolyStack_dtor(PolyStack* stack) {
+    while (stack->size) Polynomial_dtor(&stack->items[--stack->size]);
+
+    free(stack->items);
+    stack->items = NULL;
+    stack->capacity = 0;
+}
+
+static bool expand(Polynomial* poly, const Equation* equation, PolyAtoms* atoms, int* const err_code) {
+    TraversalStack stack = {};
+    PolyStack results = {};
+
+    //* Shared subexpressions are expanded once, their expansions are kept in the order they were finished.
+    NodeMap expanded = {};
+    NodeMap_ctor(&expanded);
+    PolyStack finished = {};
+
+    bool success = TraversalStack_push(&stack, { .node = equation }, err_code);
+    while (success && stack.size) {
+        TraversalFrame frame = TraversalStack_pop(&stack);
+        const Equation* node = frame.node;
+
+        bool composite = node->type == TYPE_OP && Equation_is_polynomial_op(node);
+        //* Right operands of division and power are constant parameters, not polynomials.
+        bool expand_right = composite && node->value.op != OP_DIV && node->value.op != OP_POW;
+
+        NodeInfo* info = frame.stage == STAGE_ENTER ? NodeMap_find(&expanded, node) : NULL;
+
+        if (frame.stage == STAGE_ENTER && composite && !info) {
+            success = TraversalStack_push(&stack, { .node = node, .stage = STAGE_EXIT }, err_code) &&
+                      (!expand_right || TraversalStack_push(&stack, { .node = node->right }, err_code)) &&
+                      TraversalStack_push(&stack, { .node = node->left }, err_code);
+            continue;
+        }
+
+        Polynomial result = {};
+        Polynomial_ctor(&result, 0, err_code);
+
+        if (info) {
+            copy(&result, &finished.items[info->slot], err_code);
+        } else if (composite) {
+            Polynomial beta = expand_right ? results.items[--results.size] : Polynomial {};
+            Polynomial alpha = results.items[--results.size];
+
+            success = expand_op(&result, node, &alpha, expand_right ? &beta : NULL, err_code);
+        } else if (node->type == TYPE_CONST) {
+            Monomial term = {};
+            term.coef = node->value.dbl;
+            Polynomial_add_term(&result, &term, err_code);
+        } else if (node->type == TYPE_VAR || node->type == TYPE_OP) {
+            success = expand_atom(&result, node, atoms, err_code);
+        } else {
+            success = false;
+        }
+
+        if (success && composite && !info) {
+            Polynomial saved = {};
+            Polynomial_ctor(&saved, result.size, err_code);
+            copy(&saved, &result, err_code);
+
+            info = NodeMap_get(&expanded, node, err_code);
+            if (info) info->slot = finished.size;
+
+            success = info && PolyStack_push(&finished, saved, err_code);
+            if (!info) Polynomial_dtor(&saved);
+        }
+
+        if (success) success = PolyStack_push(&results, result, err_code);
+        else Polynomial_dtor(&result);
+    }
+
+    if (success) {
+        Polynomial_dtor(poly);
+        *poly = results.items[--results.size];
+    }
+
+    TraversalStack_dtor(&stack);
+    PolyStack_dtor(&results);
+    PolyStack_dtor(&finished);
+    NodeMap_dtor(&expanded);
+
+    return success;
+}
+
+static bool expand_op(Polynomial* poly, const Equation* equation, Polynomial* alpha, Polynomial* beta,
+                      int* const err_code) {
+    bool success = true;
+    Monomial term = {};
+
+    switch (equation->value.op) {
+    case OP_ADD:
+    case OP_SUB:
+        Polynomial_dtor(poly);
+        *poly = *alpha;
+        *alpha = {};
+
+        for (size_t term_id = 0; term_id < beta->size; ++term_id) {
+            term = beta->terms[term_id];
+            if (equation->value.op == OP_SUB) term.coef = -term.coef;
+            Polynomial_add_term(poly, &term, err_code);
+        }
+
+        success = poly->size <= POLY_MAX_TERMS;
+        break;
+
+    case OP_MUL:
+        success = add_product(poly, alpha, beta, err_code);
+        break;
+
+    case OP_DIV:
+        Polynomial_dtor(poly);
+        *poly = *alpha;
+        *alpha = {};
+
+        for (size_t term_id = 0; term_id < poly->size; ++term_id)
+            poly->terms[term_id].coef /= equation->right->value.dbl;
+        break;
+
+    case OP_POW:
+        term.coef = 1.0;
+        Polynomial_add_term(poly, &term, err_code);
+
+        for (int power = (int)round(equation->right->value.dbl); success && power > 0; --power) {
+            Polynomial product = {};
+            Polynomial_ctor(&product, 0, err_code);
+            success = add_product(&product, poly, alpha, err_code);
+
+            Polynomial_dtor(poly);
+            *poly = product;
+        }
+        break;
+
+    case OP_SIN:
+    case OP_COS:
+    case OP_LN:
+    default: success = false; break;
+    }
+
+    Polynomial_dtor(alpha);
+    Polynomial_dtor(beta);
+
+    return success;
+}
+
+static bool expand_atom(Polynomial* poly, const Equation* equation, PolyAtoms* atoms, int* const err_code) {
+    size_t atom_id = 0;
+    while (atom_id < atoms->size && !Equation_equal(atoms->list[atom_id], equation)) ++atom_id;
+
+    if (atom_id == atoms->size) {
+        if (atoms->size >= POLY_MAX_ATOMS) return false;
+        atoms->list[atoms->size++] = equation;
+    }
+
+    Monomial term = {};
+    term.coef = 1.0;
+    term.powers[atom_id] = 1;
+    Polynomial_add_term(poly, &term, err_code);
+
+    return true;
+}
+
+static bool add_product(Polynomial* poly, const Polynomial* alpha, const Polynomial* beta, int* const err_code) {
+    for (size_t alpha_id = 0; alpha_id < alpha->size; ++alpha_id) {
+        for (size_t beta_id = 0; beta_id < beta->size; ++beta_id) {
+            Monomial term = {};
+            term.coef = alpha->terms[alpha_id].coef * beta->terms[beta_id].coef;
+
+            for (size_t atom_id = 0; atom_id < POLY_MAX_ATOMS; ++atom_id) {
+                int power = alpha->terms[alpha_id].powers[atom_id] + beta->terms[beta_id].powers[atom_id];
+                if (power > POLY_MAX_DEGREE) return false;
+                term.powers[atom_id] = (unsigned short)power;
+            }
+
+            Polynomial_add_term(poly, &term, err_code);
+        }
+    }
+
+    return poly->size <= POLY_MAX_TERMS;
+}
+
+static bool collect(Equation* equation, int* const err_code) {
+    bool replaced = false;
+
+    PolyAtoms atoms = {};
+    Polynomial poly = {};
+    Polynomial_ctor(&poly, 0, err_code);
+
+    if (Polynomial_from_equation(&poly, equation, &atoms, err_code)) {
+        Equation* expanded = Polynomial_to_equation(&poly, &atoms, err_code);
+
+        replaced = expanded && Equation_size(expanded) <= Equation_size(equation) && !Equation_equal(expanded, equation);
+
+        if (replaced) {
+            Equation_dtor(&equation->left);
+            Equation_dtor(&equation->right);
+
+            equation->type  = expanded->type;
+            equation->value = expanded->value;
+            equation->left  = expanded->left;
+            equation->right = expanded->right;
+
+            expanded->left = expanded->right = NULL;
+        }
+
+        Equation_dtor(&expanded);
+    }
+
+    Polynomial_dtor(&poly);
+
+    return replaced;
+}
+
+bool Equation_is_polynomial_op(const Equation* equation) {
+    if (equation->type != TYPE_OP) return false;
+
+    const Equation* right = equation->right;
+
+    switch (equation->value.op) {
+    case OP_ADD:
+    case OP_SUB:
+    case OP_MUL: return true;
+    case OP_DIV: return right->type == TYPE_CONST && !is_equal(right->value.dbl, 0.0);
+    case OP_POW:
+        return right->type == TYPE_CONST && right->value.dbl >= 0.0 && right->value.dbl <= POLY_MAX_DEGREE &&
+               is_equal(right->value.dbl, round(right->value.dbl));
+    case OP_SIN:
+    case OP_COS:
+    case OP_LN:
+    default: return false;
+    }
+}
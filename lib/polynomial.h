@@ -0,0 +1,137 @@
+/**
+ * @file polynomial.h
+ * @author Kudryashov Ilya (kudriashov.it@phystech.edu)
+ * @brief Sparse polynomials over equation subexpressions.
+ * @version 0.1
+ * @date 2022-12-09
+ * 
+ * @copyright Copyright (c) 2022
+ * 
+ */
+
+#ifndef POLYNOMIAL_H
+#define POLYNOMIAL_H
+
+#include <stdlib.h>
+#include <errno.h>
+
+#include "bin_tree.h"
+
+struct EquationTable;
+struct NodeMap;
+
+//* Maximum number of distinct atoms (variables and non-polynomial subexpressions) in one polynomial.
+static const size_t POLY_MAX_ATOMS = 8;
+
+//* Maximum integer power to expand.
+static const unsigned short POLY_MAX_DEGREE = 64;
+
+//* Maximum number of terms, bigger polynomials are left unexpanded.
+static const size_t POLY_MAX_TERMS = 256;
+
+//* Maximum common denominator of coefficients to write the polynomial as a fraction with.
+static const double POLY_MAX_DENOMINATOR = 1000.0;
+
+static const size_t POLY_DEFAULT_CAPACITY = 8;
+
+//* List of subexpressions polynomial terms are built of.
+struct PolyAtoms {
+    const Equation* list[POLY_MAX_ATOMS] = {};
+    size_t size = 0;
+};
+
+//* Term of the polynomial, coef * atom[0]^powers[0] * atom[1]^powers[1] * ...
+struct Monomial {
+    double coef = 0.0;
+    unsigned short powers[POLY_MAX_ATOMS] = {};
+};
+
+/**
+ * @brief Polynomial as a sorted list of terms with unique monomials.
+ * Terms go in order of decreasing total degree and have non-zero coefficients.
+ */
+struct Polynomial {
+    Monomial* terms = NULL;
+    size_t size = 0;
+    size_t capacity = 0;
+};
+
+/**
+ * @brief Initialize empty (zero) polynomial.
+ * 
+ * @param poly
+ * @param capacity initial number of terms (0 = default)
+ * @param err_code variable to use as errno
+ */
+void Polynomial_ctor(Polynomial* poly, size_t capacity = 0, int* const err_code = &errno);
+
+/**
+ * @brief Destroy the polynomial.
+ * 
+ * @param poly
+ */
+void Polynomial_dtor(Polynomial* poly);
+
+/**
+ * @brief Add the term to the polynomial, merging it with the term of the same monomial.
+ * 
+ * @param poly
+ * @param term
+ * @param err_code variable to use as errno
+ */
+void Polynomial_add_term(Polynomial* poly, const Monomial* term, int* const err_code = &errno);
+
+/**
+ * @brief Expand the equation into the polynomial.
+ * 
+ * @param poly empty polynomial to write the result to
+ * @param equation
+ * @param atoms atoms of the polynomial (new atoms are appended to the list)
+ * @param err_code variable to use as errno
+ * @return false if the equation has too many atoms or terms to be expanded (polynomial is left empty)
+ */
+bool Polynomial_from_equation(Polynomial* poly, const Equation* equation, PolyAtoms* atoms,
+                              int* const err_code = &errno);
+
+/**
+ * @brief Build the equation of the polynomial.
+ * 
+ * @param poly
+ * @param atoms atoms the polynomial was built of (are copied into the equation)
+ * @param err_code variable to use as errno
+ * @return new equation
+ */
+Equation* Polynomial_to_equation(const Polynomial* poly, const PolyAtoms* atoms, int* const err_code = &errno);
+
+/**
+ * @brief Build the shared equation of the polynomial.
+ * 
+ * @param poly
+ * @param atoms atoms the polynomial was built of (must belong to the table)
+ * @param table
+ * @param err_code variable to use as errno
+ * @return shared equation
+ */
+Equation* Polynomial_to_table(const Polynomial* poly, const PolyAtoms* atoms, EquationTable* table,
+                              int* const err_code = &errno);
+
+/**
+ * @brief Check if the top node of the equation is an operation polynomials are closed under.
+ * 
+ * @param equation
+ * @return true if the node is a polynomial operation
+ */
+bool Equation_is_polynomial_op(const Equation* equation);
+
+/**
+ * @brief Collect like terms in every polynomial part of the equation.
+ * Maximal subtrees of additions, multiplications, integer powers and divisions by constants are expanded
+ * into sums of monomials, and are replaced with them if the result is different and not bigger.
+ * 
+ * @param equation
+ * @param collected map to add roots of the replaced subtrees to (can be NULL)
+ * @param err_code variable to use as errno
+ */
+void Equation_collect_terms(Equation* equation, NodeMap* collected = NULL, int* const err_code = &errno);
+
+#endif
@@ -0,0 +1,99 @@
+#include "rewrite_rules.h"
+
+#include <math.h>
+
+#include "util/util.h"
+
+/**
+ * @brief Check if the argument fits the pattern.
+ *
+ * @param pattern
+ * @param argument argument to check
+ * @param other the other argument of the operation
+ * @return true if the argument matches
+ */
+static bool matches(RulePattern pattern, const Equation* argument, const Equation* other);
+
+static inline bool is_const(const Equation* equation, double value) {
+    return equation->type == TYPE_CONST && is_equal(equation->value.dbl, value);
+}
+
+bool fold_constants(Operator op, double alpha, double beta, double* result) {
+    switch (op) {
+    case OP_ADD: *result = alpha + beta; return true;
+    case OP_SUB: *result = alpha - beta; return true;
+    case OP_MUL: *result = alpha * beta; return true;
+    case OP_DIV:
+        if (is_equal(beta, 0.0) || !is_equal(alpha / beta, round(alpha / beta))) return false;
+        *result = alpha / beta;
+        return true;
+    case OP_POW:
+        if (!is_equal(beta, round(beta))) return false;
+        *result = pow(alpha, beta);
+        return true;
+    case OP_LN:
+        if (!is_equal(beta, 1.0)) return false;
+        *result = 0.0;
+        return true;
+    case OP_SIN:
+    case OP_COS:
+    default: return false;
+    }
+}
+
+const RewriteRule* find_rewrite_rule(Operator op, const Equation* left, const Equation* right) {
+    if (!left || !right) return NULL;
+
+    for (size_t rule_id = 0; rule_id < REWRITE_RULE_COUNT; ++rule_id) {
+        const RewriteRule* rule = &REWRITE_RULES[rule_id];
+        if (rule->op != op || !matches(rule->left, left, right) || !matches(rule->right, right, left)) continue;
+
+        double folded = 0.0;
+        switch (rule->action) {
+        case ACT_FOLD:
+            if (!fold_constants(op, left->value.dbl, right->value.dbl, &folded)) continue;
+            break;
+        case ACT_MERGE_POW:
+            //* (x^a)^b = x^(ab) holds for any x only if b is an integer.
+            if (!is_equal(right->value.dbl, round(right->value.dbl))) continue;
+            break;
+        case ACT_LEFT:
+        case ACT_RIGHT:
+        case ACT_ZERO:
+        case ACT_ONE:
+        case ACT_NEGATE:
+        case ACT_DOUBLE:
+        case ACT_SQUARE:
+        case ACT_MERGE_MUL:
+        default: break;
+        }
+
+        return rule;
+    }
+
+    return NULL;
+}
+
+Equation* const_mul_factor(const Equation* product) {
+    return product->left->type == TYPE_CONST ? product->left : product->right;
+}
+
+Equation* const_mul_rest(const Equation* product) {
+    return product->left->type == TYPE_CONST ? product->right : product->left;
+}
+
+static bool matches(RulePattern pattern, const Equation* argument, const Equation* other) {
+    switch (pattern) {
+    case PAT_ANY:   return true;
+    case PAT_CONST: return argument->type == TYPE_CONST;
+    case PAT_ZERO:  return is_const(argument, 0.0);
+    case PAT_ONE:   return is_const(argument, 1.0);
+    case PAT_SAME:  return Equation_equal(argument, other);
+    case PAT_CONST_MUL:
+        return argument->type == TYPE_OP && argument->value.op == OP_MUL &&
+               (argument->left->type == TYPE_CONST || argument->right->type == TYPE_CONST);
+    case PAT_CONST_POW:
+        return argument->type == TYPE_OP && argument->value.op == OP_POW && argument->right->type == TYPE_CONST;
+    default: return false;
+    }
+}
@@ -0,0 +1,128 @@
+/**
+ * @file rewrite_rules.h
+ * @author Kudryashov Ilya (kudriashov.it@phystech.edu)
+ * @brief Simplification rules shared by equation simplifiers.
+ * @version 0.1
+ * @date 2022-12-08
+ * 
+ * @copyright Copyright (c) 2022
+ * 
+ */
+
+#ifndef REWRITE_RULES_H
+#define REWRITE_RULES_H
+
+#include <stdlib.h>
+
+#include "bin_tree.h"
+
+//* Requirement for an argument of the operation.
+enum RulePattern {
+    PAT_ANY,        // <-- any subexpression
+    PAT_CONST,      // <-- any constant
+    PAT_ZERO,       // <-- constant 0
+    PAT_ONE,        // <-- constant 1
+    PAT_SAME,       // <-- subexpression equal to the other argument
+    PAT_CONST_MUL,  // <-- multiplication with a constant branch
+    PAT_CONST_POW,  // <-- power with a constant exponent
+};
+
+//* What the operation is replaced with.
+enum RuleAction {
+    ACT_FOLD,       // <-- value of the operation on constant arguments
+    ACT_LEFT,       // <-- left argument
+    ACT_RIGHT,      // <-- right argument
+    ACT_ZERO,       // <-- constant 0
+    ACT_ONE,        // <-- constant 1
+    ACT_NEGATE,     // <-- 0 - x  ->  -1 * x
+    ACT_DOUBLE,     // <-- x + x  ->  2 * x
+    ACT_SQUARE,     // <-- x * x  ->  x ^ 2
+    ACT_MERGE_MUL,  // <-- a * (b * x)  ->  (a * b) * x
+    ACT_MERGE_POW,  // <-- (x ^ a) ^ b  ->  x ^ (a * b)
+};
+
+struct RewriteRule {
+    Operator op = OP_ADD;
+    RulePattern left = PAT_ANY;
+    RulePattern right = PAT_ANY;
+    RuleAction action = ACT_FOLD;
+    const char* name = "";
+};
+
+//* Simplification rules in order of preference. Unary operations have constant 0 as their left argument.
+static const RewriteRule REWRITE_RULES[] = {
+    { OP_ADD, PAT_CONST,     PAT_CONST,     ACT_FOLD,      "a + b" },
+    { OP_ADD, PAT_ZERO,      PAT_ANY,       ACT_RIGHT,     "0 + x" },
+    { OP_ADD, PAT_ANY,       PAT_ZERO,      ACT_LEFT,      "x + 0" },
+    { OP_ADD, PAT_ANY,       PAT_SAME,      ACT_DOUBLE,    "x + x" },
+
+    { OP_SUB, PAT_CONST,     PAT_CONST,     ACT_FOLD,      "a - b" },
+    { OP_SUB, PAT_ANY,       PAT_ZERO,      ACT_LEFT,      "x - 0" },
+    { OP_SUB, PAT_ZERO,      PAT_ANY,       ACT_NEGATE,    "0 - x" },
+    { OP_SUB, PAT_ANY,       PAT_SAME,      ACT_ZERO,      "x - x" },
+
+    { OP_MUL, PAT_CONST,     PAT_CONST,     ACT_FOLD,      "a * b" },
+    { OP_MUL, PAT_ZERO,      PAT_ANY,       ACT_ZERO,      "0 * x" },
+    { OP_MUL, PAT_ANY,       PAT_ZERO,      ACT_ZERO,      "x * 0" },
+    { OP_MUL, PAT_ONE,       PAT_ANY,       ACT_RIGHT,     "1 * x" },
+    { OP_MUL, PAT_ANY,       PAT_ONE,       ACT_LEFT,      "x * 1" },
+    { OP_MUL, PAT_CONST,     PAT_CONST_MUL, ACT_MERGE_MUL, "a * (b * x)" },
+    { OP_MUL, PAT_CONST_MUL, PAT_CONST,     ACT_MERGE_MUL, "(x * a) * b" },
+    { OP_MUL, PAT_ANY,       PAT_SAME,      ACT_SQUARE,    "x * x" },
+
+    { OP_DIV, PAT_CONST,     PAT_CONST,     ACT_FOLD,      "a / b" },
+    { OP_DIV, PAT_ANY,       PAT_ONE,       ACT_LEFT,      "x / 1" },
+    { OP_DIV, PAT_ZERO,      PAT_ANY,       ACT_ZERO,      "0 / x" },
+    { OP_DIV, PAT_ANY,       PAT_SAME,      ACT_ONE,       "x / x" },
+
+    { OP_POW, PAT_CONST,     PAT_CONST,     ACT_FOLD,      "a ^ b" },
+    { OP_POW, PAT_ANY,       PAT_ONE,       ACT_LEFT,      "x ^ 1" },
+    { OP_POW, PAT_ANY,       PAT_ZERO,      ACT_ONE,       "x ^ 0" },
+    { OP_POW, PAT_ONE,       PAT_ANY,       ACT_ONE,       "1 ^ x" },
+    { OP_POW, PAT_ZERO,      PAT_ANY,       ACT_ZERO,      "0 ^ x" },
+    { OP_POW, PAT_CONST_POW, PAT_CONST,     ACT_MERGE_POW, "(x ^ a) ^ b" },
+
+    { OP_LN,  PAT_CONST,     PAT_CONST,     ACT_FOLD,      "ln(1)" },
+};
+
+static const size_t REWRITE_RULE_COUNT = sizeof(REWRITE_RULES) / sizeof(*REWRITE_RULES);
+
+/**
+ * @brief Calculate operation on two constants if the result can be written exactly.
+ * Division is folded only if the result is an integer, power - only with integer exponent.
+ * 
+ * @param op operation
+ * @param alpha left argument
+ * @param beta right argument
+ * @param result where to put the result
+ * @return true if the operation can be collapsed into a constant
+ */
+bool fold_constants(Operator op, double alpha, double beta, double* result);
+
+/**
+ * @brief Find the first rule applicable to the operation.
+ * 
+ * @param op operation
+ * @param left left argument
+ * @param right right argument
+ * @return matching rule (NULL if there is none)
+ */
+const RewriteRule* find_rewrite_rule(Operator op, const Equation* left, const Equation* right);
+
+/**
+ * @brief Get the constant branch of the multiplication matched by PAT_CONST_MUL.
+ * 
+ * @param product
+ * @return constant branch
+ */
+Equation* const_mul_factor(const Equation* product);
+
+/**
+ * @brief Get the non-constant branch of the multiplication matched by PAT_CONST_MUL.
+ * 
+ * @param product
+ * @return remaining branch
+ */
+Equation* const_mul_rest(const Equation* product);
+
+#endif
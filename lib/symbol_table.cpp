@@ -0,0 +1,187 @@
+#include "symbol_table.h"
+
+#include <string.h>
+#include <pthread.h>
+
+#include "util/dbg/debug.h"
+
+static const size_t SYMBOL_MIN_SLOT_COUNT = 64;
+
+struct LetterNames {
+    char names[SYMBOL_LETTER_COUNT][2] = {};
+};
+
+static constexpr LetterNames make_letter_names() {
+    LetterNames letters = {};
+
+    for (symbol_t id = 0; id < 26; ++id) {
+        letters.names[id][0] = (char)('a' + id);
+        letters.names[id + 26][0] = (char)('A' + id);
+    }
+
+    return letters;
+}
+
+static constexpr LetterNames LETTER_NAMES = make_letter_names();
+
+static SymbolTable GlobalSymbols = {};
+static thread_local SymbolTable* ActiveSymbols = NULL;
+
+static inline SymbolTable* active_table() {
+    return ActiveSymbols ? ActiveSymbols : &GlobalSymbols;
+}
+
+static inline symbol_t letter_symbol(char letter) {
+    if (letter >= 'a' && letter <= 'z') return (symbol_t)(letter - 'a');
+    if (letter >= 'A' && letter <= 'Z') return (symbol_t)(letter - 'A') + 26;
+    return SYMBOL_NONE;
+}
+
+static inline char* stored_name(const SymbolTable* table, symbol_t id) {
+    size_t index = id - SYMBOL_LETTER_COUNT;
+    return table->chunks[index / SYMBOL_CHUNK_SIZE][index % SYMBOL_CHUNK_SIZE];
+}
+
+static inline size_t name_slot(const char* name, size_t length, size_t mask) {
+    return (size_t)get_simple_hash(name, name + length) & mask;
+}
+
+/**
+ * @brief Double the size of the hash index (call with the lock taken).
+ * 
+ * @param table
+ * @param err_code variable to use as errno
+ * @return false if there is not enough memory
+ */
+static bool grow_slots(SymbolTable* table, int* const err_code) {
+    size_t new_count = table->slot_count ? table->slot_count * 2 : SYMBOL_MIN_SLOT_COUNT;
+
+    symbol_t* new_slots = (symbol_t*) calloc(new_count, sizeof(*new_slots));
+    _LOG_FAIL_CHECK_(new_slots, "error", ERROR_REPORTS, return false, err_code, ENOMEM);
+
+    for (symbol_t id = SYMBOL_LETTER_COUNT; id < table->count; ++id) {
+        const char* name = stored_name(table, id);
+
+        size_t index = name_slot(name, strlen(name), new_count - 1);
+        while (new_slots[index]) index = (index + 1) & (new_count - 1);
+
+        new_slots[index] = id + 1;
+    }
+
+    free(table->slots);
+    table->slots = new_slots;
+    table->slot_count = new_count;
+
+    return true;
+}
+
+/**
+ * @brief Find the name in the table or add it there (call with the lock taken).
+ * 
+ * @param table
+ * @param name
+ * @param length
+ * @param err_code variable to use as errno
+ * @return ID of the name
+ */
+static symbol_t find_or_add(SymbolTable* table, const char* name, size_t length, int* const err_code) {
+    if (2 * (table->count - SYMBOL_LETTER_COUNT + 1) > table->slot_count && !grow_slots(table, err_code)) {
+        return SYMBOL_NONE;
+    }
+
+    size_t mask = table->slot_count - 1;
+    size_t index = name_slot(name, length, mask);
+
+    for (; table->slots[index]; index = (index + 1) & mask) {
+        symbol_t id = table->slots[index] - 1;
+        const char* stored = stored_name(table, id);
+
+        if (strncmp(stored, name, length) == 0 && stored[length] == '\0') return id;
+    }
+
+    symbol_t id = table->count;
+    _LOG_FAIL_CHECK_(id < SYMBOL_MAX_COUNT, "error", ERROR_REPORTS, return SYMBOL_NONE, err_code, ENOMEM);
+
+    if (!table->chunks) {
+        table->chunks = (char***) calloc(SYMBOL_CHUNK_COUNT, sizeof(*table->chunks));
+        _LOG_FAIL_CHECK_(table->chunks, "error", ERROR_REPORTS, return SYMBOL_NONE, err_code, ENOMEM);
+    }
+
+    size_t chunk = (id - SYMBOL_LETTER_COUNT) / SYMBOL_CHUNK_SIZE;
+    if (!table->chunks[chunk]) {
+        table->chunks[chunk] = (char**) calloc(SYMBOL_CHUNK_SIZE, sizeof(*table->chunks[chunk]));
+        _LOG_FAIL_CHECK_(table->chunks[chunk], "error", ERROR_REPORTS, return SYMBOL_NONE, err_code, ENOMEM);
+    }
+
+    char* copy = (char*) calloc(length + 1, sizeof(*copy));
+    _LOG_FAIL_CHECK_(copy, "error", ERROR_REPORTS, return SYMBOL_NONE, err_code, ENOMEM);
+    memcpy(copy, name, length);
+
+    table->chunks[chunk][(id - SYMBOL_LETTER_COUNT) % SYMBOL_CHUNK_SIZE] = copy;
+    table->slots[index] = id + 1;
+
+    __atomic_store_n(&table->count, id + 1, __ATOMIC_RELEASE);
+
+    return id;
+}
+
+symbol_t Symbol_intern(const char* name, size_t length, int* const err_code) {
+    _LOG_FAIL_CHECK_(name, "error", ERROR_REPORTS, return SYMBOL_NONE, err_code, EFAULT);
+
+    if (length == 1 && letter_symbol(*name) != SYMBOL_NONE) return letter_symbol(*name);
+
+    if (length == 0 || length > SYMBOL_MAX_LENGTH) {
+        log_printf(ERROR_REPORTS, "error", "Variable name of length %ld can not be interned.\n", (long int)length);
+        *err_code = EINVAL;
+        return SYMBOL_NONE;
+    }
+
+    SymbolTable* table = active_table();
+
+    pthread_mutex_lock(&table->lock);
+    symbol_t id = find_or_add(table, name, length, err_code);
+    pthread_mutex_unlock(&table->lock);
+
+    return id;
+}
+
+const char* Symbol_name(symbol_t id) {
+    if (id < SYMBOL_LETTER_COUNT) return LETTER_NAMES.names[id];
+    if (id >= Symbol_count()) return NULL;
+
+    return stored_name(active_table(), id);
+}
+
+symbol_t Symbol_count() {
+    return __atomic_load_n(&active_table()->count, __ATOMIC_ACQUIRE);
+}
+
+void SymbolTable_ctor(SymbolTable* table) {
+    *table = {};
+}
+
+void SymbolTable_dtor(SymbolTable* table) {
+    for (symbol_t id = SYMBOL_LETTER_COUNT; id < table->count; ++id) {
+        free(stored_name(table, id));
+    }
+
+    for (size_t chunk = 0; table->chunks && chunk < SYMBOL_CHUNK_COUNT; ++chunk) {
+        free(table->chunks[chunk]);
+    }
+
+    free(table->chunks);
+    table->chunks = NULL;
+
+    free(table->slots);
+    table->slots = NULL;
+    table->slot_count = 0;
+    table->count = SYMBOL_LETTER_COUNT;
+
+    if (ActiveSymbols == table) ActiveSymbols = NULL;
+}
+
+SymbolTable* SymbolTable_bind(SymbolTable* table) {
+    SymbolTable* previous = ActiveSymbols;
+    ActiveSymbols = table;
+    return previous;
+}
@@ -0,0 +1,97 @@
+/**
+ * @file symbol_table.h
+ * @author Kudryashov Ilya (kudriashov.it@phystech.edu)
+ * @brief Interned variable names.
+ * @version 0.1
+ * @date 2022-12-19
+ * 
+ * @copyright Copyright (c) 2022
+ * 
+ */
+
+#ifndef SYMBOL_TABLE_H
+#define SYMBOL_TABLE_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+#include <pthread.h>
+
+//* Dense ID of a variable name, equal names always get equal IDs.
+typedef uint32_t symbol_t;
+
+//* Single letters are interned in advance: a-z get IDs 0-25, A-Z get IDs 26-51.
+static const symbol_t SYMBOL_LETTER_COUNT = 52;
+
+//* ID of "x", the variable expressions are differentiated and evaluated by.
+static const symbol_t SYMBOL_X = 'x' - 'a';
+
+static const symbol_t SYMBOL_NONE = UINT32_MAX;
+
+static const size_t SYMBOL_MAX_COUNT = 1 << 20;
+static const size_t SYMBOL_MAX_LENGTH = 256;
+
+static const size_t SYMBOL_CHUNK_SIZE = 1024;
+static const size_t SYMBOL_CHUNK_COUNT = SYMBOL_MAX_COUNT / SYMBOL_CHUNK_SIZE;
+
+//* Names longer than one letter.
+struct SymbolTable {
+    pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+    symbol_t count = SYMBOL_LETTER_COUNT;       //* Number of symbols, read without the lock.
+
+    char*** chunks = NULL;                      //* Names by ID in SYMBOL_CHUNK_COUNT chunks, allocated with the first name.
+                                                //  Chunks are never moved, so names can be read without the lock.
+
+    symbol_t* slots = NULL;                     //* Hash index of names (ID + 1, 0 = empty slot).
+    size_t slot_count = 0;
+};
+
+/**
+ * @brief Initialize empty symbol table (single letters are always there).
+ * 
+ * @param table
+ */
+void SymbolTable_ctor(SymbolTable* table);
+
+/**
+ * @brief Free names of the table. Equations using its symbols should not be printed after that.
+ * 
+ * @param table
+ */
+void SymbolTable_dtor(SymbolTable* table);
+
+/**
+ * @brief Make Symbol_...() functions use the given table instead of the global one.
+ * The binding only affects the calling thread.
+ * 
+ * @param table table to use (NULL = use the global table)
+ * @return previously bound table
+ */
+SymbolTable* SymbolTable_bind(SymbolTable* table);
+
+/**
+ * @brief Get ID of the name, adding it to the bound table if it is new. Can be called from any thread.
+ * 
+ * @param name name of the variable (does not have to be terminated)
+ * @param length length of the name
+ * @param err_code variable to use as errno
+ * @return ID of the name, SYMBOL_NONE if the table is full or the name is too long
+ */
+symbol_t Symbol_intern(const char* name, size_t length, int* const err_code = &errno);
+
+/**
+ * @brief Get the name of the symbol.
+ * 
+ * @param id
+ * @return name of the symbol, NULL if there is no symbol with such ID
+ */
+const char* Symbol_name(symbol_t id);
+
+/**
+ * @brief Get the number of symbols in the table, every ID is smaller than it.
+ * 
+ * @return symbol_t
+ */
+symbol_t Symbol_count();
+
+#endif
@@ -0,0 +1,297 @@
+#include "taylor.h"
+
+#include <cstring>
+#include <math.h>
+
+#include "util/util.h"
+#include "util/dbg/debug.h"
+
+#include "traversal.h"
+
+/**
+ * @brief Calculate series of the expression into the given buffer.
+ * 
+ * @param equation
+ * @param point
+ * @param count number of coefficients
+ * @param out where to write coefficients
+ * @param err_code variable to use as errno
+ * @return false if the series could not be calculated
+ */
+static bool series(const Equation* equation, const double point, const size_t count, double* out,
+                   int* const err_code);
+
+/**
+ * @brief Calculate series of the node from series of its operands.
+ * 
+ * @param equation
+ * @param point
+ * @param count number of coefficients
+ * @param alpha series of the left operand (ignored by unary operations)
+ * @param beta series of the right operand
+ * @param out where to write coefficients
+ * @param extra temporary series
+ * @param err_code variable to use as errno
+ * @return false if the series could not be calculated
+ */
+static bool series_step(const Equation* equation, const double point, const size_t count,
+                        const double* alpha, const double* beta, double* out, double* extra, int* const err_code);
+
+//* out = alpha * beta
+static void series_mul(const double* alpha, const double* beta, size_t count, double* out);
+//* out = alpha / beta
+static bool series_div(const double* alpha, const double* beta, size_t count, double* out);
+//* out = exp(alpha)
+static void series_exp(const double* alpha, size_t count, double* out);
+//* out = ln(alpha)
+static bool series_ln(const double* alpha, size_t count, double* out);
+//* sine = sin(alpha), cosine = cos(alpha)
+static void series_sin_cos(const double* alpha, size_t count, double* sine, double* cosine);
+//* out = alpha ^ beta
+static bool series_pow(const double* alpha, const double* beta, size_t count, double* out);
+
+bool Equation_taylor(const Equation* equation, const double point, const size_t order, double* coefs,
+                     int* const err_code) {
+    _LOG_FAIL_CHECK_(!Equation_get_error(equation), "error", ERROR_REPORTS, return false, err_code, EINVAL);
+    _LOG_FAIL_CHECK_(coefs, "error", ERROR_REPORTS, return false, err_code, EFAULT);
+
+    if (!series(equation, point, order + 1, coefs, err_code)) {
+        log_printf(WARNINGS, "warning", "Series of equation %p at point %lg could not be calculated.\n",
+                                        equation, point);
+        return false;
+    }
+
+    return true;
+}
+
+bool Equation_calculate_derivatives(const Equation* equation, const double x_value, const size_t order,
+                                    double* derivatives, int* const err_code) {
+    if (!Equation_taylor(equation, x_value, order, derivatives, err_code)) return false;
+
+    double factorial = 1.0;
+    for (size_t power = 1; power <= order; ++power) {
+        factorial *= (double)power;
+        derivatives[power] *= factorial;
+    }
+
+    return true;
+}
+
+static bool series(const Equation* equation, const double point, const size_t count, double* out,
+                   int* const err_code) {
+    memset(out, 0, count * sizeof(*out));
+    if (!equation) return true;
+
+    //* Series of visited branches are stacked in a single buffer, series number i starts at i * count.
+    //* Result of an operation is calculated above its operands and then moved into their place.
+    double* stacked = NULL;
+    size_t size = 0, capacity = 0;
+
+    double* extra = (double*) calloc(count, sizeof(*extra));
+    _LOG_FAIL_CHECK_(extra, "error", ERROR_REPORTS, return false, err_code, ENOMEM);
+
+    TraversalStack stack = {};
+
+    bool success = TraversalStack_push(&stack, { .node = equation }, err_code);
+    while (success && stack.size) {
+        TraversalFrame frame = TraversalStack_pop(&stack);
+        const Equation* node = frame.node;
+
+        bool visit_left = node->type == TYPE_OP && node->left && !has_placeholder(node);
+
+        if (frame.stage == STAGE_ENTER && node->type == TYPE_OP) {
+            success = TraversalStack_push(&stack, { .node = node, .stage = STAGE_EXIT }, err_code) &&
+                      TraversalStack_push(&stack, { .node = node->right }, err_code) &&
+                      (!visit_left || TraversalStack_push(&stack, { .node = node->left }, err_code));
+            continue;
+        }
+
+        if (size == capacity) {
+            size_t new_capacity = capacity ? capacity * 2 : TRAVERSAL_LOCAL_CAPACITY;
+            double* new_stacked = (double*) realloc(stacked, new_capacity * count * sizeof(*stacked));
+            _LOG_FAIL_CHECK_(new_stacked, "error", ERROR_REPORTS, success = false, err_code, ENOMEM);
+            if (!success) break;
+
+            stacked = new_stacked;
+            capacity = new_capacity;
+        }
+
+        size_t operands = node->type == TYPE_OP ? (visit_left ? 2 : 1) : 0;
+
+        double* result = stacked + size * count;
+        const double* beta  = operands > 0 ? stacked + (size - 1) * count : NULL;
+        const double* alpha = operands > 1 ? stacked + (size - 2) * count : NULL;
+
+        memset(result, 0, count * sizeof(*result));
+        success = series_step(node, point, count, alpha, beta, result, extra, err_code);
+
+        size -= operands;
+        memmove(stacked + size * count, result, count * sizeof(*result));
+        ++size;
+    }
+
+    if (success) memcpy(out, stacked, count * sizeof(*out));
+
+    TraversalStack_dtor(&stack);
+    free(stacked);
+    free(extra);
+
+    return success;
+}
+
+static bool series_step(const Equation* equation, const double point, const size_t count,
+                        const double* alpha, const double* beta, double* out, double* extra, int* const err_code) {
+    switch (equation->type) {
+    case TYPE_CONST:
+        out[0] = equation->value.dbl;
+        return true;
+    case TYPE_VAR:
+        if (equation->value.id != SYMBOL_X) return true;
+        out[0] = point;
+        if (count > 1) out[1] = 1.0;
+        return true;
+    case TYPE_OP: break;
+    default:
+        log_printf(ERROR_REPORTS, "error",
+            "Somehow NodeType equation->type had an incorrect value of %d.\n", equation->type);
+        return false;
+    }
+
+    bool success = true;
+
+    switch (equation->value.op) {
+    case OP_ADD: for (size_t id = 0; id < count; ++id) out[id] = alpha[id] + beta[id]; break;
+    case OP_SUB: for (size_t id = 0; id < count; ++id) out[id] = alpha[id] - beta[id]; break;
+    case OP_MUL: series_mul(alpha, beta, count, out); break;
+    case OP_DIV:
+        success = series_div(alpha, beta, count, out);
+        _LOG_FAIL_CHECK_(success, "error", ERROR_REPORTS, out[0] = INFINITY, err_code, EINVAL);
+        break;
+    case OP_POW:
+        success = series_pow(alpha, beta, count, out);
+        _LOG_FAIL_CHECK_(success, "error", ERROR_REPORTS, out[0] = pow(alpha[0], beta[0]), err_code, EDOM);
+        break;
+    case OP_SIN: series_sin_cos(beta, count, out, extra); break;
+    case OP_COS: series_sin_cos(beta, count, extra, out); break;
+    case OP_LN:
+        success = series_ln(beta, count, out);
+        _LOG_FAIL_CHECK_(success, "error", ERROR_REPORTS, out[0] = log(beta[0]), err_code, EDOM);
+        break;
+    default:
+        if (err_code) *err_code = EINVAL;
+        log_printf(ERROR_REPORTS, "error",
+            "Somehow Operation equation->value.op had an incorrect value of %d.\n", equation->value.op);
+        success = false;
+        break;
+    }
+
+    return success;
+}
+
+static void series_mul(const double* alpha, const double* beta, size_t count, double* out) {
+    for (size_t power = 0; power < count; ++power) {
+        double sum = 0.0;
+        for (size_t id = 0; id <= power; ++id) sum += alpha[id] * beta[power - id];
+        out[power] = sum;
+    }
+}
+
+static bool series_div(const double* alpha, const double* beta, size_t count, double* out) {
+    if (is_equal(beta[0], 0.0)) return false;
+
+    for (size_t power = 0; power < count; ++power) {
+        double sum = alpha[power];
+        for (size_t id = 1; id <= power; ++id) sum -= beta[id] * out[power - id];
+        out[power] = sum / beta[0];
+    }
+    return true;
+}
+
+static void series_exp(const double* alpha, size_t count, double* out) {
+    out[0] = exp(alpha[0]);
+    for (size_t power = 1; power < count; ++power) {
+        double sum = 0.0;
+        for (size_t id = 1; id <= power; ++id) sum += (double)id * alpha[id] * out[power - id];
+        out[power] = sum / (double)power;
+    }
+}
+
+static bool series_ln(const double* alpha, size_t count, double* out) {
+    if (alpha[0] < 0.0 || is_equal(alpha[0], 0.0)) return false;
+
+    out[0] = log(alpha[0]);
+    for (size_t power = 1; power < count; ++power) {
+        double sum = 0.0;
+        for (size_t id = 1; id < power; ++id) sum += (double)id * out[id] * alpha[power - id];
+        out[power] = (alpha[power] - sum / (double)power) / alpha[0];
+    }
+    return true;
+}
+
+static void series_sin_cos(const double* alpha, size_t count, double* sine, double* cosine) {
+    sine[0] = sin(alpha[0]);
+    cosine[0] = cos(alpha[0]);
+    for (size_t power = 1; power < count; ++power) {
+        double sin_sum = 0.0, cos_sum = 0.0;
+        for (size_t id = 1; id <= power; ++id) {
+            sin_sum += (double)id * alpha[id] * cosine[power - id];
+            cos_sum += (double)id * alpha[id] * sine[power - id];
+        }
+        sine[power] = sin_sum / (double)power;
+        cosine[power] = -cos_sum / (double)power;
+    }
+}
+
+static bool series_pow(const double* alpha, const double* beta, size_t count, double* out) {
+    bool const_exponent = true;
+    for (size_t id = 1; id < count; ++id) const_exponent = const_exponent && is_equal(beta[id], 0.0);
+
+    double exponent = beta[0];
+
+    if (const_exponent && !is_equal(alpha[0], 0.0)) {
+        //* Recurrence for a^r, follows from a * (a^r)' = r * a' * a^r.
+        out[0] = pow(alpha[0], exponent);
+        for (size_t power = 1; power < count; ++power) {
+            double sum = 0.0;
+            for (size_t id = 1; id <= power; ++id)
+                sum += ((exponent + 1.0) * (double)id - (double)power) * alpha[id] * out[power - id];
+            out[power] = sum / ((double)power * alpha[0]);
+        }
+        return true;
+    }
+
+    if (const_exponent && exponent >= 0 && is_equal(exponent, round(exponent))) {
+        //* Series of the base starts with zero, so the power is calculated by plain multiplication.
+        //  Every factor shifts the series by at least one power, so big exponents leave nothing of it.
+        if (exponent >= (double)count) {
+            memset(out, 0, count * sizeof(*out));
+            return true;
+        }
+
+        double* temp = (double*) calloc(count, sizeof(*temp));
+        if (!temp) return false;
+
+        memset(out, 0, count * sizeof(*out));
+        out[0] = 1.0;
+        for (long long step = llround(exponent); step > 0; --step) {
+            series_mul(out, alpha, count, temp);
+            memcpy(out, temp, count * sizeof(*out));
+        }
+
+        free(temp);
+        return true;
+    }
+
+    //* a^b = exp(b * ln(a))
+    double* temp = (double*) calloc(2 * count, sizeof(*temp));
+    if (!temp) return false;
+
+    bool success = series_ln(alpha, count, temp);
+    if (success) {
+        series_mul(temp, beta, count, temp + count);
+        series_exp(temp + count, count, out);
+    }
+
+    free(temp);
+    return success;
+}
@@ -0,0 +1,48 @@
+/**
+ * @file taylor.h
+ * @author Kudryashov Ilya (kudriashov.it@phystech.edu)
+ * @brief Truncated power series arithmetic.
+ * @version 0.1
+ * @date 2022-12-08
+ * 
+ * @copyright Copyright (c) 2022
+ * 
+ */
+
+#ifndef TAYLOR_H
+#define TAYLOR_H
+
+#include <stdlib.h>
+#include <errno.h>
+
+#include "bin_tree.h"
+
+/**
+ * @brief Calculate Taylor series coefficients of the expression at the point X = point.
+ * Series of every subexpression is propagated up the tree, so no symbolic derivatives are built
+ * and the whole expansion takes O(order^2) operations per node.
+ * 
+ * @param equation
+ * @param point point to build the series at
+ * @param order maximum power of (X - point) to calculate the coefficient of
+ * @param coefs where to write the coefficients (order + 1 values), coefs[k] = f^(k)(point) / k!
+ * @param err_code variable to use as errno
+ * @return false if the expression has no series at the point (coefficients are not valid then)
+ */
+bool Equation_taylor(const Equation* equation, const double point, const size_t order, double* coefs,
+                     int* const err_code = &errno);
+
+/**
+ * @brief Get values of the expression and its derivatives at the point X = x_value.
+ * 
+ * @param equation
+ * @param x_value value of the X parameter
+ * @param order maximum derivative power
+ * @param derivatives where to write the derivatives (order + 1 values), derivatives[k] = f^(k)(x_value)
+ * @param err_code variable to use as errno
+ * @return false if the expression is not differentiable at the point (derivatives are not valid then)
+ */
+bool Equation_calculate_derivatives(const Equation* equation, const double x_value, const size_t order,
+                                    double* derivatives, int* const err_code = &errno);
+
+#endif
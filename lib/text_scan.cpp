@@ -0,0 +1,179 @@
+#include "text_scan.h"
+
+#include <stdint.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define TEXT_SCAN_BLOCK 32
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define TEXT_SCAN_BLOCK 16
+#endif
+
+//* Largest decimal exponent for which the power of ten is exact in a double.
+static const int MAX_EXACT_EXPONENT = 22;
+
+static const double EXACT_POWERS_OF_TEN[MAX_EXACT_EXPONENT + 1] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
+
+//* Integers up to this one are all exact in a double.
+static const uint64_t MAX_EXACT_MANTISSA = (uint64_t)1 << 53;
+
+//* Exponents are not accumulated beyond this, any number with such exponent goes to strtod anyway.
+static const int MAX_SCANNED_EXPONENT = 100000;
+
+static inline bool is_digit_char(char letter) {
+    return letter >= '0' && letter <= '9';
+}
+
+#ifdef TEXT_SCAN_BLOCK
+
+//* Blocks are aligned, so a load never crosses a page border and can not fault,
+//  but it does read outside of the buffer as far as the address sanitizer is concerned.
+#define BLOCK_SCANNER __attribute__((no_sanitize_address))
+
+static const uint32_t FULL_BLOCK_MASK = (uint32_t)(((uint64_t)1 << TEXT_SCAN_BLOCK) - 1);
+
+#if TEXT_SCAN_BLOCK == 32
+
+BLOCK_SCANNER static inline uint32_t blank_mask(const char* block) {
+    __m256i bytes = _mm256_load_si256((const __m256i*)block);
+    __m256i blanks = _mm256_or_si256(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(' ')),
+                                     _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\t')));
+    return (uint32_t)_mm256_movemask_epi8(blanks);
+}
+
+BLOCK_SCANNER static inline uint32_t digit_mask(const char* block) {
+    __m256i shifted = _mm256_sub_epi8(_mm256_load_si256((const __m256i*)block), _mm256_set1_epi8('0'));
+    __m256i digits = _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, _mm256_set1_epi8(9)), shifted);
+    return (uint32_t)_mm256_movemask_epi8(digits);
+}
+
+#else
+
+BLOCK_SCANNER static inline uint32_t blank_mask(const char* block) {
+    __m128i bytes = _mm_load_si128((const __m128i*)block);
+    __m128i blanks = _mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(' ')),
+                                  _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\t')));
+    return (uint32_t)_mm_movemask_epi8(blanks);
+}
+
+BLOCK_SCANNER static inline uint32_t digit_mask(const char* block) {
+    __m128i shifted = _mm_sub_epi8(_mm_load_si128((const __m128i*)block), _mm_set1_epi8('0'));
+    __m128i digits = _mm_cmpeq_epi8(_mm_min_epu8(shifted, _mm_set1_epi8(9)), shifted);
+    return (uint32_t)_mm_movemask_epi8(digits);
+}
+
+#endif
+
+/**
+ * @brief Find the first character after the text start that is not of the class.
+ * 
+ * @param text
+ * @param class_mask function giving the mask of block bytes belonging to the class
+ * @return first character not of the class
+ */
+BLOCK_SCANNER static inline const char* skip_class(const char* text, uint32_t (*class_mask)(const char*)) {
+    unsigned int offset = (unsigned int)((uintptr_t)text % TEXT_SCAN_BLOCK);
+    const char* block = text - offset;
+
+    //* Bytes before the text are dropped from the first block.
+    uint32_t others = (~class_mask(block) & FULL_BLOCK_MASK) >> offset << offset;
+
+    while (others == 0) {
+        block += TEXT_SCAN_BLOCK;
+        others = ~class_mask(block) & FULL_BLOCK_MASK;
+    }
+
+    return block + __builtin_ctz(others);
+}
+
+const char* skip_blanks(const char* text) {
+    return skip_class(text, blank_mask);
+}
+
+const char* skip_digits(const char* text) {
+    return skip_class(text, digit_mask);
+}
+
+#else
+
+static inline bool is_blank_char(char letter) {
+    return letter == ' ' || letter == '\t';
+}
+
+const char* skip_blanks(const char* text) {
+    while (is_blank_char(*text)) ++text;
+    return text;
+}
+
+const char* skip_digits(const char* text) {
+    while (is_digit_char(*text)) ++text;
+    return text;
+}
+
+#endif
+
+/**
+ * @brief Append digits to the mantissa.
+ * 
+ * @param mantissa
+ * @param begin first digit
+ * @param end end of digits
+ * @return false if the mantissa became too big to be stored exactly
+ */
+static bool append_digits(uint64_t* mantissa, const char* begin, const char* end) {
+    for (const char* digit = begin; digit < end; ++digit) {
+        if (*mantissa > (UINT64_MAX - 9) / 10) return false;
+        *mantissa = *mantissa * 10 + (uint64_t)(*digit - '0');
+    }
+
+    return true;
+}
+
+double scan_number(const char* text, const char** end) {
+    //* Hexadecimal numbers are left to strtod.
+    if (text[0] == '0' && (text[1] == 'x' || text[1] == 'X')) return strtod(text, (char**)end);
+
+    uint64_t mantissa = 0;
+    int exponent = 0;
+
+    const char* iter = skip_digits(text);
+    bool is_exact = append_digits(&mantissa, text, iter);
+
+    if (*iter == '.') {
+        const char* fraction_end = skip_digits(iter + 1);
+        is_exact = is_exact && append_digits(&mantissa, iter + 1, fraction_end);
+        exponent -= (int)(fraction_end - iter - 1);
+        iter = fraction_end;
+    }
+
+    if (*iter == 'e' || *iter == 'E') {
+        const char* exp_iter = iter + 1;
+        bool is_negative = *exp_iter == '-';
+        if (*exp_iter == '-' || *exp_iter == '+') ++exp_iter;
+
+        //* Exponent without digits is not a part of the number.
+        if (is_digit_char(*exp_iter)) {
+            int exp_value = 0;
+            for (; is_digit_char(*exp_iter); ++exp_iter) {
+                if (exp_value < MAX_SCANNED_EXPONENT) exp_value = exp_value * 10 + (*exp_iter - '0');
+            }
+
+            exponent += is_negative ? -exp_value : exp_value;
+            iter = exp_iter;
+        }
+    }
+
+    if (!is_exact || mantissa > MAX_EXACT_MANTISSA ||
+        exponent < -MAX_EXACT_EXPONENT || exponent > MAX_EXACT_EXPONENT) {
+        return strtod(text, (char**)end);
+    }
+
+    *end = iter;
+
+    double value = (double)mantissa;
+    return exponent < 0 ? value / EXACT_POWERS_OF_TEN[-exponent] : value * EXACT_POWERS_OF_TEN[exponent];
+}
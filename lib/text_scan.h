@@ -0,0 +1,47 @@
+/**
+ * @file text_scan.h
+ * @author Kudryashov Ilya (kudriashov.it@phystech.edu)
+ * @brief Fast scanning of equation text.
+ * @version 0.1
+ * @date 2022-12-18
+ * 
+ * @copyright Copyright (c) 2022
+ * 
+ */
+
+#ifndef TEXT_SCAN_H
+#define TEXT_SCAN_H
+
+#include <stdlib.h>
+
+/**
+ * @brief Skip spaces and tabs, several bytes at a time if the processor allows it.
+ * Text is read by aligned blocks, so it has to be terminated by a non-blank character
+ * (bytes after the terminator up to the end of the block are read, but never used).
+ * 
+ * @param text
+ * @return first character that is not a space or a tab
+ */
+const char* skip_blanks(const char* text);
+
+/**
+ * @brief Skip decimal digits, several bytes at a time if the processor allows it.
+ * Same restrictions as for skip_blanks apply.
+ * 
+ * @param text
+ * @return first character that is not a digit
+ */
+const char* skip_digits(const char* text);
+
+/**
+ * @brief Read the number the same way strtod does, but without strtod for numbers that fit into a double exactly.
+ * Numbers with at most 19 significant digits and a decimal exponent of at most 22 are computed by a single
+ * multiplication or division of exact values, which gives the correctly rounded result (Clinger's fast path).
+ * 
+ * @param text text starting with a digit
+ * @param end where to put the pointer to the first character after the number
+ * @return value of the number
+ */
+double scan_number(const char* text, const char** end);
+
+#endif
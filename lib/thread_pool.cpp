@@ -0,0 +1,306 @@
+#include "thread_pool.h"
+
+#include <cstring>
+#include <unistd.h>
+
+#include "util/dbg/debug.h"
+
+//* Pool and index of the worker running in the current thread.
+static thread_local ThreadPool* CurrentPool = NULL;
+static thread_local size_t CurrentWorker = 0;
+
+/**
+ * @brief Main function of worker threads.
+ * 
+ * @param argument PoolWorker of the thread
+ * @return NULL
+ */
+static void* worker_main(void* argument);
+
+/**
+ * @brief Take a task from the queue of the worker, or steal it from other workers.
+ * 
+ * @param pool
+ * @param worker index of the worker to take tasks of first (any value if the caller is not a worker)
+ * @param task where to put the task
+ * @return false if all queues are empty
+ */
+static bool take_task(ThreadPool* pool, size_t worker, PoolTask* task);
+
+/**
+ * @brief Execute the task and mark it finished.
+ * 
+ * @param pool
+ * @param task
+ */
+static void run_task(ThreadPool* pool, PoolTask task);
+
+/**
+ * @brief Release queues of the workers.
+ * 
+ * @param workers
+ * @param count number of workers
+ */
+static void release_queues(PoolWorker* workers, size_t count);
+
+/**
+ * @brief Put the task to the back of the queue.
+ * 
+ * @param queue
+ * @param task
+ * @param err_code variable to use as errno
+ * @return false if the queue could not grow
+ */
+static bool queue_push(PoolQueue* queue, PoolTask task, int* const err_code);
+
+/**
+ * @brief Take the task from the queue.
+ * 
+ * @param queue
+ * @param from_back take the newest task instead of the oldest one
+ * @param task where to put the task
+ * @return false if the queue is empty
+ */
+static bool queue_pop(PoolQueue* queue, bool from_back, PoolTask* task);
+
+void ThreadPool_ctor(ThreadPool* pool, size_t thread_count, int* const err_code) {
+    _LOG_FAIL_CHECK_(pool, "error", ERROR_REPORTS, return, err_code, EFAULT);
+
+    if (!thread_count) {
+        long processors = sysconf(_SC_NPROCESSORS_ONLN);
+        thread_count = processors > 0 ? (size_t)processors : 1;
+    }
+    if (thread_count > POOL_MAX_THREADS) thread_count = POOL_MAX_THREADS;
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+    pthread_cond_init(&pool->idle, NULL);
+
+    pool->queued = 0;
+    pool->pending = 0;
+    pool->next_queue = 0;
+    pool->stopping = false;
+    pool->thread_count = 0;
+
+    pool->workers = (PoolWorker*) calloc(thread_count, sizeof(*pool->workers));
+    _LOG_FAIL_CHECK_(pool->workers, "error", ERROR_REPORTS, return, err_code, ENOMEM);
+
+    bool allocated = true;
+    for (size_t index = 0; index < thread_count; ++index) {
+        PoolWorker* worker = &pool->workers[index];
+
+        worker->pool = pool;
+        worker->index = index;
+        worker->queue.capacity = POOL_QUEUE_DEFAULT_CAPACITY;
+        worker->queue.tasks = (PoolTask*) calloc(worker->queue.capacity, sizeof(*worker->queue.tasks));
+        pthread_mutex_init(&worker->queue.lock, NULL);
+
+        allocated = allocated && worker->queue.tasks;
+    }
+
+    _LOG_FAIL_CHECK_(allocated, "error", ERROR_REPORTS, {
+        release_queues(pool->workers, thread_count);
+        free(pool->workers);
+        pool->workers = NULL;
+        return;
+    }, err_code, ENOMEM);
+
+    //* Workers only steal from queues of already started workers, so the count grows with every thread.
+    for (size_t index = 0; index < thread_count; ++index) {
+        PoolWorker* worker = &pool->workers[index];
+
+        if (pthread_create(&worker->thread, NULL, worker_main, worker)) {
+            log_printf(ERROR_REPORTS, "error", "Failed to start worker %lu of %lu.\n", index, thread_count);
+            if (err_code) *err_code = EAGAIN;
+
+            release_queues(worker, thread_count - index);
+            break;
+        }
+
+        pthread_mutex_lock(&pool->lock);
+        ++pool->thread_count;
+        pthread_mutex_unlock(&pool->lock);
+    }
+
+    log_printf(STATUS_REPORTS, "status", "Started thread pool of %lu workers.\n", pool->thread_count);
+}
+
+void ThreadPool_dtor(ThreadPool* pool) {
+    if (!pool || !pool->workers) return;
+
+    ThreadPool_wait(pool);
+
+    pthread_mutex_lock(&pool->lock);
+    pool->stopping = true;
+    pthread_cond_broadcast(&pool->wake);
+    size_t thread_count = pool->thread_count;
+    pthread_mutex_unlock(&pool->lock);
+
+    for (size_t index = 0; index < thread_count; ++index) {
+        pthread_join(pool->workers[index].thread, NULL);
+    }
+
+    release_queues(pool->workers, thread_count);
+
+    free(pool->workers);
+    pool->workers = NULL;
+    pool->thread_count = 0;
+
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->wake);
+    pthread_cond_destroy(&pool->idle);
+}
+
+void ThreadPool_submit(ThreadPool* pool, pool_function_t* function, void* argument, int* const err_code) {
+    _LOG_FAIL_CHECK_(pool && pool->thread_count, "error", ERROR_REPORTS, return, err_code, EINVAL);
+    _LOG_FAIL_CHECK_(function, "error", ERROR_REPORTS, return, err_code, EFAULT);
+
+    //* Counters are updated before the task becomes visible, so it can not be finished before being counted.
+    pthread_mutex_lock(&pool->lock);
+    size_t target = CurrentPool == pool ? CurrentWorker : pool->next_queue++ % pool->thread_count;
+    ++pool->queued;
+    ++pool->pending;
+    pthread_mutex_unlock(&pool->lock);
+
+    if (!queue_push(&pool->workers[target].queue, { .function = function, .argument = argument }, err_code)) {
+        pthread_mutex_lock(&pool->lock);
+        --pool->queued;
+        if (--pool->pending == 0) pthread_cond_broadcast(&pool->idle);
+        pthread_mutex_unlock(&pool->lock);
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pthread_cond_signal(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void ThreadPool_wait(ThreadPool* pool) {
+    if (!pool || !pool->workers) return;
+
+    while (true) {
+        PoolTask task = {};
+        if (take_task(pool, CurrentPool == pool ? CurrentWorker : 0, &task)) {
+            run_task(pool, task);
+            continue;
+        }
+
+        pthread_mutex_lock(&pool->lock);
+        bool finished = pool->pending == 0;
+        if (!finished && pool->queued == 0) pthread_cond_wait(&pool->idle, &pool->lock);
+        pthread_mutex_unlock(&pool->lock);
+
+        if (finished) break;
+    }
+}
+
+size_t ThreadPool_current_worker(const ThreadPool* pool) {
+    if (!pool) return 0;
+    return CurrentPool == pool ? CurrentWorker : pool->thread_count;
+}
+
+static void* worker_main(void* argument) {
+    PoolWorker* worker = (PoolWorker*)argument;
+    ThreadPool* pool = worker->pool;
+
+    CurrentPool = pool;
+    CurrentWorker = worker->index;
+
+    while (true) {
+        PoolTask task = {};
+        if (take_task(pool, worker->index, &task)) {
+            run_task(pool, task);
+            continue;
+        }
+
+        pthread_mutex_lock(&pool->lock);
+        while (!pool->stopping && pool->queued == 0) pthread_cond_wait(&pool->wake, &pool->lock);
+        bool stop = pool->stopping && pool->queued == 0;
+        pthread_mutex_unlock(&pool->lock);
+
+        if (stop) break;
+    }
+
+    return NULL;
+}
+
+static bool take_task(ThreadPool* pool, size_t worker, PoolTask* task) {
+    pthread_mutex_lock(&pool->lock);
+    size_t thread_count = pool->thread_count;
+    pthread_mutex_unlock(&pool->lock);
+
+    if (!thread_count) return false;
+    worker %= thread_count;
+
+    //* Own tasks are taken newest-first to keep their data in cache, stolen ones - oldest-first, as they are the biggest.
+    bool found = queue_pop(&pool->workers[worker].queue, true, task);
+    for (size_t shift = 1; !found && shift < thread_count; ++shift) {
+        found = queue_pop(&pool->workers[(worker + shift) % thread_count].queue, false, task);
+    }
+
+    if (found) {
+        pthread_mutex_lock(&pool->lock);
+        --pool->queued;
+        pthread_mutex_unlock(&pool->lock);
+    }
+
+    return found;
+}
+
+static void run_task(ThreadPool* pool, PoolTask task) {
+    task.function(task.argument);
+
+    pthread_mutex_lock(&pool->lock);
+    if (--pool->pending == 0) pthread_cond_broadcast(&pool->idle);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+static void release_queues(PoolWorker* workers, size_t count) {
+    for (size_t index = 0; index < count; ++index) {
+        free(workers[index].queue.tasks);
+        workers[index].queue.tasks = NULL;
+        pthread_mutex_destroy(&workers[index].queue.lock);
+    }
+}
+
+static bool queue_push(PoolQueue* queue, PoolTask task, int* const err_code) {
+    pthread_mutex_lock(&queue->lock);
+
+    if (queue->size == queue->capacity) {
+        PoolTask* tasks = (PoolTask*) calloc(queue->capacity * 2, sizeof(*tasks));
+        _LOG_FAIL_CHECK_(tasks, "error", ERROR_REPORTS, {
+            pthread_mutex_unlock(&queue->lock);
+            return false;
+        }, err_code, ENOMEM);
+
+        for (size_t id = 0; id < queue->size; ++id) {
+            tasks[id] = queue->tasks[(queue->front + id) % queue->capacity];
+        }
+
+        free(queue->tasks);
+        queue->tasks = tasks;
+        queue->front = 0;
+        queue->capacity *= 2;
+    }
+
+    queue->tasks[(queue->front + queue->size++) % queue->capacity] = task;
+
+    pthread_mutex_unlock(&queue->lock);
+    return true;
+}
+
+static bool queue_pop(PoolQueue* queue, bool from_back, PoolTask* task) {
+    pthread_mutex_lock(&queue->lock);
+
+    bool found = queue->size > 0;
+    if (found && from_back) {
+        *task = queue->tasks[(queue->front + --queue->size) % queue->capacity];
+    } else if (found) {
+        *task = queue->tasks[queue->front];
+        queue->front = (queue->front + 1) % queue->capacity;
+        --queue->size;
+    }
+
+    pthread_mutex_unlock(&queue->lock);
+    return found;
+}
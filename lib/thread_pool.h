@@ -0,0 +1,117 @@
+/**
+ * @file thread_pool.h
+ * @author Kudryashov Ilya (kudriashov.it@phystech.edu)
+ * @brief Work-stealing pool of worker threads.
+ * @version 0.1
+ * @date 2022-12-14
+ * 
+ * @copyright Copyright (c) 2022
+ * 
+ */
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <stdlib.h>
+#include <errno.h>
+#include <pthread.h>
+
+//* Maximum number of worker threads.
+static const size_t POOL_MAX_THREADS = 256;
+
+static const size_t POOL_QUEUE_DEFAULT_CAPACITY = 64;
+
+//* Function executed by the pool.
+typedef void pool_function_t(void* argument);
+
+struct PoolTask {
+    pool_function_t* function = NULL;
+    void* argument = NULL;
+};
+
+/**
+ * @brief Double-ended queue of tasks of one worker.
+ * The owner takes the newest tasks from the back, other workers steal the oldest ones from the front.
+ */
+struct PoolQueue {
+    PoolTask* tasks = NULL;     //* Ring buffer of tasks.
+    size_t front = 0;
+    size_t size = 0;
+    size_t capacity = 0;
+
+    pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+};
+
+struct ThreadPool;
+
+struct PoolWorker {
+    pthread_t thread = {};
+    PoolQueue queue = {};
+
+    ThreadPool* pool = NULL;
+    size_t index = 0;
+};
+
+/**
+ * @brief Set of worker threads executing tasks.
+ * Every worker has its own queue, tasks submitted by a task go to the queue of its worker.
+ * Idle workers steal tasks from queues of others.
+ */
+struct ThreadPool {
+    PoolWorker* workers = NULL;
+    size_t thread_count = 0;
+
+    pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+    pthread_cond_t wake = PTHREAD_COND_INITIALIZER;     //* Signalled when tasks are submitted.
+    pthread_cond_t idle = PTHREAD_COND_INITIALIZER;     //* Signalled when all tasks are finished.
+
+    size_t queued = 0;      //* Tasks waiting in queues.
+    size_t pending = 0;     //* Tasks submitted and not finished yet.
+    size_t next_queue = 0;  //* Queue for the next task submitted from outside the pool.
+    bool stopping = false;
+};
+
+/**
+ * @brief Start worker threads.
+ * 
+ * @param pool
+ * @param thread_count number of workers (0 = number of processors)
+ * @param err_code variable to use as errno
+ */
+void ThreadPool_ctor(ThreadPool* pool, size_t thread_count = 0, int* const err_code = &errno);
+
+/**
+ * @brief Finish all submitted tasks and stop the workers.
+ * 
+ * @param pool
+ */
+void ThreadPool_dtor(ThreadPool* pool);
+
+/**
+ * @brief Schedule the function for execution.
+ * 
+ * @param pool
+ * @param function
+ * @param argument argument to pass to the function
+ * @param err_code variable to use as errno
+ */
+void ThreadPool_submit(ThreadPool* pool, pool_function_t* function, void* argument, int* const err_code = &errno);
+
+/**
+ * @brief Wait until all submitted tasks are finished, executing them in the calling thread meanwhile.
+ * Should not be called from tasks of the pool.
+ * 
+ * @param pool
+ */
+void ThreadPool_wait(ThreadPool* pool);
+
+/**
+ * @brief Get index of the worker the calling thread belongs to.
+ * Lets tasks use per-worker data without locking.
+ * 
+ * @param pool
+ * @return worker index, thread count of the pool for threads outside of it
+ */
+size_t ThreadPool_current_worker(const ThreadPool* pool);
+
+#endif
@@ -0,0 +1,76 @@
+#include "traversal.h"
+
+#include <cstring>
+
+#include "util/dbg/debug.h"
+#include "node_map.h"
+
+bool TraversalStack_push(TraversalStack* stack, TraversalFrame frame, int* const err_code) {
+    if (stack->size == stack->capacity) {
+        TraversalFrame* frames = (TraversalFrame*) calloc(stack->capacity * 2, sizeof(*frames));
+        _LOG_FAIL_CHECK_(frames, "error", ERROR_REPORTS, return false, err_code, ENOMEM);
+
+        memcpy(frames, stack->frames, stack->size * sizeof(*frames));
+        if (stack->frames != stack->local) free(stack->frames);
+
+        stack->frames = frames;
+        stack->capacity *= 2;
+    }
+
+    stack->frames[stack->size++] = frame;
+    return true;
+}
+
+void TraversalStack_dtor(TraversalStack* stack) {
+    while (stack->size) Equation_dtor(&stack->frames[--stack->size].result);
+
+    if (stack->frames != stack->local) free(stack->frames);
+    stack->frames = stack->local;
+    stack->capacity = TRAVERSAL_LOCAL_CAPACITY;
+}
+
+TraversalFrame fold_equation(const Equation* equation, bool skip_placeholders, fold_step_t* step,
+                             const void* context, NodeMap* known, int* const err_code) {
+    TraversalStack stack = {};
+    TraversalStack results = {};
+
+    bool fine = TraversalStack_push(&stack, { .node = equation }, err_code);
+    while (fine && stack.size) {
+        TraversalFrame frame = TraversalStack_pop(&stack);
+        const Equation* node = frame.node;
+
+        bool visit_left = node->left && !(skip_placeholders && has_placeholder(node));
+
+        NodeInfo* info = known && frame.stage == STAGE_ENTER ? NodeMap_find(known, node) : NULL;
+        if (info) {
+            //* Shared nodes get copies of the image after the first use.
+            Equation* image = info->uses++ ? Equation_copy(info->image) : info->image;
+            fine = TraversalStack_push(&results, { .node = node, .result = image }, err_code);
+            continue;
+        }
+
+        if (frame.stage == STAGE_ENTER && (node->left || node->right)) {
+            fine = TraversalStack_push(&stack, { .node = node, .stage = STAGE_EXIT }, err_code) &&
+                   (!node->right || TraversalStack_push(&stack, { .node = node->right }, err_code)) &&
+                   (!visit_left  || TraversalStack_push(&stack, { .node = node->left  }, err_code));
+            continue;
+        }
+
+        //* Results of the branches are on top of the result stack, the right one is the last.
+        TraversalFrame right = node->right ? TraversalStack_pop(&results) : TraversalFrame {};
+        TraversalFrame left  = visit_left  ? TraversalStack_pop(&results) : TraversalFrame {};
+
+        TraversalFrame result = { .node = node };
+        step(node, visit_left ? &left : NULL, node->right ? &right : NULL, &result, context, err_code);
+
+        fine = TraversalStack_push(&results, result, err_code);
+        if (!fine) Equation_dtor(&result.result);
+    }
+
+    TraversalFrame root = fine ? TraversalStack_pop(&results) : TraversalFrame {};
+
+    TraversalStack_dtor(&stack);
+    TraversalStack_dtor(&results);
+
+    return root;
+}
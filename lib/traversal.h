@@ -0,0 +1,116 @@
+/**
+ * @file traversal.h
+ * @author Kudryashov Ilya (kudriashov.it@phystech.edu)
+ * @brief Explicit stack traversals of equations.
+ * @version 0.1
+ * @date 2022-12-14
+ * 
+ * @copyright Copyright (c) 2022
+ * 
+ */
+
+#ifndef TRAVERSAL_H
+#define TRAVERSAL_H
+
+#include <stdlib.h>
+#include <errno.h>
+
+#include "bin_tree.h"
+
+struct NodeMap;
+
+//* Point of the traversal a node is visited at.
+enum TraversalStage {
+    STAGE_ENTER,    // <-- before the left branch
+    STAGE_INFIX,    // <-- between the branches
+    STAGE_EXIT,     // <-- after the right branch
+};
+
+struct TraversalFrame {
+    const Equation* node = NULL;
+    TraversalStage stage = STAGE_ENTER;
+
+    Equation* result = NULL;    //* Equation built for the node.
+    double value = 0.0;         //* Value calculated for the node.
+    double slope = 0.0;         //* Derivative of the value, for forward mode evaluation.
+    size_t index = 0;           //* Index attached to the node (slot, class, stack depth, flags).
+};
+
+//* Number of frames kept on the C stack before the traversal stack moves to the heap.
+static const size_t TRAVERSAL_LOCAL_CAPACITY = 32;
+
+/**
+ * @brief Explicit stack replacing recursion, so the depth of equations is limited by the heap only.
+ * Shallow traversals do not allocate, as first frames are stored in the structure itself.
+ */
+struct TraversalStack {
+    TraversalFrame local[TRAVERSAL_LOCAL_CAPACITY] = {};
+    TraversalFrame* frames = local;
+    size_t size = 0;
+    size_t capacity = TRAVERSAL_LOCAL_CAPACITY;
+};
+
+/**
+ * @brief Put the frame on top of the stack.
+ * 
+ * @param stack
+ * @param frame
+ * @param err_code variable to use as errno
+ * @return false if the stack could not grow
+ */
+bool TraversalStack_push(TraversalStack* stack, TraversalFrame frame, int* const err_code = &errno);
+
+/**
+ * @brief Take the frame from the top of the stack.
+ * 
+ * @param stack
+ * @return top frame
+ */
+static inline TraversalFrame TraversalStack_pop(TraversalStack* stack) { return stack->frames[--stack->size]; }
+
+/**
+ * @brief Release the stack, destroying equations left in its frames.
+ * 
+ * @param stack
+ */
+void TraversalStack_dtor(TraversalStack* stack);
+
+/**
+ * @brief Calculate result of the node from results of its branches.
+ * 
+ * @param node
+ * @param left result of the left branch (NULL if it was not visited)
+ * @param right result of the right branch (NULL if it was not visited)
+ * @param result where to write the result of the node
+ * @param context argument of the traversal
+ * @param err_code variable to use as errno
+ */
+typedef void fold_step_t(const Equation* node, const TraversalFrame* left, const TraversalFrame* right,
+                         TraversalFrame* result, const void* context, int* const err_code);
+
+/**
+ * @brief Walk the equation in post-order, passing results of branches to their parents.
+ * 
+ * @param equation
+ * @param skip_placeholders do not visit left branches of unary operations
+ * @param step function calculating result of a node
+ * @param context argument passed to the step function
+ * @param known (OPTIONAL) nodes with precalculated resulting equations (images), their subtrees are not visited
+ * @param err_code variable to use as errno
+ * @return result of the root
+ */
+TraversalFrame fold_equation(const Equation* equation, bool skip_placeholders, fold_step_t* step,
+                             const void* context, NodeMap* known, int* const err_code = &errno);
+
+/**
+ * @brief Check if the node is a unary operation, which has a placeholder as its left branch.
+ * 
+ * @param node
+ * @return true if the left branch of the node is a placeholder
+ */
+static inline bool has_placeholder(const Equation* node) {
+    return node->type == TYPE_OP &&
+          (node->value.op == OP_SIN || node->value.op == OP_COS || node->value.op == OP_LN);
+}
+
+#endif
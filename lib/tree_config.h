@@ -17,7 +17,14 @@
 static const size_t TREE_PICT_NAME_SIZE = 256;
 static const size_t TREE_DRAW_REQUEST_SIZE = 512;
 
-#define TREE_TEMP_DOT_FNAME "temp.dot"
+//* Bigger trees are not drawn, as dot can not lay them out in reasonable time.
+static const size_t TREE_DUMP_MAX_SIZE = 1024;
+
+//* Relative difference allowed between values of compiled and interpreted equations (see Equation_same_value()).
+static const double EQ_CALCULATE_TOLERANCE = 1e-9;
+
+//* Name template of the temporary graph file, dumps get their own files to be drawn from several threads.
+#define TREE_TEMP_DOT_FNAME "temp%04ld.dot"
 #define TREE_LOG_ASSET_FOLD_NAME "log_assets"
 #define TREE_DUMP_TAG "tree_dump"
 
@@ -39,7 +46,7 @@ enum Operator {
 };
 
 //* Operator text representation.
-static const char* OP_TEXT_REPS[] = {
+static constexpr const char* OP_TEXT_REPS[] = {
     "+",
     "-",
     "*",
@@ -65,4 +72,22 @@ static const int OP_PRIORITY[] = {
     2,  // <-- ln
 };
 
+enum Associativity {
+    ASSOC_NONE,     // <-- not an infix operator
+    ASSOC_LEFT,
+    ASSOC_RIGHT,
+};
+
+//* Operation associativity list, parser takes infix operators and their order from it and OP_PRIORITY.
+static const Associativity OP_ASSOCIATIVITY[] = {
+    ASSOC_LEFT,     // <-- +
+    ASSOC_LEFT,     // <-- -
+    ASSOC_LEFT,     // <-- *
+    ASSOC_LEFT,     // <-- /
+    ASSOC_NONE,     // <-- sin
+    ASSOC_NONE,     // <-- cos
+    ASSOC_RIGHT,    // <-- pow (^)
+    ASSOC_NONE,     // <-- ln
+};
+
 #endif
\ No newline at end of file
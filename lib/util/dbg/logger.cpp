@@ -8,6 +8,9 @@
 static FILE* logfile = NULL;
 static unsigned int log_threshold = 0;
 
+//* Size of the buffer asctime_r() requires.
+static const size_t LOG_TIMESTAMP_LENGTH = 26;
+
 /**
  * @brief Prints out log line prefix (time and tag).
  * 
@@ -41,11 +44,14 @@ void log_init(const char* filename, const unsigned int threshold, int* const err
 static void log_prefix(const char* tag, const unsigned int importance) {
     if (!log_file()) return;
     time_t raw_time;
-    struct tm * time_info;
+    struct tm time_info = {};
+
+    //* Reentrant versions, as the log can be written from several threads.
+    char pc_timestamp[LOG_TIMESTAMP_LENGTH] = "";
 
     time(&raw_time);
-    time_info = localtime (&raw_time);
-    char* pc_timestamp = asctime(time_info);
+    localtime_r(&raw_time, &time_info);
+    asctime_r(&time_info, pc_timestamp);
     pc_timestamp[strlen(pc_timestamp) - 1] = '\0';
 
     fprintf(log_file(importance), "%-20s [%s]:  ", pc_timestamp, tag);
@@ -56,14 +62,24 @@ void _log_printf(const unsigned int importance, const char* tag, const char* for
     va_start(args, format);
 
     if (importance >= log_threshold && logfile) {
+        flockfile(logfile);
         log_prefix(tag, importance);
         vfprintf(log_file(importance), format, args);
         fflush(log_file(importance));
+        funlockfile(logfile);
     }
 
     va_end(args);
 }
 
+void log_lock() {
+    if (logfile) flockfile(logfile);
+}
+
+void log_unlock() {
+    if (logfile) funlockfile(logfile);
+}
+
 static FILE* log_file(const unsigned int importance) {
     return importance >= log_threshold ? logfile : NULL;
 }
@@ -37,8 +37,10 @@ enum IMPORTANCES {
  * @param __VA_ARGS__ arguments as if they were in printf()
  */
 #define log_printf(importance, tag, ...) do {                                                            \
+    log_lock();                                                                                          \
     _log_printf(importance, tag, " ----- Called from %s:%d. -----\n", __FILE__, __LINE__);  \
     _log_printf(importance, tag, __VA_ARGS__);                                                           \
+    log_unlock();                                                                                        \
 } while(0)
 #else
 /**
@@ -90,6 +92,19 @@ void log_init(const char* filename = "log", const unsigned int threshold = 0, in
 void _log_printf(const unsigned int importance, const char* tag, const char* format, ...)
     __attribute__((format (printf, 3, 4)));
 
+/**
+ * @brief Start writing a message that should not be split by messages of other threads.
+ * Calls can be nested, every call should be paired with log_unlock().
+ * 
+ */
+void log_lock();
+
+/**
+ * @brief Let other threads write to the log.
+ * 
+ */
+void log_unlock();
+
 /**
  * @brief Close opened log file.
  * 
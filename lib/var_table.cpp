@@ -0,0 +1,166 @@
+#include "var_table.h"
+
+#include <math.h>
+#include <string.h>
+
+#include "util/util.h"
+#include "util/dbg/debug.h"
+
+#include "traversal.h"
+#include "node_map.h"
+
+/**
+ * @brief Calculate value of the node from values of its branches.
+ */
+static fold_step_t bound_step;
+
+void VarTable_ctor(VarTable* table, size_t capacity) {
+    _LOG_FAIL_CHECK_(table, "error", ERROR_REPORTS, return, &errno, EFAULT);
+
+    table->size = 0;
+    table->capacity = capacity ? capacity : 8;
+    table->vars = (VarBinding*) calloc(table->capacity, sizeof(*table->vars));
+    _LOG_FAIL_CHECK_(table->vars, "error", ERROR_REPORTS, table->capacity = 0, &errno, ENOMEM);
+
+    table->indices = NULL;
+    table->index_count = 0;
+}
+
+void VarTable_dtor(VarTable* table) {
+    if (!table) return;
+
+    free(table->vars);
+    table->vars = NULL;
+    table->size = 0;
+    table->capacity = 0;
+
+    free(table->indices);
+    table->indices = NULL;
+    table->index_count = 0;
+}
+
+size_t VarTable_set(VarTable* table, uintptr_t id, double value, int* const err_code) {
+    _LOG_FAIL_CHECK_(table, "error", ERROR_REPORTS, return 0, err_code, EFAULT);
+
+    size_t index = VarTable_find(table, id);
+    if (index < table->size) {
+        table->vars[index].value = value;
+        return index;
+    }
+
+    _LOG_FAIL_CHECK_(id < SYMBOL_MAX_COUNT, "error", ERROR_REPORTS, return table->size, err_code, EINVAL);
+
+    if (id >= table->index_count) {
+        size_t new_count = table->index_count ? table->index_count : SYMBOL_LETTER_COUNT;
+        while (new_count <= id) new_count *= 2;
+
+        size_t* new_indices = (size_t*) realloc(table->indices, new_count * sizeof(*table->indices));
+        _LOG_FAIL_CHECK_(new_indices, "error", ERROR_REPORTS, return table->size, err_code, ENOMEM);
+
+        memset(new_indices + table->index_count, 0, (new_count - table->index_count) * sizeof(*new_indices));
+
+        table->indices = new_indices;
+        table->index_count = new_count;
+    }
+
+    if (table->size >= table->capacity) {
+        size_t new_capacity = table->capacity ? table->capacity * 2 : 8;
+        VarBinding* new_vars = (VarBinding*) realloc(table->vars, new_capacity * sizeof(*table->vars));
+        _LOG_FAIL_CHECK_(new_vars, "error", ERROR_REPORTS, return table->size, err_code, ENOMEM);
+
+        table->vars = new_vars;
+        table->capacity = new_capacity;
+    }
+
+    table->vars[table->size] = { .id = id, .value = value };
+    table->indices[id] = table->size + 1;
+    return table->size++;
+}
+
+void VarTable_bind_all(VarTable* table, const Equation* equation, double value, int* const err_code) {
+    _LOG_FAIL_CHECK_(table, "error", ERROR_REPORTS, return, err_code, EFAULT);
+    if (!equation) return;
+
+    //* Shared subexpressions are visited once.
+    NodeMap visited = {};
+    NodeMap_ctor(&visited);
+
+    TraversalStack stack = {};
+
+    bool fine = TraversalStack_push(&stack, { .node = equation }, err_code);
+    while (fine && stack.size) {
+        const Equation* node = TraversalStack_pop(&stack).node;
+
+        if (node->type == TYPE_VAR && VarTable_find(table, node->value.id) == table->size) {
+            VarTable_set(table, node->value.id, value, err_code);
+        }
+
+        if (node->type != TYPE_OP) continue;
+
+        NodeInfo* info = NodeMap_get(&visited, node, err_code);
+        if (!info || info->uses++) continue;
+
+        fine = TraversalStack_push(&stack, { .node = node->right }, err_code) &&
+               (has_placeholder(node) || TraversalStack_push(&stack, { .node = node->left }, err_code));
+    }
+
+    TraversalStack_dtor(&stack);
+    NodeMap_dtor(&visited);
+}
+
+size_t VarTable_find(const VarTable* table, uintptr_t id) {
+    if (!table) return 0;
+
+    return id < table->index_count && table->indices[id] ? table->indices[id] - 1 : table->size;
+}
+
+double Equation_calculate_bound(const Equation* equation, const VarTable* vars, int* const err_code) {
+    if (!equation) return 0.0;
+
+    return fold_equation(equation, true, bound_step, vars, NULL, err_code).value;
+}
+
+static void bound_step(const Equation* equation, const TraversalFrame* left, const TraversalFrame* right,
+                       TraversalFrame* result, const void* context, int* const err_code) {
+    const VarTable* vars = (const VarTable*)context;
+
+    double alpha = left  ? left->value  : 0.0;
+    double beta  = right ? right->value : 0.0;
+
+    result->value = 0.0;
+
+    switch (equation->type) {
+
+    case TYPE_CONST: result->value = equation->value.dbl; break;
+    case TYPE_VAR: {
+        size_t index = VarTable_find(vars, equation->value.id);
+        result->value = vars && index < vars->size ? vars->vars[index].value : 0.0;
+        break;
+    }
+
+    case TYPE_OP: {
+        switch (equation->value.op) {
+
+        case OP_ADD: result->value = alpha + beta; break;
+        case OP_SUB: result->value = alpha - beta; break;
+        case OP_MUL: result->value = alpha * beta; break;
+        case OP_DIV:
+            _LOG_FAIL_CHECK_(!is_equal(beta, 0.0), "error", ERROR_REPORTS, /* result is infinite */, err_code, EINVAL);
+            result->value = is_equal(beta, 0.0) ? INFINITY : alpha / beta;
+            break;
+        case OP_COS: result->value = cos(beta); break;
+        case OP_SIN: result->value = sin(beta); break;
+        case OP_POW: result->value = pow(alpha, beta); break;
+        case OP_LN:  result->value = log(beta); break;
+        default:
+            if (err_code) *err_code = EINVAL;
+            log_printf(ERROR_REPORTS, "error",
+                "Somehow Operation equation->value.op had an incorrect value of %d.\n", equation->value.op);
+            break;
+        }
+
+        break;
+    }
+    default: break;
+    }
+}
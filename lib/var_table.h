@@ -0,0 +1,84 @@
+/**
+ * @file var_table.h
+ * @author Kudryashov Ilya (kudriashov.it@phystech.edu)
+ * @brief Variable values for multi-variable equations.
+ * @version 0.1
+ * @date 2022-12-09
+ * 
+ * @copyright Copyright (c) 2022
+ * 
+ */
+
+#ifndef VAR_TABLE_H
+#define VAR_TABLE_H
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+
+#include "bin_tree.h"
+
+struct VarBinding {
+    uintptr_t id = 0;
+    double value = 0.0;
+};
+
+/**
+ * @brief List of variables with values bound to them.
+ * Variables missing from the table are evaluated as zero.
+ * Symbol IDs are dense, so bindings are found through an array indexed by them.
+ */
+struct VarTable {
+    VarBinding* vars = NULL;
+    size_t size = 0;
+    size_t capacity = 0;
+
+    size_t* indices = NULL;     //* Index of the binding of every symbol + 1 (0 = not bound).
+    size_t index_count = 0;
+};
+
+void VarTable_ctor(VarTable* table, size_t capacity = 0);
+void VarTable_dtor(VarTable* table);
+
+/**
+ * @brief Bind the value to the variable (or change bound value).
+ * 
+ * @param table
+ * @param id symbol of the variable
+ * @param value value to bind
+ * @param err_code variable to use as errno
+ * @return index of the variable in the table
+ */
+size_t VarTable_set(VarTable* table, uintptr_t id, double value, int* const err_code = &errno);
+
+/**
+ * @brief Bind the value to every variable of the equation that is not in the table yet.
+ * Variables are added in the order of their first appearance.
+ * 
+ * @param table
+ * @param equation (can be a shared DAG)
+ * @param value value to bind
+ * @param err_code variable to use as errno
+ */
+void VarTable_bind_all(VarTable* table, const Equation* equation, double value, int* const err_code = &errno);
+
+/**
+ * @brief Find index of the variable in the table.
+ * 
+ * @param table
+ * @param id symbol of the variable
+ * @return index of the variable (table->size if the variable is not bound)
+ */
+size_t VarTable_find(const VarTable* table, uintptr_t id);
+
+/**
+ * @brief Get expression value with variables taken from the table.
+ * 
+ * @param equation
+ * @param vars values of the variables
+ * @param err_code variable to use as errno
+ * @return value of the expression
+ */
+double Equation_calculate_bound(const Equation* equation, const VarTable* vars, int* const err_code = &errno);
+
+#endif
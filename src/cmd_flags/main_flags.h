@@ -29,3 +29,29 @@
 { {'P', ""}, { GET_WRAPPER(series_point), 1, edit_double },
     "set point at which to build the series.\n"
     "\tDoes not check if double was specified." },
+
+{ {'G', ""}, { GET_WRAPPER(optimize_mode), 1, edit_int },
+    "optimize derivatives with equality saturation.\n"
+    "\t0 - do not optimize (default), 1 - minimize size, 2 - minimize evaluation time." },
+
+{ {'N', ""}, { GET_WRAPPER(native_mode), 1, edit_int },
+    "draw graphs of articles with equations compiled by the system compiler.\n"
+    "\t0 - calculate them in the program (default), 1 - compile them, libraries are cached in native_cache/." },
+
+{ {'J', ""}, { GET_WRAPPER(thread_count), 1, edit_int },
+    "differentiate big equations with the specified number of threads.\n"
+    "\t0 - differentiate in the main thread only (default)." },
+
+{ {'B', ""}, { GET_WRAPPER(batch_mode), 1, edit_int },
+    "process every line of the input file (or of every .math file of the input folder) as an equation.\n"
+    "\t0 - single equation (default), 1 - JSONL file of derivatives, 2 - article per equation.\n"
+    "\tSecond file name argument sets the output file or folder.\n"
+    "\tWith -J equations are processed in parallel instead." },
+
+{ {'U', ""}, { GET_WRAPPER(server_socket), 1, edit_string },
+    "serve equations on the local socket with the specified name until interrupted.\n"
+    "\tRequests are lines of -D, -S, -P and -G options followed by the equation,\n"
+    "\tflags of the server are used as defaults, -J sets number of clients served at once." },
+
+{ {'C', ""}, { GET_WRAPPER(client_socket), 1, edit_string },
+    "send every line of the input file to the server on the specified socket and print the answers." },
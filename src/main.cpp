@@ -24,7 +24,10 @@
 
 #include "lib/bin_tree.h"
 #include "lib/grammar.h"
+#include "lib/thread_pool.h"
 #include "utils/artigen.h"
+#include "utils/batch.h"
+#include "utils/server.h"
 
 #include "utils/main_utils.h"
 
@@ -45,6 +48,18 @@ int main(const int argc, const char** argv) {
     MAKE_WRAPPER(series_power);
     double series_point = 0.0;
     MAKE_WRAPPER(series_point);
+    int optimize_mode = 0;
+    MAKE_WRAPPER(optimize_mode);
+    int native_mode = 0;
+    MAKE_WRAPPER(native_mode);
+    int thread_count = 0;
+    MAKE_WRAPPER(thread_count);
+    int batch_mode = BATCH_NONE;
+    MAKE_WRAPPER(batch_mode);
+    char server_socket[MAX_NAME_LENGTH] = "";
+    MAKE_WRAPPER(server_socket);
+    char client_socket[MAX_NAME_LENGTH] = "";
+    MAKE_WRAPPER(client_socket);
 
     ActionTag line_tags[] = {
         #include "cmd_flags/main_flags.h"
@@ -57,26 +72,72 @@ int main(const int argc, const char** argv) {
 
     const char* f_name = get_input_file_name(argc, argv, DEFAULT_DB_NAME);
 
+    ServerRequest request_options = {};
+    request_options.dif_power = (unsigned int)clamp(differentiation_power, 0, (int)SERVER_MAX_POWER);
+    request_options.series_power = (unsigned int)clamp(series_power, 0, (int)SERVER_MAX_POWER);
+    request_options.series_point = series_point;
+    request_options.optimize_mode = clamp(optimize_mode, 0, 2);
+
+    if (*server_socket) {
+        run_server(server_socket, (size_t)max(0, thread_count), &request_options);
+        return_clean(errno == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
+    if (*client_socket) {
+        size_t failures = run_client(client_socket, f_name, &request_options, stdout);
+        return_clean(errno == 0 && failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
+    ArticleInfo info = {};
+    info.optimize = optimize_mode > 0;
+    info.optimize_cost = optimize_mode > 1 ? OPT_COST_EVAL : OPT_COST_SIZE;
+    info.native = native_mode > 0;
+
+    ThreadPool pool = {};
+    track_allocation(pool, ThreadPool_dtor);
+
+    if (thread_count > 0) {
+        ThreadPool_ctor(&pool, (size_t)thread_count);
+        info.pool = &pool;
+    }
+
+    if (batch_mode != BATCH_NONE) {
+        BatchSettings settings = {};
+        settings.format = batch_mode == BATCH_ARTICLES ? BATCH_ARTICLES : BATCH_JSONL;
+        settings.dif_power = (unsigned int)max(0, differentiation_power);
+        settings.series_power = (unsigned int)max(0, series_power);
+        settings.series_point = series_point;
+        settings.info = info;
+
+        const char* out_name = get_output_file_name(argc, argv, NULL);
+
+        BatchStats stats = run_batch(f_name, out_name, &settings);
+        printf("Processed %ld equations, %ld failed.\n", (long int)stats.equations, (long int)stats.failures);
+
+        return_clean(errno == 0 && stats.failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
+    }
+
     log_printf(STATUS_REPORTS, "status", "Opening file %s as the equation source.\n", f_name);
 
-    char* source_equation = read_whole(f_name);
+    MappedFile source = {};
+    _LOG_FAIL_CHECK_(MappedFile_ctor(&source, f_name), "error", ERROR_REPORTS, return_clean(EXIT_FAILURE), &errno, ENOENT);
 
-    log_printf(STATUS_REPORTS, "status", "File content:\n%s\n", source_equation);
+    //* Only the first line is parsed, so the rest of a big file is never touched.
+    const char* line_end = (const char*) memchr(source.data, '\n', source.size);
+    size_t line_length = line_end ? (size_t)(line_end - source.data) + 1 : source.size;
 
-    srand((unsigned int)get_simple_hash(source_equation, source_equation + strlen(source_equation)));
+    log_printf(STATUS_REPORTS, "status", "Equation (%ld bytes in the file):\n%.*s\n",
+               (long int)source.size, (int)(line_length < MAX_LOGGED_EQUATION_LENGTH ? line_length : MAX_LOGGED_EQUATION_LENGTH), source.data);
 
-    LexStack eq_lex_stack = lexify(source_equation);
-    int lex_caret = 0;
+    unsigned int seed = (unsigned int)get_simple_hash(source.data, source.data + line_length);
 
-    log_printf(STATUS_REPORTS, "status", "Lexeme stack size = %ld.\n", (long int)eq_lex_stack.size);
-    _log_printf(STATUS_REPORTS, "status", "Lexeme stack capacity = %ld.\n", (long int)eq_lex_stack.capacity);
+    LexCursor cursor = {};
+    LexCursor_ctor(&cursor, source.data);
 
-    Equation* equation = parse(eq_lex_stack, &lex_caret);
+    Equation* equation = parse(&cursor);
     track_allocation(equation, Equation_dtor);
 
-    LexStack_dtor(&eq_lex_stack);
-
-    free(source_equation);
+    MappedFile_dtor(&source);
 
     Equation_dump(equation, ABSOLUTE_IMPORTANCE);
     _LOG_FAIL_CHECK_(!Equation_get_error(equation), "error", ERROR_REPORTS, return_clean(EXIT_FAILURE), &errno, EAGAIN);
@@ -85,17 +146,11 @@ int main(const int argc, const char** argv) {
     Article_ctor(&article, "./");
     track_allocation(article, Article_dtor);
 
-    fprintf(article.storage.file, "\n\\subsection{Derivatives}\n\n");
-
-    describe_differentiation(&article, equation, (unsigned int)max(0, differentiation_power));
-
-    fprintf(article.storage.file, "\n\\subsection{Series representation}\n\n");
-
-    describe_series(&article, equation, series_point, (unsigned int)max(0, series_power));
-
-    fprintf(article.storage.file, "\n\\subsection{Tangent at $X=%lg$}\n\n", series_point);
+    article.info = info;
+    Article_seed(&article, seed);
 
-    describe_tangent(&article, equation, series_point);
+    describe_equation(&article, equation, (unsigned int)max(0, differentiation_power),
+                      series_point, (unsigned int)max(0, series_power));
 
     return_clean(errno == 0 ? EXIT_SUCCESS : EXIT_FAILURE);
 }
@@ -0,0 +1,92 @@
+/**
+ * @file test_egraph.cpp
+ * @author Kudryashov Ilya (kudriashov.it@phystech.edu)
+ * @brief Checks of equations extracted from saturated e-graphs.
+ * @version 0.1
+ * @date 2022-12-20
+ * 
+ * @copyright Copyright (c) 2022
+ * 
+ */
+
+#include <string.h>
+
+#include "lib/egraph.h"
+
+#include "tests.h"
+
+//* Expressions and their cheapest forms by size.
+static const struct {
+    const char* source;
+    const char* optimized;
+} OPTIMIZED[] = {
+    { "(x+0)*1",            "x" },
+    { "x*0+y",              "y" },
+    { "x-x+ln(1)",          "0" },
+    { "(x^1)^1*1",          "x" },
+};
+
+//* Expressions every extraction should keep the values of.
+static const char* const EQUATIONS[] = {
+    "x^2*sin(x)+cos(x)/3",
+    "ln(x^2+1)/(x-1)",
+    "x^x^0.5/(x-1)",
+    "(sin(x)+cos(x))*(sin(x)-cos(x))+2*x^3-x/7",
+    "x*x*x*x/(x*x)",
+    "(2*x+1)*(2*x+1)*y",
+    "1/(1+1/(1+1/(1+x)))",
+    "x^y^z*cos(x*y)-z/(y+1)",
+    "x*y+x*z+x*y",
+};
+
+static const double POINTS[][2] = { { -0.75, 0.5 }, { 0.3, 2.0 }, { 2.5, 1.25 } };
+
+static void check_optimized(const char* source, OptimizeCost cost, size_t* failures);
+
+void test_egraph(size_t* failures) {
+    for (size_t id = 0; id < sizeof(OPTIMIZED) / sizeof(*OPTIMIZED); ++id) {
+        Equation* equation = test_parse(OPTIMIZED[id].source);
+        TEST_CHECK(equation, "%s is not parsed", OPTIMIZED[id].source);
+        if (!equation) continue;
+
+        Equation* result = Equation_optimize(equation, OPT_COST_SIZE);
+        TEST_CHECK(!strcmp(test_write(result), OPTIMIZED[id].optimized), "%s is optimized to %s instead of %s",
+                   OPTIMIZED[id].source, test_write(result), OPTIMIZED[id].optimized);
+
+        Equation_dtor(&result);
+        Equation_dtor(&equation);
+    }
+
+    for (size_t id = 0; id < sizeof(EQUATIONS) / sizeof(*EQUATIONS); ++id) {
+        check_optimized(EQUATIONS[id], OPT_COST_SIZE, failures);
+        check_optimized(EQUATIONS[id], OPT_COST_EVAL, failures);
+    }
+
+    //* Math library reports domain errors of singular points through errno.
+    errno = 0;
+}
+
+static void check_optimized(const char* source, OptimizeCost cost, size_t* failures) {
+    Equation* equation = test_parse(source);
+    TEST_CHECK(equation, "%s is not parsed", source);
+    if (!equation) return;
+
+    Equation* result = Equation_optimize(equation, cost);
+    TEST_CHECK(result, "%s is not optimized", source);
+
+    if (result && cost == OPT_COST_SIZE) {
+        TEST_CHECK(Equation_size(result) <= Equation_size(equation), "%s grows to %s when optimized by size",
+                   source, test_write(result));
+    }
+
+    for (size_t point = 0; result && point < sizeof(POINTS) / sizeof(*POINTS); ++point) {
+        double expected = test_calculate(equation, POINTS[point][0], POINTS[point][1]);
+        double value = test_calculate(result, POINTS[point][0], POINTS[point][1]);
+
+        TEST_CHECK(Equation_same_value(expected, value), "%s optimized to %s is %.17lg instead of %.17lg at %lg",
+                   source, test_write(result), value, expected, POINTS[point][0]);
+    }
+
+    Equation_dtor(&result);
+    Equation_dtor(&equation);
+}
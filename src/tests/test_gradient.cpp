@@ -0,0 +1,96 @@
+/**
+ * @file test_gradient.cpp
+ * @author Kudryashov Ilya (kudriashov.it@phystech.edu)
+ * @brief Checks of reverse-mode gradients against symbolic derivatives.
+ * @version 0.1
+ * @date 2022-12-20
+ * 
+ * @copyright Copyright (c) 2022
+ * 
+ */
+
+#include <math.h>
+
+#include "lib/gradient.h"
+
+#include "tests.h"
+
+static const char* const EQUATIONS[] = {
+    "theta*x+v_0*x^2",
+    "x^x*sin(y)+ln(x*alpha+1)",
+    "x^y^z*cos(x*y)-z/(y+1)",
+    "sin(a*x)^b+cos(x)*ln(x+c+2)",
+    "(x+y)*(x+y)/(x-y)",
+    "0.000000000001*x*y+y^3",
+};
+
+//* Values of X and of the other variables the gradient is compared at.
+static const double POINTS[][2] = { { 0.5, 1.5 }, { 2.0, 0.25 }, { 3.0, 1.0 } };
+
+static void check_small_gradient(size_t* failures);
+
+void test_gradient(size_t* failures) {
+    check_small_gradient(failures);
+
+    for (size_t eq_id = 0; eq_id < sizeof(EQUATIONS) / sizeof(*EQUATIONS); ++eq_id) {
+        const char* source = EQUATIONS[eq_id];
+
+        Equation* equation = test_parse(source);
+        TEST_CHECK(equation, "%s is not parsed", source);
+        if (!equation) continue;
+
+        for (size_t point = 0; point < sizeof(POINTS) / sizeof(*POINTS); ++point) {
+            VarTable vars = {};
+            VarTable_ctor(&vars);
+
+            VarTable_set(&vars, SYMBOL_X, POINTS[point][0]);
+            VarTable_bind_all(&vars, equation, POINTS[point][1]);
+
+            double* gradient = (double*) calloc(vars.size, sizeof(*gradient));
+
+            double value = Equation_gradient(equation, &vars, gradient);
+            double expected_value = Equation_calculate_bound(equation, &vars);
+            TEST_CHECK(Equation_same_value(expected_value, value), "%s is %.17lg instead of %.17lg at X = %lg",
+                       source, value, expected_value, POINTS[point][0]);
+
+            for (size_t index = 0; index < vars.size; ++index) {
+                Equation* derivative = Equation_diff(equation, vars.vars[index].id);
+                Equation_simplify(derivative);
+
+                double expected = Equation_calculate_bound(derivative, &vars);
+
+                TEST_CHECK(Equation_same_value(expected, gradient[index]),
+                           "derivative of %s by %s is %.17lg instead of %.17lg at X = %lg",
+                           source, Symbol_name((symbol_t)vars.vars[index].id), gradient[index], expected,
+                           POINTS[point][0]);
+
+                Equation_dtor(&derivative);
+            }
+
+            free(gradient);
+            VarTable_dtor(&vars);
+        }
+
+        Equation_dtor(&equation);
+    }
+}
+
+static void check_small_gradient(size_t* failures) {
+    //* Derivatives far below the comparison tolerance should not be rounded to zero.
+    Equation* equation = test_parse("0.000000000001*x*y");
+
+    VarTable vars = {};
+    VarTable_ctor(&vars);
+
+    VarTable_set(&vars, SYMBOL_X, 2.0);
+    VarTable_bind_all(&vars, equation, 3.0);
+
+    double gradient[2] = {};
+    Equation_gradient(equation, &vars, gradient);
+
+    TEST_CHECK(fabs(gradient[0] - 3e-12) <= 1e-24, "derivative of 1e-12*x*y by x is %lg instead of 3e-12", gradient[0]);
+    TEST_CHECK(fabs(gradient[1] - 2e-12) <= 1e-24, "derivative of 1e-12*x*y by y is %lg instead of 2e-12", gradient[1]);
+
+    VarTable_dtor(&vars);
+    Equation_dtor(&equation);
+}
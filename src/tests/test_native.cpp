@@ -0,0 +1,75 @@
+/**
+ * @file test_native.cpp
+ * @author Kudryashov Ilya (kudriashov.it@phystech.edu)
+ * @brief Checks of equations compiled into native code against the tree evaluator.
+ * @version 0.1
+ * @date 2022-12-20
+ * 
+ * @copyright Copyright (c) 2022
+ * 
+ */
+
+#include "lib/native.h"
+
+#include "tests.h"
+
+static const char* const EQUATIONS[] = {
+    "x^2*sin(x)+cos(x)/3",
+    "ln(x^2+1)/(x-1)",
+    "x^x^0.5/(x-1)",
+    "2^x-3*x",
+    "(sin(x)+cos(x))*(sin(x)-cos(x))+2*x^3-x/7",
+};
+
+static const size_t NATIVE_ORDER = 2;
+
+static const double POINTS[] = { -0.75, 0.3, 2.5 };
+
+void test_native(size_t* failures) {
+    for (size_t eq_id = 0; eq_id < sizeof(EQUATIONS) / sizeof(*EQUATIONS); ++eq_id) {
+        const char* source = EQUATIONS[eq_id];
+
+        Equation* equation = test_parse(source);
+        TEST_CHECK(equation, "%s is not parsed", source);
+        if (!equation) continue;
+
+        int native_error = 0;
+        NativeEquation native = {};
+        NativeEquation_ctor(&native, equation, NATIVE_ORDER, &native_error);
+
+        //* Machines without the system compiler are not the concern of these checks.
+        if (!NativeEquation_get(&native, 0)) {
+            printf("native: %s was not compiled, skipping.\n", source);
+            Equation_dtor(&equation);
+            break;
+        }
+
+        Equation* derivative = Equation_copy(equation);
+
+        for (size_t power = 0; power <= NATIVE_ORDER; ++power) {
+            //* Derivatives of powers are defined for negative bases only after simplification.
+            Equation_simplify(derivative);
+            native_function_t* function = NativeEquation_get(&native, power);
+
+            for (size_t point = 0; point < sizeof(POINTS) / sizeof(*POINTS); ++point) {
+                int tree_error = 0;
+                double expected = Equation_calculate(derivative, POINTS[point], &tree_error);
+                double value = function(POINTS[point]);
+
+                TEST_CHECK(Equation_same_value(expected, value), "derivative %ld of %s is %.17lg instead of %.17lg at %lg",
+                           (long int)power, source, value, expected, POINTS[point]);
+            }
+
+            Equation* next = Equation_diff(derivative, SYMBOL_X);
+            Equation_dtor(&derivative);
+            derivative = next;
+        }
+
+        Equation_dtor(&derivative);
+        NativeEquation_dtor(&native);
+        Equation_dtor(&equation);
+    }
+
+    //* Missing cache entries and singular points are reported through errno.
+    errno = 0;
+}
@@ -0,0 +1,115 @@
+/**
+ * @file test_polynomial.cpp
+ * @author Kudryashov Ilya (kudriashov.it@phystech.edu)
+ * @brief Checks of polynomial normal form and like term collection.
+ * @version 0.1
+ * @date 2022-12-20
+ * 
+ * @copyright Copyright (c) 2022
+ * 
+ */
+
+#include <string.h>
+
+#include "lib/polynomial.h"
+
+#include "tests.h"
+
+//* Expressions with polynomial parts and the way their like terms are collected.
+static const struct {
+    const char* source;
+    const char* collected;
+} COLLECTED[] = {
+    { "x*2+3*x",                "5*x" },
+    { "(x+1)^2-x^2-2*x",        "1" },
+    { "(x+y)*(x-y)+y^2",        "x^2" },
+    { "x/4+x/4",                "x/2" },
+    { "sin(x)*3-sin(x)",        "2*sin(x)" },
+    { "(x+sin(y))*(x-sin(y))",  NULL },
+    { "(x+y)^3-(x-y)^3",        NULL },
+    { "(2*x+1)^5/3",            NULL },
+    { "ln(x*x+x*x)",            "ln(2*x^2)" },
+};
+
+//* Points the collected and the original expressions are compared at.
+static const double POINTS[][2] = { { -1.5, 0.7 }, { 0.3, -2.0 }, { 2.0, 3.5 } };
+
+static bool same_polynomial(const Polynomial* alpha, const Polynomial* beta);
+
+static void check_round_trip(const Equation* equation, const char* source, size_t* failures);
+
+void test_polynomial(size_t* failures) {
+    for (size_t id = 0; id < sizeof(COLLECTED) / sizeof(*COLLECTED); ++id) {
+        const char* source = COLLECTED[id].source;
+
+        Equation* equation = test_parse(source);
+        TEST_CHECK(equation, "%s is not parsed", source);
+        if (!equation) continue;
+
+        check_round_trip(equation, source, failures);
+
+        Equation* collected = Equation_copy(equation);
+        Equation_collect_terms(collected);
+
+        if (COLLECTED[id].collected) {
+            TEST_CHECK(!strcmp(test_write(collected), COLLECTED[id].collected),
+                       "%s is collected to %s instead of %s", source, test_write(collected), COLLECTED[id].collected);
+        }
+
+        for (size_t point = 0; point < sizeof(POINTS) / sizeof(*POINTS); ++point) {
+            double expected = test_calculate(equation, POINTS[point][0], POINTS[point][1]);
+            double value = test_calculate(collected, POINTS[point][0], POINTS[point][1]);
+
+            TEST_CHECK(Equation_same_value(expected, value), "%s after collection is %.17lg instead of %.17lg at %lg",
+                       source, value, expected, POINTS[point][0]);
+        }
+
+        Equation_dtor(&collected);
+        Equation_dtor(&equation);
+    }
+}
+
+static bool same_polynomial(const Polynomial* alpha, const Polynomial* beta) {
+    if (alpha->size != beta->size) return false;
+
+    for (size_t id = 0; id < alpha->size; ++id) {
+        if (!is_equal(alpha->terms[id].coef, beta->terms[id].coef)) return false;
+        if (memcmp(alpha->terms[id].powers, beta->terms[id].powers, sizeof(alpha->terms[id].powers))) return false;
+    }
+
+    return true;
+}
+
+static void check_round_trip(const Equation* equation, const char* source, size_t* failures) {
+    //* Polynomial -> equation -> polynomial should give the same terms and keep values of the expression.
+    Polynomial poly = {};
+    Polynomial_ctor(&poly);
+
+    PolyAtoms atoms = {};
+
+    if (Polynomial_from_equation(&poly, equation, &atoms)) {
+        Equation* rebuilt = Polynomial_to_equation(&poly, &atoms);
+
+        for (size_t point = 0; point < sizeof(POINTS) / sizeof(*POINTS); ++point) {
+            double expected = test_calculate(equation, POINTS[point][0], POINTS[point][1]);
+            double value = test_calculate(rebuilt, POINTS[point][0], POINTS[point][1]);
+
+            TEST_CHECK(Equation_same_value(expected, value), "%s as a polynomial is %.17lg instead of %.17lg at %lg",
+                       source, value, expected, POINTS[point][0]);
+        }
+
+        Polynomial again = {};
+        Polynomial_ctor(&again);
+
+        PolyAtoms again_atoms = atoms;
+        bool expanded = Polynomial_from_equation(&again, rebuilt, &again_atoms);
+
+        TEST_CHECK(expanded && again_atoms.size == atoms.size && same_polynomial(&poly, &again),
+                   "polynomial of %s changes after the round trip through %s", source, test_write(rebuilt));
+
+        Polynomial_dtor(&again);
+        Equation_dtor(&rebuilt);
+    }
+
+    Polynomial_dtor(&poly);
+}
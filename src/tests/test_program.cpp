@@ -0,0 +1,85 @@
+/**
+ * @file test_program.cpp
+ * @author Kudryashov Ilya (kudriashov.it@phystech.edu)
+ * @brief Checks of compiled equation programs against the tree evaluator.
+ * @version 0.1
+ * @date 2022-12-20
+ * 
+ * @copyright Copyright (c) 2022
+ * 
+ */
+
+#include "lib/equation_program.h"
+
+#include "tests.h"
+
+static const char* const EQUATIONS[] = {
+    "x",
+    "3",
+    "x^2*sin(x)+cos(x)/3",
+    "ln(x)+1/x",
+    "(x+1)^0.5-ln(x*x)",
+    "sin(x)^x",
+    "x^x^0.5/(x-1)",
+    "2^x-3*x",
+    "cos(sin(cos(x)))*ln(2-x)",
+    "(sin(x)+cos(x))*(sin(x)-cos(x))+2*x^3-x/7",
+    "y*x+z",
+};
+
+//* Number of points, not a multiple of the vector width, so the tail of the batch is checked too.
+static const size_t POINT_COUNT = 203;
+
+static const double FIRST_POINT = -4.0;
+static const double POINT_STEP = 0.0625;
+
+void test_program(size_t* failures) {
+    double xs[POINT_COUNT] = {};
+    double out[POINT_COUNT] = {};
+
+    for (size_t id = 0; id < POINT_COUNT; ++id) xs[id] = FIRST_POINT + POINT_STEP * (double)id;
+
+    for (size_t eq_id = 0; eq_id < sizeof(EQUATIONS) / sizeof(*EQUATIONS); ++eq_id) {
+        Equation* equation = test_parse(EQUATIONS[eq_id]);
+        TEST_CHECK(equation, "%s is not parsed", EQUATIONS[eq_id]);
+        if (!equation) continue;
+
+        //* Singular points set the error variable, they are compared all the same.
+        int domain_error = 0;
+
+        Equation_calculate_batch(equation, xs, out, POINT_COUNT, &domain_error);
+
+        EquationProgram program = {};
+        EquationProgram_ctor(&program, equation);
+
+        for (size_t id = 0; id < POINT_COUNT; ++id) {
+            int tree_error = 0;
+            double expected = Equation_calculate(equation, xs[id], &tree_error);
+
+            TEST_CHECK(Equation_same_value(expected, out[id]), "batch of %s gives %.17lg instead of %.17lg at X = %lg",
+                       EQUATIONS[eq_id], out[id], expected, xs[id]);
+
+            double single = EquationProgram_calculate(&program, xs[id], &tree_error);
+            TEST_CHECK(Equation_same_value(expected, single), "program of %s gives %.17lg instead of %.17lg at X = %lg",
+                       EQUATIONS[eq_id], single, expected, xs[id]);
+        }
+
+        EquationProgram_dtor(&program);
+
+        //* Results can overwrite the points.
+        double in_place[POINT_COUNT] = {};
+        for (size_t id = 0; id < POINT_COUNT; ++id) in_place[id] = xs[id];
+
+        Equation_calculate_batch(equation, in_place, in_place, POINT_COUNT, &domain_error);
+
+        for (size_t id = 0; id < POINT_COUNT; ++id) {
+            TEST_CHECK(Equation_same_value(out[id], in_place[id]), "in-place batch of %s gives %.17lg instead of %.17lg",
+                       EQUATIONS[eq_id], in_place[id], out[id]);
+        }
+
+        Equation_dtor(&equation);
+    }
+
+    //* Math library reports domain errors of singular points through errno.
+    errno = 0;
+}
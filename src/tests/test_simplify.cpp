@@ -0,0 +1,88 @@
+/**
+ * @file test_simplify.cpp
+ * @author Kudryashov Ilya (kudriashov.it@phystech.edu)
+ * @brief Checks of rule-based simplification.
+ * @version 0.1
+ * @date 2022-12-20
+ * 
+ * @copyright Copyright (c) 2022
+ * 
+ */
+
+#include <string.h>
+
+#include "tests.h"
+
+//* Expressions and their simplified forms.
+static const struct {
+    const char* source;
+    const char* simplified;
+} SIMPLIFIED[] = {
+    { "0-x*0+1*x^1",                "x" },
+    { "(x*2)*3+x/x",                "6*x+1" },
+    { "(x^2)^3*(x^3)^2",            "x^12" },
+    { "ln(x-x+1)*sin(x)",           "0" },
+    { "sin(0*x)+cos(x)^(2-1)",      "sin(0)+cos(x)" },
+    { "(x+1)^2-x^2-2*x",            "1" },
+    { "ln((x+1)^2-x^2-2*x)+y",      "y" },
+    { "sin(x*x+x*x)/cos(3*x-x-x)",  "sin(2*x^2)/cos(x)" },
+};
+
+//* Expressions simplification should keep the values of.
+static const char* const EQUATIONS[] = {
+    "x^2*sin(x)+cos(x)/3",
+    "ln(x^2+1)/(x-1)",
+    "x^x^0.5/(x-1)",
+    "(sin(x)+cos(x))*(sin(x)-cos(x))+2*x^3-x/7",
+    "x*x*x*x/(x*x)",
+    "(2*x+1)^5/3",
+    "1/(1+1/(1+1/(1+x)))",
+    "x^y^z*cos(x*y)-z/(y+1)",
+};
+
+static const double POINTS[][2] = { { -0.75, 0.5 }, { 0.3, 2.0 }, { 2.5, 1.25 } };
+
+static void check_simplified(const char* source, const char* simplified, size_t* failures);
+
+void test_simplify(size_t* failures) {
+    for (size_t id = 0; id < sizeof(SIMPLIFIED) / sizeof(*SIMPLIFIED); ++id)
+        check_simplified(SIMPLIFIED[id].source, SIMPLIFIED[id].simplified, failures);
+
+    for (size_t id = 0; id < sizeof(EQUATIONS) / sizeof(*EQUATIONS); ++id)
+        check_simplified(EQUATIONS[id], NULL, failures);
+}
+
+static void check_simplified(const char* source, const char* simplified, size_t* failures) {
+    Equation* equation = test_parse(source);
+    TEST_CHECK(equation, "%s is not parsed", source);
+    if (!equation) return;
+
+    Equation* result = Equation_copy(equation);
+    Equation_simplify(result);
+
+    if (simplified) {
+        TEST_CHECK(!strcmp(test_write(result), simplified), "%s is simplified to %s instead of %s",
+                   source, test_write(result), simplified);
+    }
+
+    //* One pass should leave nothing for the next one.
+    Equation* again = Equation_copy(result);
+    Equation_simplify(again);
+    TEST_CHECK(Equation_equal(again, result), "simplified form of %s is simplified further to %s",
+               source, test_write(again));
+
+    for (size_t point = 0; point < sizeof(POINTS) / sizeof(*POINTS); ++point) {
+        double expected = test_calculate(equation, POINTS[point][0], POINTS[point][1]);
+        double value = test_calculate(result, POINTS[point][0], POINTS[point][1]);
+
+        TEST_CHECK(Equation_same_value(expected, value), "%s after simplification is %.17lg instead of %.17lg at %lg",
+                   source, value, expected, POINTS[point][0]);
+    }
+
+    Equation_dtor(&again);
+    Equation_dtor(&result);
+    Equation_dtor(&equation);
+
+    //* Math library reports domain errors of singular points through errno.
+    errno = 0;
+}
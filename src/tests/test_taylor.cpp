@@ -0,0 +1,64 @@
+/**
+ * @file test_taylor.cpp
+ * @author Kudryashov Ilya (kudriashov.it@phystech.edu)
+ * @brief Checks of truncated power series.
+ * @version 0.1
+ * @date 2022-12-20
+ * 
+ * @copyright Copyright (c) 2022
+ * 
+ */
+
+#include "lib/taylor.h"
+
+#include "tests.h"
+
+static const size_t SERIES_ORDER = 7;
+
+//* Expressions with known series at the point.
+static const struct {
+    const char* source;
+    double point;
+    double coefs[SERIES_ORDER + 1];
+} SERIES[] = {
+    { "sin(x)",             0.0, { 0, 1, 0, -1.0 / 6, 0, 1.0 / 120, 0, -1.0 / 5040 } },
+    { "ln(x)",              1.0, { 0, 1, -1.0 / 2, 1.0 / 3, -1.0 / 4, 1.0 / 5, -1.0 / 6, 1.0 / 7 } },
+    { "1/(1-x)",            0.0, { 1, 1, 1, 1, 1, 1, 1, 1 } },
+    { "(1+x)^0.5",          0.0, { 1, 1.0 / 2, -1.0 / 8, 1.0 / 16, -5.0 / 128, 7.0 / 256, -21.0 / 1024, 33.0 / 2048 } },
+    { "x^3*cos(x)",         0.0, { 0, 0, 0, 1, 0, -1.0 / 2, 0, 1.0 / 24 } },
+    { "(x-2)^2",            2.0, { 0, 0, 1, 0, 0, 0, 0, 0 } },
+    { "x^1000000000",       0.0, { 0, 0, 0, 0, 0, 0, 0, 0 } },
+    { "x^1000000000+x",     0.0, { 0, 1, 0, 0, 0, 0, 0, 0 } },
+};
+
+void test_taylor(size_t* failures) {
+    for (size_t id = 0; id < sizeof(SERIES) / sizeof(*SERIES); ++id) {
+        const char* source = SERIES[id].source;
+
+        Equation* equation = test_parse(source);
+        TEST_CHECK(equation, "%s is not parsed", source);
+        if (!equation) continue;
+
+        double coefs[SERIES_ORDER + 1] = {};
+        bool has_series = Equation_taylor(equation, SERIES[id].point, SERIES_ORDER, coefs);
+        TEST_CHECK(has_series, "%s has no series at %lg", source, SERIES[id].point);
+
+        for (size_t power = 0; has_series && power <= SERIES_ORDER; ++power) {
+            TEST_CHECK(Equation_same_value(SERIES[id].coefs[power], coefs[power]),
+                       "coefficient of power %ld of %s is %.17lg instead of %.17lg",
+                       (long int)power, source, coefs[power], SERIES[id].coefs[power]);
+        }
+
+        Equation_dtor(&equation);
+    }
+
+    //* ln(x) has no series at zero.
+    Equation* equation = test_parse("ln(x)");
+    double coefs[SERIES_ORDER + 1] = {};
+    int error = 0;
+    TEST_CHECK(!Equation_taylor(equation, 0.0, SERIES_ORDER, coefs, &error), "ln(x) has a series at 0");
+    Equation_dtor(&equation);
+
+    //* Math library reports overflows of huge powers through errno.
+    errno = 0;
+}
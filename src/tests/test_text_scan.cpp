@@ -0,0 +1,58 @@
+/**
+ * @file test_text_scan.cpp
+ * @author Kudryashov Ilya (kudriashov.it@phystech.edu)
+ * @brief Checks of number scanning against strtod.
+ * @version 0.1
+ * @date 2022-12-20
+ * 
+ * @copyright Copyright (c) 2022
+ * 
+ */
+
+#include <string.h>
+
+#include "lib/text_scan.h"
+
+#include "tests.h"
+
+//* Numbers on both sides of the fast path limits, followed by the text they may be met in.
+static const char* const NUMBERS[] = {
+    "0", "7", "42+x", "3.5)", "0.1*x", "0.3", "2.675", "123456.789e-3",
+    "1e22", "1e23", "1e-22", "1e-23", "4.35e22", "9.99e-22", "8.5e+3", "1E5",
+    "9007199254740992", "9007199254740993", "9007199254740991.5",
+    "1234567890123456789", "12345678901234567890", "0.12345678901234567890123",
+    "17976931348623157e292", "1e308", "1e309", "1e-400", "2.2250738585072014e-308",
+    "1e", "1e+", "2e-x", "5.", "5.e2", "000000000000000000000001.5",
+    "0x1p3", "0X1A", "1e100000000000",
+};
+
+//* Offsets of the number in the buffer, so blocks read by skip_digits start everywhere in it.
+static const size_t MAX_OFFSET = 64;
+
+void test_text_scan(size_t* failures) {
+    //* Blocks are read as far as the end of the block with the terminator in it.
+    alignas(64) char buffer[256] = "";
+
+    for (size_t id = 0; id < sizeof(NUMBERS) / sizeof(*NUMBERS); ++id) {
+        const char* number = NUMBERS[id];
+
+        for (size_t offset = 0; offset < MAX_OFFSET; ++offset) {
+            memset(buffer, 0, sizeof(buffer));
+            strcpy(buffer + offset, number);
+
+            char* expected_end = NULL;
+            double expected = strtod(buffer + offset, &expected_end);
+
+            const char* end = NULL;
+            double value = scan_number(buffer + offset, &end);
+
+            TEST_CHECK(!memcmp(&value, &expected, sizeof(value)), "%s is scanned as %.17lg instead of %.17lg",
+                       number, value, expected);
+            TEST_CHECK(end == expected_end, "scan of %s stops at %td instead of %td", number,
+                       end - (buffer + offset), expected_end - (buffer + offset));
+        }
+    }
+
+    //* strtod reports overflows and underflows of huge exponents through errno.
+    errno = 0;
+}
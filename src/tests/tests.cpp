@@ -0,0 +1,97 @@
+/**
+ * @file tests.cpp
+ * @author Kudryashov Ilya (kudriashov.it@phystech.edu)
+ * @brief Runner of behaviour checks.
+ * @version 0.1
+ * @date 2022-12-20
+ * 
+ * @copyright Copyright (c) 2022
+ * 
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "lib/util/dbg/debug.h"
+#include "lib/grammar.h"
+#include "lib/var_table.h"
+
+#include "tests.h"
+
+struct TestCase {
+    const char* name;
+    test_t* function;
+};
+
+static const TestCase TESTS[] = {
+    { "polynomial", test_polynomial },
+    { "program",    test_program },
+    { "taylor",     test_taylor },
+    { "gradient",   test_gradient },
+    { "simplify",   test_simplify },
+    { "text_scan",  test_text_scan },
+    { "egraph",     test_egraph },
+    { "native",     test_native },
+};
+
+int main() {
+    atexit(log_end_program);
+
+    log_init("program_log.html", ERROR_REPORTS, &errno);
+
+    size_t failed_tests = 0;
+
+    for (size_t id = 0; id < sizeof(TESTS) / sizeof(*TESTS); ++id) {
+        size_t failures = 0;
+        errno = 0;
+
+        TESTS[id].function(&failures);
+
+        if (errno) {
+            printf("%s: errno was set to %d.\n", TESTS[id].name, errno);
+            ++failures;
+        }
+
+        printf("%-16s %s\n", TESTS[id].name, failures ? "FAILED" : "ok");
+        if (failures) ++failed_tests;
+    }
+
+    printf("%ld of %ld tests failed.\n", (long int)failed_tests, (long int)(sizeof(TESTS) / sizeof(*TESTS)));
+
+    return failed_tests ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+Equation* test_parse(const char* text) {
+    LexCursor cursor = {};
+    LexCursor_ctor(&cursor, text);
+
+    Equation* equation = parse(&cursor);
+
+    if (Equation_get_error(equation) || cursor.lexeme.type != LEX_OP_TERM) Equation_dtor(&equation);
+
+    return equation;
+}
+
+const char* test_write(const Equation* equation) {
+    static char formula[TEST_FORMULA_LENGTH] = "";
+
+    caret_t caret = formula;
+    if (!Equation_write_as_input(equation, &caret, formula + TEST_FORMULA_LENGTH - 1)) return "<unwritable>";
+    *caret = '\0';
+
+    return formula;
+}
+
+double test_calculate(const Equation* equation, double x_value, double other_value) {
+    VarTable vars = {};
+    VarTable_ctor(&vars);
+
+    VarTable_set(&vars, SYMBOL_X, x_value);
+    VarTable_bind_all(&vars, equation, other_value);
+
+    double value = Equation_calculate_bound(equation, &vars);
+
+    VarTable_dtor(&vars);
+
+    return value;
+}
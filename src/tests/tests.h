@@ -0,0 +1,74 @@
+/**
+ * @file tests.h
+ * @author Kudryashov Ilya (kudriashov.it@phystech.edu)
+ * @brief Behaviour checks of the equation library.
+ * @version 0.1
+ * @date 2022-12-20
+ * 
+ * @copyright Copyright (c) 2022
+ * 
+ */
+
+#ifndef TESTS_H
+#define TESTS_H
+
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "lib/bin_tree.h"
+
+//* Maximum length of formulas written by tests.
+static const size_t TEST_FORMULA_LENGTH = 4096;
+
+/**
+ * @brief Count the failure and print it with the formatted explanation if the condition does not hold.
+ * Expects `size_t* failures` to be in scope.
+ */
+#define TEST_CHECK(condition, ...) do {                                                 \
+    if (!(condition)) {                                                                 \
+        printf("%s:%d: check (%s) failed: ", __FILE__, __LINE__, #condition);          \
+        printf(__VA_ARGS__);                                                            \
+        putchar('\n');                                                                  \
+        ++*failures;                                                                    \
+    }                                                                                   \
+} while (0)
+
+//* Group of checks, adds number of failed checks to the counter.
+typedef void test_t(size_t* failures);
+
+/**
+ * @brief Parse the equation from the text in the input syntax.
+ * 
+ * @param text
+ * @return new equation (NULL if the text is not an equation)
+ */
+Equation* test_parse(const char* text);
+
+/**
+ * @brief Write the equation in the input syntax.
+ * 
+ * @param equation
+ * @return static buffer with the formula (overwritten by the next call)
+ */
+const char* test_write(const Equation* equation);
+
+/**
+ * @brief Calculate the equation with X = x_value and every other variable equal to other_value.
+ * 
+ * @param equation
+ * @param x_value
+ * @param other_value
+ * @return value of the equation
+ */
+double test_calculate(const Equation* equation, double x_value, double other_value);
+
+test_t test_polynomial;
+test_t test_program;
+test_t test_taylor;
+test_t test_gradient;
+test_t test_simplify;
+test_t test_text_scan;
+test_t test_egraph;
+test_t test_native;
+
+#endif
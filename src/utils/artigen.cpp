@@ -7,13 +7,12 @@
 
 #include "lib/util/dbg/logger.h"
 #include "lib/util/dbg/debug.h"
+#include "lib/dual.h"
+#include "lib/taylor.h"
+#include "lib/native.h"
 
 #include "config.h"
 
-#define INIT_PRINT_BUFFER() static char formula_buffer[MAX_FORMULA_LENGTH] = "";    \
-    memset(formula_buffer, 0, sizeof(formula_buffer));                              \
-    caret_t formula_caret = formula_buffer
-
 /**
  * @brief Print one of the transition phrases into the article.
  * 
@@ -22,26 +21,65 @@
 static void put_transition(ArticleProject* article);
 
 /**
- * @brief Replace variable under equation with equation derivative.
+ * @brief Write the equation into the formula buffer of the article.
+ * 
+ * @param article
+ * @param equation
+ * @param writer function to write the equation with
+ * @return text of the equation (empty if it could not be written)
+ */
+static const char* write_formula(ArticleProject* article, const Equation* equation, equation_writer_t* writer);
+
+/**
+ * @brief Plot the equation around the point from its values calculated in one batch.
+ * 
+ * @param article
+ * @param equation
+ * @param point center of the graph
+ * @param color line color
+ */
+static void put_graph(ArticleProject* article, const Equation* equation, double point, const char* color);
+
+/**
+ * @brief Calculate the equation at every point with its compiled native code.
  * 
- * @param equation 
+ * @param equation
+ * @param xs points
+ * @param out where to put the values
+ * @param count number of points
+ * @return false if the equation could not be compiled
  */
-void diff_in_place(Equation** equation);
+static bool calculate_native(const Equation* equation, const double* xs, double* out, size_t count);
 
 void Article_ctor(ArticleProject* article, const char* dest_folder) {
     _LOG_FAIL_CHECK_(article, "error", ERROR_REPORTS, return, &errno, EFAULT);
     _LOG_FAIL_CHECK_(dest_folder, "error", ERROR_REPORTS, return, &errno, EFAULT);
 
-    static char full_file_name[FILENAME_MAX] = "";
+    char full_file_name[FILENAME_MAX] = "";
     strncpy(full_file_name, dest_folder, FILENAME_MAX - 1);
-    strncat(full_file_name, ART_MAIN_NAME, strlen(full_file_name) - strlen(ART_MAIN_NAME));
+    strncat(full_file_name, ART_MAIN_NAME, FILENAME_MAX - 1 - strlen(full_file_name));
 
     article->storage.folder_name = dest_folder;
     article->storage.file = fopen(full_file_name, "w");
     _LOG_FAIL_CHECK_(article->storage.file, "error", ERROR_REPORTS, return, &errno, ENOENT);
 
+    article->formula_capacity = MAX_FORMULA_LENGTH;
+    article->formula_buffer = (char*) calloc(article->formula_capacity, sizeof(*article->formula_buffer));
+    if (!article->formula_buffer) {
+        fclose(article->storage.file);
+        article->storage.file = NULL;
+    }
+    _LOG_FAIL_CHECK_(article->formula_buffer, "error", ERROR_REPORTS, return, &errno, ENOMEM);
+
+    //* Unseeded generator gives the same sequence as rand() without srand().
+    article->random = {};
+    initstate_r(1, article->random_state, sizeof(article->random_state), &article->random);
+
     fprintf(article->storage.file, "%s", ARTICLE_PREFIX);
 
+    EquationTable_ctor(&article->nodes);
+    DiffCache_ctor(&article->derivatives);
+
     _LOG_FAIL_CHECK_(article->storage.file, "error", ERROR_REPORTS, return, &errno, ENOENT);
 }
 
@@ -55,18 +93,27 @@ void Article_dtor(ArticleProject* article) {
 
     article->storage.folder_name = "";
     article->info.max_dif_power = 0;
+
+    DiffCache_dtor(&article->derivatives);
+    EquationTable_dtor(&article->nodes);
+
+    free(article->formula_buffer);
+    article->formula_buffer = NULL;
+    article->formula_capacity = 0;
 }
 
 bool Article_is_fine(ArticleProject* article) {
-    if (!article || !article->storage.file) return false;
+    if (!article || !article->storage.file || !article->formula_buffer) return false;
     return true;
 }
 
-#define FILL_PRINT_BUFFER(eq) do {                      \
-    formula_caret = formula_buffer;                     \
-    Equation_write_as_tex(eq, &formula_caret, &errno);  \
-    *formula_caret = '\0';                              \
-} while (0)
+void Article_seed(ArticleProject* article, unsigned int seed) {
+    _LOG_FAIL_CHECK_(Article_is_fine(article), "error", ERROR_REPORTS, return, &errno, EINVAL);
+
+    srandom_r(seed, &article->random);
+}
+
+#define FILL_PRINT_BUFFER(eq) write_formula(article, eq, Equation_write_as_tex)
 
 //* Printf for article.
 #define PUT(...) fprintf(article->storage.file, __VA_ARGS__)
@@ -75,23 +122,19 @@ void describe_differentiation(ArticleProject* article, const Equation* equation,
     _LOG_FAIL_CHECK_(Article_is_fine(article), "error", ERROR_REPORTS, return, &errno, EINVAL);
     _LOG_FAIL_CHECK_(!Equation_get_error(equation), "error", ERROR_REPORTS, return, &errno, EINVAL);
 
-    Equation* current_stage = Equation_copy(equation);
+    const Equation* current_stage = EquationTable_import(&article->nodes, equation);
     unsigned int cur_power = 0;
 
     while (cur_power < article->info.max_dif_power && cur_power < power) {
-        diff_in_place(&current_stage);
+        diff_in_place(article, &current_stage);
 
         ++cur_power;
     }
 
-    INIT_PRINT_BUFFER();
-
     if (cur_power > 0) {
-        FILL_PRINT_BUFFER(equation);
-        PUT("We have already proven the statement\n\\[(%s)^{(%ld)}=", formula_buffer, (long int)cur_power);
+        PUT("We have already proven the statement\n\\[(%s)^{(%ld)}=", FILL_PRINT_BUFFER(equation), (long int)cur_power);
 
-        FILL_PRINT_BUFFER(current_stage);
-        PUT("%s\\]\n", formula_buffer);
+        PUT("%s\\]\n", FILL_PRINT_BUFFER(current_stage));
 
         if (cur_power < power) {
             PUT("Let\'s now continue calculating derivatives.\\newline\n");
@@ -101,13 +144,11 @@ void describe_differentiation(ArticleProject* article, const Equation* equation,
     while (cur_power < power) {
         put_transition(article);
 
-        FILL_PRINT_BUFFER(current_stage);
-        PUT("\\[(%s)'=", formula_buffer);
+        PUT("\\[(%s)'=", FILL_PRINT_BUFFER(current_stage));
 
-        diff_in_place(&current_stage);
+        diff_in_place(article, &current_stage);
 
-        FILL_PRINT_BUFFER(current_stage);
-        PUT("%s\\]\n", formula_buffer);
+        PUT("%s\\]\n", FILL_PRINT_BUFFER(current_stage));
 
         ++cur_power;
 
@@ -118,8 +159,6 @@ void describe_differentiation(ArticleProject* article, const Equation* equation,
         }
     }
 
-    Equation_dtor(&current_stage);
-
     if (cur_power > article->info.max_dif_power) article->info.max_dif_power = cur_power;
 }
 
@@ -127,48 +166,70 @@ void describe_series(ArticleProject* article, const Equation* equation, double p
     _LOG_FAIL_CHECK_(Article_is_fine(article), "error", ERROR_REPORTS, return, &errno, EINVAL);
     _LOG_FAIL_CHECK_(!Equation_get_error(equation), "error", ERROR_REPORTS, return, &errno, EINVAL);
 
-    INIT_PRINT_BUFFER();
+    PUT("Let's expand every part of the equation into the series and combine them, "
+        "so no derivatives have to be written down.\\newline\n");
 
-    PUT("Let's first calculate equation derivatives.\\newline\n");
-    describe_differentiation(article, equation, power);
+    double* coefs = (double*) calloc((size_t)power + 1, sizeof(*coefs));
+    _LOG_FAIL_CHECK_(coefs, "error", ERROR_REPORTS, return, &errno, ENOMEM);
+
+    //* Missing series is a property of the equation, not a failure of the article.
+    int series_error = 0;
+    if (!Equation_taylor(equation, point, power, coefs, &series_error)) {
+        PUT("Unfortunately, the Taylor series of the equation does not exist at the point $x=%lg$, "
+            "as the equation is not differentiable there.\\newline\n", point);
+        free(coefs);
+        return;
+    }
 
-    PUT("Then we can just place values to previously calculated derivatives and paste them to the series formula.\n");
+    PUT("Combining the series of its parts we get\n");
 
-    FILL_PRINT_BUFFER(equation);
-    PUT("\\[%s=", formula_buffer);
+    PUT("\\[%s=", FILL_PRINT_BUFFER(equation));
+
+    bool is_first = true;
 
     unsigned long long divisor = 1;
-    Equation* current_stage = Equation_copy(equation);
-    unsigned int cur_power = 0;
-    for (; cur_power < power; divisor *= ++cur_power + 1) {
-        diff_in_place(&current_stage);
+    for (unsigned int cur_power = 0; cur_power <= power; ++cur_power) {
+        //* Coefficients are printed as derivative / factorial while factorial fits into the divisor.
+        bool as_fraction = cur_power <= MAX_SERIES_FRACTION_POWER;
+        if (cur_power && as_fraction) divisor *= cur_power;
 
-        double value = Equation_calculate(current_stage, 'x');
+        double value = coefs[cur_power];
 
-        if (is_equal(value, 0.0)) continue;
+        //* Coefficients of high powers are tiny, so only exact zeros are left out.
+        if (fpclassify(value) == FP_ZERO) continue;
 
-        double top = value;
-        unsigned long long bottom = divisor;
+        double top = as_fraction ? value * (double)divisor : value;
+        unsigned long long bottom = as_fraction ? divisor : 1;
 
-        if (is_equal(top, round(top))) {
-            unsigned long long div = gcd((unsigned long long)abs(top), bottom);
+        if (!is_equal(round(top), 0.0) && is_equal(top, round(top))) {
+            top = round(top);
+            unsigned long long div = gcd((unsigned long long)fabs(top), bottom);
             top /= (double)div;
             bottom /= div;
         }
 
-        if (cur_power) {
-            if (bottom != 1) PUT("+\\frac{%lg}{%lld}", top, (long long)bottom);
-            else if (!is_equal(value, 1.0)) PUT("%+lg", top);
+        //* Sign goes in front of the fraction, the first term has no plus.
+        if (top < 0) PUT("-");
+        else if (!is_first) PUT("+");
+        top = fabs(top);
+
+        if (bottom != 1) PUT("\\frac{%lg}{%lld}", top, (long long)bottom);
+        else if (!cur_power || !is_equal(top, 1.0)) PUT("%lg", top);
 
+        if (cur_power) {
             if (is_equal(point, 0.0)) PUT("x");
             else PUT("(x%+lg)", -point);
 
             if (cur_power > 1) PUT("^{%d}", (int)cur_power);
-        } else {
-            PUT("%lg", value);
         }
+
+        is_first = false;
     }
 
+    if (is_first) PUT("0");
+
+    free(coefs);
+
     if (power > 0) {
         if (!is_equal(point, 0.0)) PUT("+o((x%+lg)", -point);
         else PUT("+o(x");
@@ -180,8 +241,6 @@ void describe_series(ArticleProject* article, const Equation* equation, double p
         PUT("+o(1)");
     }
     
-    Equation_dtor(&current_stage);
-
     PUT("\\]");
 }
 
@@ -189,21 +248,17 @@ void describe_tangent(ArticleProject* article, const Equation* equation, double
     _LOG_FAIL_CHECK_(Article_is_fine(article), "error", ERROR_REPORTS, return, &errno, EINVAL);
     _LOG_FAIL_CHECK_(!Equation_get_error(equation), "error", ERROR_REPORTS, return, &errno, EINVAL);
 
-    INIT_PRINT_BUFFER();
-
-    double value = Equation_calculate(equation, point);
+    Dual tangent_point = Equation_calculate_dual(equation, point);
+    double value = tangent_point.val;
+    double slope_k = tangent_point.der;
 
-    Equation* deriv = Equation_diff(equation, 'x');
-    Equation_simplify(deriv);
+    //* Derivative is simplified the same way as in the derivatives section.
+    const Equation* deriv = EquationTable_import(&article->nodes, equation);
+    diff_in_place(article, &deriv);
 
-    double slope_k = Equation_calculate(deriv, point);
-
-    FILL_PRINT_BUFFER(equation);
     PUT("To find the tangent, first we need to calculate first derivative of the equation at point $x=%lg$.\n", point);
-    PUT("\\[(%s)'=", formula_buffer);
-
-    FILL_PRINT_BUFFER(deriv);
-    PUT("%s=%lg\\]\n", formula_buffer, slope_k);
+    PUT("\\[(%s)'=", FILL_PRINT_BUFFER(equation));
+    PUT("%s=%lg\\]\n", FILL_PRINT_BUFFER(deriv), slope_k);
 
     double constant = 0.0;
 
@@ -218,10 +273,7 @@ void describe_tangent(ArticleProject* article, const Equation* equation, double
 
     PUT(ARTICLE_GRAPH_PREFIX_TEMPLATE, point, point);
 
-    formula_caret = formula_buffer;
-    Equation_write_as_formula(equation, &formula_caret, &errno);
-    *formula_caret = '\0';
-    PUT(ARTICLE_GRAPH_TEMPLATE, point, point, "blue", formula_buffer);
+    put_graph(article, equation, point, "blue");
 
     const char* tangent_formula = dynamic_sprintf("%lf*x%+lf", slope_k, constant);
     PUT(ARTICLE_GRAPH_TEMPLATE, point, point, "red", tangent_formula);
@@ -229,19 +281,107 @@ void describe_tangent(ArticleProject* article, const Equation* equation, double
     tangent_formula = NULL;
 
     PUT(ARTICLE_GRAPH_SUFFIX);
+}
+
+void describe_equation(ArticleProject* article, const Equation* equation, unsigned int dif_power,
+                       double point, unsigned int series_power) {
+    _LOG_FAIL_CHECK_(Article_is_fine(article), "error", ERROR_REPORTS, return, &errno, EINVAL);
+
+    PUT("\n\\subsection{Derivatives}\n\n");
+
+    describe_differentiation(article, equation, dif_power);
+
+    PUT("\n\\subsection{Series representation}\n\n");
+
+    describe_series(article, equation, point, series_power);
+
+    PUT("\n\\subsection{Tangent at $X=%lg$}\n\n", point);
+
+    describe_tangent(article, equation, point);
+}
+
+static const char* write_formula(ArticleProject* article, const Equation* equation, equation_writer_t* writer) {
+    if (!Equation_write_to_buffer(equation, writer, &article->formula_buffer, &article->formula_capacity,
+                                  FORMULA_LENGTH_LIMIT)) return "";
 
-    Equation_dtor(&deriv);
+    return article->formula_buffer;
+}
+
+static void put_graph(ArticleProject* article, const Equation* equation, double point, const char* color) {
+    double* xs = (double*) calloc(ARTICLE_GRAPH_SAMPLES, sizeof(*xs));
+    double* ys = (double*) calloc(ARTICLE_GRAPH_SAMPLES, sizeof(*ys));
+
+    if (!xs || !ys) {
+        free(xs);
+        free(ys);
+        _LOG_FAIL_CHECK_(false, "error", ERROR_REPORTS, return, &errno, ENOMEM);
+    }
+
+    for (size_t id = 0; id < ARTICLE_GRAPH_SAMPLES; ++id) {
+        xs[id] = point - ARTICLE_GRAPH_RADIUS + 2.0 * ARTICLE_GRAPH_RADIUS * (double)id / (double)(ARTICLE_GRAPH_SAMPLES - 1);
+    }
+
+    //* Division by zero is not an error here, such points are just skipped by pgfplots.
+    int calc_error = 0;
+    if (!article->info.native || !calculate_native(equation, xs, ys, ARTICLE_GRAPH_SAMPLES)) {
+        Equation_calculate_batch(equation, xs, ys, ARTICLE_GRAPH_SAMPLES, &calc_error);
+    }
+
+    PUT(ARTICLE_GRAPH_POINTS_PREFIX, color);
+    for (size_t id = 0; id < ARTICLE_GRAPH_SAMPLES; ++id) {
+        //* Sign of NaN is dropped, as pgfplots does not read "-nan".
+        PUT(ARTICLE_GRAPH_POINT_TEMPLATE, xs[id], isnan(ys[id]) ? NAN : ys[id]);
+    }
+    PUT(ARTICLE_GRAPH_POINTS_SUFFIX);
+
+    free(xs);
+    free(ys);
+}
+
+static bool calculate_native(const Equation* equation, const double* xs, double* out, size_t count) {
+    //* Cache misses and compiler failures go through errno, but the graph is still drawn without the compiler.
+    int old_errno = errno;
+
+    int native_error = 0;
+    NativeEquation native = {};
+    NativeEquation_ctor(&native, equation, 0, &native_error);
+
+    native_function_t* function = NativeEquation_get(&native, 0);
+    for (size_t id = 0; function && id < count; ++id) out[id] = function(xs[id]);
+
+    NativeEquation_dtor(&native);
+
+    errno = old_errno;
+    return function != NULL;
 }
 
 static void put_transition(ArticleProject* article) {
-    PUT("%s", TRANSITION_PHRASES[(unsigned int)rand() % TRANSITION_PHRASE_COUNT]);
+    int32_t phrase_id = 0;
+    random_r(&article->random, &phrase_id);
+
+    PUT("%s", TRANSITION_PHRASES[(unsigned int)phrase_id % TRANSITION_PHRASE_COUNT]);
 }
 
-void diff_in_place(Equation** equation) {
+void diff_in_place(ArticleProject* article, const Equation** equation) {
     _LOG_FAIL_CHECK_(!Equation_get_error(*equation), "error", ERROR_REPORTS, return, &errno, EINVAL);
 
-    Equation* next_stage = Equation_diff(*equation, 'x');
-    Equation_dtor(equation);
-    *equation = next_stage;
-    Equation_simplify(*equation);
+    const Equation* derivative = NULL;
+    if (article->info.pool) {
+        //* Parallel derivative is a tree, it is shared right away so later stages work on the DAG too.
+        Equation* parallel = Equation_diff_parallel(*equation, SYMBOL_X, article->info.pool);
+        derivative = EquationTable_import(&article->nodes, parallel);
+        Equation_dtor(&parallel);
+    } else {
+        derivative = EquationTable_diff(&article->nodes, *equation, SYMBOL_X, &article->derivatives);
+    }
+
+    derivative = EquationTable_simplify(&article->nodes, derivative);
+
+    if (article->info.optimize) {
+        Equation* optimized = Equation_optimize(derivative, article->info.optimize_cost);
+        if (optimized) derivative = EquationTable_import(&article->nodes, optimized);
+        Equation_dtor(&optimized);
+    }
+
+    *equation = derivative;
 }
@@ -12,7 +12,12 @@
 #ifndef ARTIGEN_H
 #define ARTIGEN_H
 
+#include <stdlib.h>
+
 #include "lib/bin_tree.h"
+#include "lib/equation_table.h"
+#include "lib/egraph.h"
+#include "lib/thread_pool.h"
 
 struct ArticleStorage {
     const char* folder_name = NULL;
@@ -21,22 +26,70 @@ struct ArticleStorage {
 
 struct ArticleInfo {
     unsigned int max_dif_power = 0;
+
+    bool optimize = false;
+    OptimizeCost optimize_cost = OPT_COST_SIZE;
+
+    bool native = false;        //* Sample graphs with the equation compiled into native code.
+
+    ThreadPool* pool = NULL;    //* Pool to differentiate in (NULL = use the main thread).
 };
 
+//* Size of the random generator state of the article (same as the one rand() uses).
+static const size_t ARTICLE_RANDOM_STATE_SIZE = 128;
+
 struct ArticleProject {
     ArticleStorage storage = {};
 
     ArticleInfo info = {};
+
+    EquationTable nodes = {};
+    DiffCache derivatives = {};
+
+    char* formula_buffer = NULL;    //* Buffer to write formulas to before putting them into the article.
+    size_t formula_capacity = 0;
+
+    //* Articles have their own random generators, so they can be written in parallel.
+    char random_state[ARTICLE_RANDOM_STATE_SIZE] = {};
+    random_data random = {};
 };
 
 void Article_ctor(ArticleProject* article, const char* dest_folder);
 void Article_dtor(ArticleProject* article);
 bool Article_is_fine(ArticleProject* article);
 
+/**
+ * @brief Restart the random generator of the article (article text is decided by the seed).
+ * 
+ * @param article
+ * @param seed
+ */
+void Article_seed(ArticleProject* article, unsigned int seed);
+
 void describe_differentiation(ArticleProject* article, const Equation* equation, unsigned int power);
 
 void describe_series(ArticleProject* article, const Equation* equation, double point, unsigned int power);
 
 void describe_tangent(ArticleProject* article, const Equation* equation, double point);
 
+/**
+ * @brief Write derivatives, series and tangent sections of the equation to the article.
+ * 
+ * @param article
+ * @param equation
+ * @param dif_power number of derivatives to calculate
+ * @param point point to build the series and the tangent at
+ * @param series_power max power of X to build the series to
+ */
+void describe_equation(ArticleProject* article, const Equation* equation, unsigned int dif_power,
+                       double point, unsigned int series_power);
+
+/**
+ * @brief Replace the equation with its simplified derivative by X.
+ * 
+ * @param article article whose node table, derivative cache and settings to use
+ * @param equation equation from the node table of the article
+ */
+void diff_in_place(ArticleProject* article, const Equation** equation);
+
 #endif
@@ -0,0 +1,600 @@
+#include "batch.h"
+
+#include <string.h>
+#include <ctype.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "lib/util/dbg/logger.h"
+#include "lib/util/dbg/debug.h"
+#include "lib/file_helper.h"
+#include "lib/grammar.h"
+#include "lib/equation_arena.h"
+
+#include "config.h"
+#include "main_utils.h"
+
+//* Node storage and buffers of one thread, so equations can be processed without locking.
+struct BatchWorker {
+    ArticleProject shared = {};     //* Node table and derivative cache of equations of the worker (BATCH_JSONL only).
+    EquationArena scratch = {};     //* Nodes of parsed equations and intermediate derivatives.
+
+    char* formula_buffer = NULL;
+    size_t formula_capacity = 0;
+};
+
+struct BatchContext;
+
+//* Equation waiting to be processed or written.
+struct BatchJob {
+    BatchContext* context = NULL;
+
+    const char* file_name = NULL;
+    size_t line_id = 0;
+    size_t index = 0;           //* Number of the equation in the batch (starting from 1).
+    const char* line = NULL;    //* Equation text, terminated with '\n' or '\0'.
+    size_t length = 0;          //* Length of the text, including the line feed if there is one.
+    char* line_copy = NULL;     //* Copy of the text, if its source buffer is reused for the next lines.
+
+    char* output = NULL;        //* Record of the equation (BATCH_JSONL only).
+    size_t output_size = 0;
+    bool failed = false;
+};
+
+//* State shared by all equations of the batch.
+struct BatchContext {
+    const BatchSettings* settings = NULL;
+    const char* destination = NULL;
+    ThreadPool* pool = NULL;
+
+    FILE* output = NULL;            //* JSONL file (BATCH_JSONL only).
+
+    BatchWorker* workers = NULL;    //* Worker of every thread of the pool and of the calling thread.
+    size_t worker_count = 0;
+
+    BatchJob* window = NULL;        //* Jobs being processed, in input order.
+    size_t window_size = 0;
+
+    BatchStats stats = {};
+};
+
+/**
+ * @brief Allocate workers and the job window.
+ * 
+ * @param context
+ * @param err_code variable to use as errno
+ */
+static void BatchContext_ctor(BatchContext* context, int* const err_code = &errno);
+
+/**
+ * @brief Release workers and the job window.
+ * 
+ * @param context
+ */
+static void BatchContext_dtor(BatchContext* context);
+
+/**
+ * @brief Process every equation of the file.
+ * 
+ * @param context
+ * @param file_name
+ * @param err_code variable to use as errno
+ */
+static void batch_file(BatchContext* context, const char* file_name, int* const err_code = &errno);
+
+/**
+ * @brief Process every equation of the stream, reading it through a buffer of fixed size.
+ * 
+ * @param context
+ * @param fd descriptor to read from
+ * @param err_code variable to use as errno
+ */
+static void batch_stream(BatchContext* context, int fd, int* const err_code = &errno);
+
+/**
+ * @brief Process every .math file of the directory in alphabetical order.
+ * 
+ * @param context
+ * @param dir_name
+ * @param err_code variable to use as errno
+ */
+static void batch_directory(BatchContext* context, const char* dir_name, int* const err_code = &errno);
+
+/**
+ * @brief Schedule processing of the equation, writing results of previous ones if the window is full.
+ * 
+ * @param context
+ * @param file_name file the line was taken from (should live until the window is flushed)
+ * @param line_id number of the line in the file (starting from 1)
+ * @param line equation text terminated with '\n' or '\0' (should live until the window is flushed, unless copied)
+ * @param length length of the equation text, including the line feed if there is one
+ * @param copy true if the text should be copied, as its buffer is going to be reused
+ * @param err_code variable to use as errno
+ */
+static void batch_push(BatchContext* context, const char* file_name, size_t line_id, const char* line, size_t length,
+                       bool copy, int* const err_code = &errno);
+
+/**
+ * @brief Wait for all scheduled equations and write their results in input order.
+ * 
+ * @param context
+ */
+static void batch_flush(BatchContext* context);
+
+/**
+ * @brief Parse the equation of the job and write its derivatives to the output of the job.
+ * 
+ * @param argument job to process
+ */
+static void batch_job(void* argument);
+
+/**
+ * @brief Write JSONL record of the equation and its derivatives.
+ * 
+ * @param worker worker whose node table and buffer to use
+ * @param output
+ * @param job
+ * @param equation parsed equation (NULL if parsing failed)
+ * @return false if a formula was too big to be written (record is incomplete then)
+ */
+static bool put_record(BatchWorker* worker, FILE* output, const BatchJob* job, const Equation* equation);
+
+/**
+ * @brief Write JSONL record of the equation that could not be processed.
+ * 
+ * @param output
+ * @param job
+ * @param error error description
+ */
+static void put_error_record(FILE* output, const BatchJob* job, const char* error);
+
+/**
+ * @brief Write the equation as a JSON string.
+ * 
+ * @param worker worker whose buffer to use
+ * @param output
+ * @param equation
+ * @return false if the equation was too big to be written
+ */
+static bool put_formula(BatchWorker* worker, FILE* output, const Equation* equation);
+
+/**
+ * @brief Write the article about the equation to its own folder.
+ * 
+ * @param job
+ * @param equation
+ * @return false if the article could not be written
+ */
+static bool put_article(const BatchJob* job, const Equation* equation);
+
+/**
+ * @brief Create the folder if it does not exist yet.
+ * 
+ * @param name
+ * @return false if the folder can not be created
+ */
+static bool make_folder(const char* name);
+
+static int compare_names(const void* alpha, const void* beta);
+
+BatchStats run_batch(const char* source, const char* destination, const BatchSettings* settings,
+                     int* const err_code) {
+    BatchContext context = {};
+    _LOG_FAIL_CHECK_(source, "error", ERROR_REPORTS, return context.stats, err_code, EFAULT);
+    _LOG_FAIL_CHECK_(settings, "error", ERROR_REPORTS, return context.stats, err_code, EFAULT);
+    _LOG_FAIL_CHECK_(settings->format != BATCH_NONE, "error", ERROR_REPORTS, return context.stats, err_code, EINVAL);
+
+    bool is_stdin = strcmp(source, BATCH_STDIN_NAME) == 0;
+
+    struct stat source_stat = {};
+    _LOG_FAIL_CHECK_(is_stdin || stat(source, &source_stat) == 0, "error", ERROR_REPORTS,
+                     return context.stats, err_code, ENOENT);
+
+    context.settings = settings;
+    context.pool = settings->info.pool && settings->info.pool->thread_count ? settings->info.pool : NULL;
+
+    switch (settings->format) {
+    case BATCH_JSONL:
+        context.destination = destination ? destination : BATCH_DEFAULT_JSONL_NAME;
+        context.output = fopen(context.destination, "w");
+        _LOG_FAIL_CHECK_(context.output, "error", ERROR_REPORTS, return context.stats, err_code, ENOENT);
+        break;
+    case BATCH_ARTICLES:
+        context.destination = destination ? destination : BATCH_DEFAULT_FOLDER;
+        _LOG_FAIL_CHECK_(make_folder(context.destination), "error", ERROR_REPORTS,
+                         return context.stats, err_code, ENOENT);
+        break;
+    case BATCH_NONE:
+    default:
+        break;
+    }
+
+    BatchContext_ctor(&context, err_code);
+
+    if (context.window) {
+        if (is_stdin) batch_stream(&context, STDIN_FILENO, err_code);
+        else if (S_ISDIR(source_stat.st_mode)) batch_directory(&context, source, err_code);
+        else batch_file(&context, source, err_code);
+
+        batch_flush(&context);
+    }
+
+    BatchContext_dtor(&context);
+
+    if (context.output) {
+        fclose(context.output);
+        context.output = NULL;
+    }
+
+    log_printf(STATUS_REPORTS, "status", "Batch finished: %ld equations, %ld failed.\n",
+               (long int)context.stats.equations, (long int)context.stats.failures);
+
+    return context.stats;
+}
+
+static void BatchContext_ctor(BatchContext* context, int* const err_code) {
+    context->worker_count = context->pool ? context->pool->thread_count + 1 : 1;
+
+    context->workers = (BatchWorker*) calloc(context->worker_count, sizeof(*context->workers));
+    context->window = (BatchJob*) calloc(BATCH_WINDOW_SIZE, sizeof(*context->window));
+
+    if (!context->workers || !context->window) {
+        log_printf(ERROR_REPORTS, "error", "Failed to allocate batch workers.\n");
+        *err_code = ENOMEM;
+        context->worker_count = 0;
+        BatchContext_dtor(context);
+        return;
+    }
+
+    for (size_t id = 0; id < context->worker_count; ++id) {
+        BatchWorker* worker = &context->workers[id];
+
+        *worker = {};
+        EquationArena_ctor(&worker->scratch);
+        worker->formula_capacity = MAX_FORMULA_LENGTH;
+        worker->formula_buffer = (char*) calloc(worker->formula_capacity, sizeof(*worker->formula_buffer));
+
+        if (context->settings->format == BATCH_JSONL) {
+            EquationTable_ctor(&worker->shared.nodes);
+            DiffCache_ctor(&worker->shared.derivatives);
+            worker->shared.info = context->settings->info;
+            worker->shared.info.pool = NULL;
+        }
+
+        if (!worker->formula_buffer) {
+            log_printf(ERROR_REPORTS, "error", "Failed to allocate formula buffer.\n");
+            *err_code = ENOMEM;
+            context->worker_count = id + 1;
+            BatchContext_dtor(context);
+            return;
+        }
+    }
+}
+
+static void BatchContext_dtor(BatchContext* context) {
+    for (size_t id = 0; id < context->worker_count; ++id) {
+        BatchWorker* worker = &context->workers[id];
+
+        if (context->settings->format == BATCH_JSONL) {
+            DiffCache_dtor(&worker->shared.derivatives);
+            EquationTable_dtor(&worker->shared.nodes);
+        }
+
+        EquationArena_dtor(&worker->scratch);
+        free(worker->formula_buffer);
+        worker->formula_buffer = NULL;
+    }
+
+    free(context->workers);
+    context->workers = NULL;
+    context->worker_count = 0;
+
+    free(context->window);
+    context->window = NULL;
+    context->window_size = 0;
+}
+
+static bool is_blank(const char* line, size_t length) {
+    for (size_t id = 0; id < length; ++id) {
+        if (!isspace(line[id])) return false;
+    }
+
+    return true;
+}
+
+static void batch_file(BatchContext* context, const char* file_name, int* const err_code) {
+    log_printf(STATUS_REPORTS, "status", "Reading equations from %s.\n", file_name);
+
+    MappedFile source = {};
+    _LOG_FAIL_CHECK_(MappedFile_ctor(&source, file_name, err_code), "error", ERROR_REPORTS, return, err_code, ENOENT);
+
+    const char* text_end = source.data + source.size;
+
+    size_t line_id = 0;
+    for (const char* line = source.data; line < text_end && *line != '\0';) {
+        ++line_id;
+
+        const char* line_end = (const char*) memchr(line, '\n', (size_t)(text_end - line));
+        if (!line_end) line_end = text_end;
+
+        size_t length = (size_t)(line_end - line);
+        if (!is_blank(line, length)) {
+            batch_push(context, file_name, line_id, line, line_end < text_end ? length + 1 : length, false, err_code);
+        }
+
+        line = line_end + 1;
+    }
+
+    //* Jobs parse their lines right from the mapping.
+    batch_flush(context);
+
+    MappedFile_dtor(&source);
+}
+
+static void batch_stream(BatchContext* context, int fd, int* const err_code) {
+    log_printf(STATUS_REPORTS, "status", "Reading equations from the standard input.\n");
+
+    LineReader reader = {};
+    LineReader_ctor(&reader, fd, 0, err_code);
+
+    size_t length = 0;
+    for (const char* line = LineReader_next(&reader, &length, err_code); line;
+         line = LineReader_next(&reader, &length, err_code)) {
+        if (!is_blank(line, length)) batch_push(context, BATCH_STDIN_NAME, reader.line_id, line, length, true, err_code);
+    }
+
+    LineReader_dtor(&reader);
+}
+
+static void batch_directory(BatchContext* context, const char* dir_name, int* const err_code) {
+    DIR* directory = opendir(dir_name);
+    _LOG_FAIL_CHECK_(directory, "error", ERROR_REPORTS, return, err_code, ENOENT);
+
+    char** names = NULL;
+    size_t name_count = 0;
+    size_t name_capacity = 0;
+
+    const size_t ext_length = strlen(BATCH_SOURCE_EXTENSION);
+
+    for (struct dirent* entry = readdir(directory); entry; entry = readdir(directory)) {
+        size_t length = strlen(entry->d_name);
+        if (length <= ext_length || strcmp(entry->d_name + length - ext_length, BATCH_SOURCE_EXTENSION)) continue;
+
+        if (name_count >= name_capacity) {
+            size_t new_capacity = name_capacity ? name_capacity * 2 : 16;
+            char** new_names = (char**) realloc(names, new_capacity * sizeof(*names));
+            if (!new_names) {
+                *err_code = ENOMEM;
+                break;
+            }
+            names = new_names;
+            name_capacity = new_capacity;
+        }
+
+        names[name_count] = dynamic_sprintf("%s/%s", dir_name, entry->d_name);
+        if (names[name_count]) ++name_count;
+    }
+
+    closedir(directory);
+
+    if (name_count) qsort(names, name_count, sizeof(*names), compare_names);
+
+    for (size_t id = 0; id < name_count; ++id) {
+        batch_file(context, names[id], err_code);
+    }
+
+    //* Jobs refer to the names of their files.
+    batch_flush(context);
+
+    for (size_t id = 0; id < name_count; ++id) {
+        free(names[id]);
+    }
+
+    free(names);
+}
+
+static void batch_push(BatchContext* context, const char* file_name, size_t line_id, const char* line, size_t length,
+                       bool copy, int* const err_code) {
+    if (context->window_size >= BATCH_WINDOW_SIZE) batch_flush(context);
+
+    char* line_copy = NULL;
+    if (copy) {
+        //* Line feed is kept, as single equation mode hashes it into the article seed as well.
+        line_copy = (char*) calloc(length + 2, sizeof(*line_copy));
+        _LOG_FAIL_CHECK_(line_copy, "error", ERROR_REPORTS, return, err_code, ENOMEM);
+        memcpy(line_copy, line, length);
+        line_copy[length] = '\n';
+
+        line = line_copy;
+        ++length;
+    }
+
+    BatchJob* job = &context->window[context->window_size++];
+    *job = {};
+    job->context = context;
+    job->file_name = file_name;
+    job->line_id = line_id;
+    job->index = ++context->stats.equations;
+    job->line = line;
+    job->length = length;
+    job->line_copy = line_copy;
+
+    //* Errors of earlier lines should not make a queued job run again in this thread.
+    if (context->pool) {
+        int submit_error = 0;
+        ThreadPool_submit(context->pool, batch_job, job, &submit_error);
+        if (submit_error == 0) return;
+    }
+
+    batch_job(job);
+}
+
+static void batch_flush(BatchContext* context) {
+    if (context->pool) ThreadPool_wait(context->pool);
+
+    for (size_t id = 0; id < context->window_size; ++id) {
+        BatchJob* job = &context->window[id];
+
+        if (job->output && context->output) fwrite(job->output, sizeof(*job->output), job->output_size, context->output);
+        if (job->failed) ++context->stats.failures;
+
+        free(job->output);
+        free(job->line_copy);
+        *job = {};
+    }
+
+    context->window_size = 0;
+}
+
+static void batch_job(void* argument) {
+    BatchJob* job = (BatchJob*)argument;
+    BatchContext* context = job->context;
+
+    BatchWorker* worker = &context->workers[context->pool ? ThreadPool_current_worker(context->pool) : 0];
+
+    //* A broken equation should not stop the batch, so errors are tracked per equation.
+    errno = 0;
+
+    EquationArena* old_arena = EquationArena_bind(&worker->scratch);
+
+    LexCursor cursor = {};
+    LexCursor_ctor(&cursor, job->line);
+
+    Equation* equation = parse(&cursor);
+
+    bool is_broken = errno || Equation_get_error(equation) || cursor.lexeme.type != LEX_OP_TERM;
+
+    if (is_broken) {
+        log_printf(ERROR_REPORTS, "error", "Failed to parse equation at %s:%ld.\n",
+                   job->file_name, (long int)job->line_id);
+        job->failed = true;
+        equation = NULL;
+    }
+
+    switch (context->settings->format) {
+    case BATCH_JSONL: {
+        FILE* output = open_memstream(&job->output, &job->output_size);
+        if (output && !put_record(worker, output, job, equation)) {
+            //* Incomplete record is replaced, so the output stays valid JSONL.
+            fclose(output);
+            free(job->output);
+            job->output = NULL;
+            job->failed = true;
+
+            output = open_memstream(&job->output, &job->output_size);
+            if (output) put_error_record(output, job, "equation is too big");
+        }
+
+        if (output) fclose(output);
+        else job->failed = true;
+        break;
+    }
+    case BATCH_ARTICLES:
+        if (equation && !put_article(job, equation)) job->failed = true;
+        break;
+    case BATCH_NONE:
+    default:
+        break;
+    }
+
+    //* Parsed equation and intermediate derivatives are all in the scratch arena.
+    EquationArena_bind(old_arena);
+    EquationArena_reset(&worker->scratch);
+
+    errno = 0;
+}
+
+static bool put_record(BatchWorker* worker, FILE* output, const BatchJob* job, const Equation* equation) {
+    if (!equation) {
+        put_error_record(output, job, "parse failed");
+        return true;
+    }
+
+    //* Records do not refer to the nodes of each other, so the table can be dropped between them.
+    if (worker->shared.nodes.size > BATCH_MAX_TABLE_NODES) {
+        log_printf(STATUS_REPORTS, "status", "Clearing node table of %ld nodes.\n", (long int)worker->shared.nodes.size);
+
+        DiffCache_dtor(&worker->shared.derivatives);
+        EquationTable_dtor(&worker->shared.nodes);
+        EquationTable_ctor(&worker->shared.nodes);
+        DiffCache_ctor(&worker->shared.derivatives);
+    }
+
+    fprintf(output, "{\"file\":");
+    put_json_string(output, job->file_name);
+    fprintf(output, ",\"line\":%ld", (long int)job->line_id);
+
+    const Equation* current = EquationTable_import(&worker->shared.nodes, equation);
+
+    fprintf(output, ",\"equation\":");
+    if (!put_formula(worker, output, current)) return false;
+    fprintf(output, ",\"derivatives\":[");
+
+    for (unsigned int power = 1; power <= job->context->settings->dif_power; ++power) {
+        diff_in_place(&worker->shared, &current);
+
+        if (power > 1) fputc(',', output);
+        if (!put_formula(worker, output, current)) return false;
+    }
+
+    fprintf(output, "]}\n");
+    return true;
+}
+
+static void put_error_record(FILE* output, const BatchJob* job, const char* error) {
+    fprintf(output, "{\"file\":");
+    put_json_string(output, job->file_name);
+    fprintf(output, ",\"line\":%ld,\"error\":\"%s\"}\n", (long int)job->line_id, error);
+}
+
+static bool put_formula(BatchWorker* worker, FILE* output, const Equation* equation) {
+    if (!Equation_write_to_buffer(equation, Equation_write_as_input, &worker->formula_buffer,
+                                  &worker->formula_capacity, FORMULA_LENGTH_LIMIT)) return false;
+
+    put_json_string(output, worker->formula_buffer);
+    return true;
+}
+
+static bool put_article(const BatchJob* job, const Equation* equation) {
+    const BatchSettings* settings = job->context->settings;
+
+    char* folder = dynamic_sprintf("%s/%05ld/", job->context->destination, (long int)job->index);
+    _LOG_FAIL_CHECK_(folder, "error", ERROR_REPORTS, return false, &errno, ENOMEM);
+
+    if (!make_folder(folder)) {
+        log_printf(ERROR_REPORTS, "error", "Failed to create folder %s.\n", folder);
+        free(folder);
+        return false;
+    }
+
+    ArticleProject article = {};
+    Article_ctor(&article, folder);
+
+    bool is_fine = Article_is_fine(&article);
+
+    if (is_fine) {
+        article.info = settings->info;
+        article.info.pool = NULL;
+
+        Article_seed(&article, (unsigned int)get_simple_hash(job->line, job->line + job->length));
+
+        describe_equation(&article, equation, settings->dif_power, settings->series_point, settings->series_power);
+
+        Article_dtor(&article);
+    }
+
+    free(folder);
+
+    return is_fine;
+}
+
+static bool make_folder(const char* name) {
+    if (mkdir(name, 0755) == 0) return true;
+
+    struct stat folder_stat = {};
+    return stat(name, &folder_stat) == 0 && S_ISDIR(folder_stat.st_mode);
+}
+
+static int compare_names(const void* alpha, const void* beta) {
+    return strcmp(*(const char* const*)alpha, *(const char* const*)beta);
+}
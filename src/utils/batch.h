@@ -0,0 +1,73 @@
+/**
+ * @file batch.h
+ * @author Kudryashov Ilya (kudriashov.it@phystech.edu)
+ * @brief Processing of many equations in one run.
+ * @version 0.1
+ * @date 2022-12-16
+ * 
+ * @copyright Copyright (c) 2022
+ * 
+ */
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <stdlib.h>
+#include <errno.h>
+
+#include "artigen.h"
+
+//* Extension of equation files picked up from input directories.
+static const char BATCH_SOURCE_EXTENSION[] = ".math";
+
+//* Maximum number of equations processed at once, bounds memory taken by results waiting to be written.
+static const size_t BATCH_WINDOW_SIZE = 1024;
+
+//* Node table of a worker is cleared when it grows bigger than this (BATCH_JSONL only).
+static const size_t BATCH_MAX_TABLE_NODES = 1 << 20;
+
+//* Source name that makes the batch read equations from the standard input.
+static const char BATCH_STDIN_NAME[] = "-";
+
+static const char BATCH_DEFAULT_JSONL_NAME[] = "batch.jsonl";
+static const char BATCH_DEFAULT_FOLDER[] = "batch/";
+
+enum BatchFormat {
+    BATCH_NONE,         // <-- single equation, single article
+    BATCH_JSONL,        // <-- one JSON line per equation in a common file
+    BATCH_ARTICLES,     // <-- one article folder per equation
+};
+
+struct BatchSettings {
+    BatchFormat format = BATCH_JSONL;
+
+    unsigned int dif_power = 2;
+    unsigned int series_power = 5;
+    double series_point = 0.0;
+
+    ArticleInfo info = {};  //* Optimization settings of every article and the pool to process equations in.
+};
+
+struct BatchStats {
+    size_t equations = 0;
+    size_t failures = 0;
+};
+
+/**
+ * @brief Differentiate every equation of the file, of every .math file of the directory or of the standard input.
+ * Equations are read one per line, empty lines are skipped.
+ * Files are mapped into memory, the standard input is read through a buffer of fixed size.
+ * Log, thread pool and output are shared by all equations, a broken equation is reported and skipped.
+ * With a pool, equations are processed in parallel, every thread has its own node table and buffers,
+ * results are written in input order.
+ * 
+ * @param source file or directory to read equations from (BATCH_STDIN_NAME = standard input)
+ * @param destination JSONL file or folder to put articles to (NULL = default)
+ * @param settings
+ * @param err_code variable to use as errno
+ * @return number of processed and failed equations
+ */
+BatchStats run_batch(const char* source, const char* destination, const BatchSettings* settings,
+                     int* const err_code = &errno);
+
+#endif
@@ -16,8 +16,18 @@
 
 static const int NUMBER_OF_OWLS = 10;
 
+//* Initial size of formula buffers, they grow for bigger equations.
 static const size_t MAX_FORMULA_LENGTH = 65536;
 
+//* Formula buffers do not grow beyond this size.
+static const size_t FORMULA_LENGTH_LIMIT = (size_t)1 << 30;
+
+//* Maximum number of equation characters written to the log.
+static const size_t MAX_LOGGED_EQUATION_LENGTH = 4096;
+
+//* Maximum power of the series member to print coefficient of as a fraction (power! has to fit into 64 bits).
+static const unsigned int MAX_SERIES_FRACTION_POWER = 20;
+
 static const size_t MAX_NAME_LENGTH = 1024;
 static const char DEFAULT_DB_NAME[] = "simple.math";
 static const char DEFAULT_ART_FOLDER[] = "article/";
@@ -38,6 +48,14 @@ static const char ARTICLE_PREFIX[] = "\\documentclass{article}\n\n"
 #define ARTICLE_GRAPH_SUFFIX "\\end{axis}\n\\end{tikzpicture}\n"
 #define ARTICLE_GRAPH_TEMPLATE "    \\addplot[domain=%lf-3:%lf+3,samples=200,smooth,thick,%s]\n        {%s};\n"
 
+//* Equations are plotted from points calculated by the program, pgfplots jumps over infinite and NaN values.
+#define ARTICLE_GRAPH_POINTS_PREFIX "    \\addplot[smooth,thick,%s,unbounded coords=jump] coordinates {\n"
+#define ARTICLE_GRAPH_POINT_TEMPLATE "        (%lf,%lg)\n"
+#define ARTICLE_GRAPH_POINTS_SUFFIX "    };\n"
+
+static const size_t ARTICLE_GRAPH_SAMPLES = 200;
+static const double ARTICLE_GRAPH_RADIUS = 3.0;     //* Distance from the point to the edges of the graph.
+
 static const char ARTICLE_POSTFIX[] = "\n\n\\end{document}\n";
 
 static const char* TRANSITION_PHRASES[] = {
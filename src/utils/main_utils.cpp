@@ -2,6 +2,7 @@
 
 #include <stdlib.h>
 #include <stdarg.h>
+#include <math.h>
 
 #include "lib/util/dbg/logger.h"
 #include "lib/util/dbg/debug.h"
@@ -61,7 +62,7 @@ const char* get_input_file_name(const int argc, const char** argv, const char* d
     const char* file_name = default_name;
 
     for (int argument_id = 1; argument_id < argc; ++argument_id) {
-        if (*argv[argument_id] == '-') continue;
+        if (*argv[argument_id] == '-' && argv[argument_id][1] != '\0') continue;
         file_name = argv[argument_id];
         break;
     }
@@ -74,7 +75,7 @@ const char* get_output_file_name(const int argc, const char** argv, const char*
 
     bool enc_first_name = false;
     for (int argument_id = 1; argument_id < argc; ++argument_id) {
-        if (*argv[argument_id] == '-') continue;
+        if (*argv[argument_id] == '-' && argv[argument_id][1] != '\0') continue;
         file_name = argv[argument_id];
         if (enc_first_name) return file_name;
         else enc_first_name = true;
@@ -83,6 +84,31 @@ const char* get_output_file_name(const int argc, const char** argv, const char*
     return default_name;
 }
 
+void put_json_string(FILE* file, const char* string) {
+    fputc('"', file);
+
+    for (const char* iter = string; *iter != '\0'; ++iter) {
+        char symbol = *iter;
+        switch (symbol) {
+        case '"':  fputs("\\\"", file); break;
+        case '\\': fputs("\\\\", file); break;
+        case '\n': fputs("\\n", file);  break;
+        case '\t': fputs("\\t", file);  break;
+        default:
+            if (iscntrl(symbol)) fprintf(file, "\\u%04x", (unsigned int)(unsigned char)symbol);
+            else fputc(symbol, file);
+            break;
+        }
+    }
+
+    fputc('"', file);
+}
+
+void put_json_number(FILE* file, double number) {
+    if (isfinite(number)) fprintf(file, "%.17g", number);
+    else fputs("null", file);
+}
+
 int max(int alpha, int beta) {
     return alpha > beta ? alpha : beta;
 }
@@ -75,7 +75,7 @@ void mute_speaker(const int argc, void** argv, const char* argument);
 void print_label();
 
 /**
- * @brief Get the input file name from the list of command line arguments.
+ * @brief Get the input file name from the list of command line arguments (lone "-" is a name, not a flag).
  * 
  * @param argc argument count
  * @param argv argument values
@@ -85,7 +85,7 @@ void print_label();
 const char* get_input_file_name(const int argc, const char** argv, const char* default_name);
 
 /**
- * @brief Get the output file name from the list of command line arguments.
+ * @brief Get the output file name from the list of command line arguments (lone "-" is a name, not a flag).
  * 
  * @param argc argument count
  * @param argv argument values
@@ -94,6 +94,22 @@ const char* get_input_file_name(const int argc, const char** argv, const char* d
  */
 const char* get_output_file_name(const int argc, const char** argv, const char* default_name);
 
+/**
+ * @brief Print the string as a JSON string literal.
+ * 
+ * @param file
+ * @param string
+ */
+void put_json_string(FILE* file, const char* string);
+
+/**
+ * @brief Print the number as a JSON value (null if it is not finite, as JSON has no infinities).
+ * 
+ * @param file
+ * @param number
+ */
+void put_json_number(FILE* file, double number);
+
 /**
  * @brief Get maximum of two values.
  * 
@@ -0,0 +1,705 @@
+#include "server.h"
+
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include <signal.h>
+#include <poll.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+#include "lib/util/dbg/logger.h"
+#include "lib/util/dbg/debug.h"
+#include "lib/file_helper.h"
+#include "lib/grammar.h"
+#include "lib/equation_arena.h"
+#include "lib/symbol_table.h"
+#include "lib/dual.h"
+#include "lib/taylor.h"
+#include "lib/gradient.h"
+
+#include "config.h"
+#include "artigen.h"
+#include "main_utils.h"
+
+//* Set by the signal handler to stop the server.
+static volatile sig_atomic_t ServerStopping = 0;
+
+struct Server;
+
+//* Thread serving clients, keeps its caches warm between requests and clients.
+struct ServerThread {
+    pthread_t thread = {};
+    Server* server = NULL;
+
+    ArticleProject shared = {};     //* Node table, derivative cache and optimization settings of the thread.
+    EquationArena scratch = {};     //* Nodes of parsed equations and intermediate derivatives.
+    SymbolTable symbols = {};       //* Variable names of the equations in the node table.
+
+    char* request_buffer = NULL;
+    char* formula_buffer = NULL;
+    size_t formula_capacity = 0;
+};
+
+struct Server {
+    int socket = -1;
+
+    ServerThread* threads = NULL;
+    size_t thread_count = 0;
+
+    const ServerRequest* defaults = NULL;
+
+    int connections[SERVER_BACKLOG] = {};   //* Ring buffer of accepted clients waiting for a free thread.
+    size_t front = 0;
+    size_t size = 0;
+
+    pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+    pthread_cond_t wake = PTHREAD_COND_INITIALIZER;     //* Signalled when a client is accepted.
+    bool stopping = false;
+};
+
+/**
+ * @brief Allocate buffers and caches of the thread.
+ * 
+ * @param thread
+ * @param server
+ * @param err_code variable to use as errno
+ */
+static void ServerThread_ctor(ServerThread* thread, Server* server, int* const err_code = &errno);
+
+/**
+ * @brief Release buffers and caches of the thread.
+ * 
+ * @param thread
+ */
+static void ServerThread_dtor(ServerThread* thread);
+
+static void* server_thread_main(void* argument);
+
+/**
+ * @brief Wait for an accepted client.
+ * 
+ * @param server
+ * @return client socket (-1 if the server is stopping)
+ */
+static int take_connection(Server* server);
+
+/**
+ * @brief Answer requests of the client until it disconnects.
+ * 
+ * @param thread
+ * @param client
+ */
+static void serve_client(ServerThread* thread, int client);
+
+/**
+ * @brief Answer one request.
+ * 
+ * @param thread
+ * @param client
+ * @param line request text
+ * @return false if the answer could not be sent
+ */
+static bool answer_request(ServerThread* thread, int client, const char* line);
+
+/**
+ * @brief Write JSON answer to the request.
+ * 
+ * @param thread
+ * @param output
+ * @param line request text
+ * @return false if the answer is longer than SERVER_MAX_ANSWER_LENGTH (answer is incomplete then)
+ */
+static bool put_answer(ServerThread* thread, FILE* output, const char* line);
+
+/**
+ * @brief Write the equation as a JSON string, if the answer stays within SERVER_MAX_ANSWER_LENGTH.
+ * 
+ * @param thread thread whose buffer to use
+ * @param output
+ * @param equation
+ * @return false if the answer became too long
+ */
+static bool put_formula(ServerThread* thread, FILE* output, const Equation* equation);
+
+/**
+ * @brief Write JSON object with derivatives of the equation by every its variable at the point.
+ * X is set to the point, other variables are zero, as in Equation_calculate().
+ * 
+ * @param output
+ * @param equation
+ * @param point
+ */
+static void put_gradient(FILE* output, const Equation* equation, double point);
+
+/**
+ * @brief Read options at the start of the request.
+ * 
+ * @param line request text, is moved to the equation
+ * @param request where to put the options
+ * @return false if options are invalid
+ */
+static bool parse_options(const char** line, ServerRequest* request);
+
+/**
+ * @brief Send the whole buffer to the socket.
+ * 
+ * @param socket
+ * @param data
+ * @param size
+ * @return false if the connection was closed
+ */
+static bool send_all(int socket, const char* data, size_t size);
+
+/**
+ * @brief Fill the address of the local socket.
+ * 
+ * @param address
+ * @param socket_name
+ * @return false if the name does not fit into the address
+ */
+static bool make_address(struct sockaddr_un* address, const char* socket_name);
+
+/**
+ * @brief Remove the socket file left behind by a killed server.
+ * Files that are not sockets and sockets some server still listens on are kept.
+ * 
+ * @param socket_name
+ * @param address address of the socket
+ * @return false if the name is taken by something that should not be removed
+ */
+static bool remove_stale_socket(const char* socket_name, const struct sockaddr_un* address);
+
+static void stop_server(int signal_id);
+
+void run_server(const char* socket_name, size_t thread_count, const ServerRequest* defaults, int* const err_code) {
+    _LOG_FAIL_CHECK_(socket_name, "error", ERROR_REPORTS, return, err_code, EFAULT);
+    _LOG_FAIL_CHECK_(defaults, "error", ERROR_REPORTS, return, err_code, EFAULT);
+
+    struct sockaddr_un address = {};
+    _LOG_FAIL_CHECK_(make_address(&address, socket_name), "error", ERROR_REPORTS, return, err_code, ENAMETOOLONG);
+
+    Server server = {};
+    server.defaults = defaults;
+    server.thread_count = thread_count ? thread_count : SERVER_DEFAULT_THREADS;
+
+    server.socket = socket(AF_UNIX, SOCK_STREAM, 0);
+    _LOG_FAIL_CHECK_(server.socket >= 0, "error", ERROR_REPORTS, return, err_code, EAGAIN);
+
+    if (!remove_stale_socket(socket_name, &address)) {
+        log_printf(ERROR_REPORTS, "error", "%s is in use and is not a socket of a stopped server.\n", socket_name);
+        close(server.socket);
+        *err_code = EADDRINUSE;
+        return;
+    }
+
+    if (bind(server.socket, (const struct sockaddr*)&address, sizeof(address)) ||
+        listen(server.socket, (int)SERVER_BACKLOG)) {
+        log_printf(ERROR_REPORTS, "error", "Failed to listen on %s.\n", socket_name);
+        close(server.socket);
+        *err_code = EADDRINUSE;
+        return;
+    }
+
+    server.threads = (ServerThread*) calloc(server.thread_count, sizeof(*server.threads));
+    _LOG_FAIL_CHECK_(server.threads, "error", ERROR_REPORTS, close(server.socket); return,
+                     err_code, ENOMEM);
+
+    size_t started = 0;
+    for (; started < server.thread_count; ++started) {
+        ServerThread* thread = &server.threads[started];
+        ServerThread_ctor(thread, &server, err_code);
+
+        if (!thread->request_buffer || !thread->formula_buffer ||
+            pthread_create(&thread->thread, NULL, server_thread_main, thread)) {
+            ServerThread_dtor(thread);
+            break;
+        }
+    }
+
+    struct sigaction action = {};
+    action.sa_handler = stop_server;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    ServerStopping = 0;
+
+    if (started) {
+        printf("Listening on %s with %ld threads.\n", socket_name, (long int)started);
+        fflush(stdout);
+        log_printf(STATUS_REPORTS, "status", "Listening on %s.\n", socket_name);
+    }
+
+    while (started && !ServerStopping) {
+        struct pollfd request = { .fd = server.socket, .events = POLLIN, .revents = 0 };
+        if (poll(&request, 1, SERVER_POLL_TIMEOUT) <= 0) continue;
+
+        int client = accept(server.socket, NULL, NULL);
+        if (client < 0) continue;
+
+        pthread_mutex_lock(&server.lock);
+        if (server.size < SERVER_BACKLOG) {
+            server.connections[(server.front + server.size++) % SERVER_BACKLOG] = client;
+            client = -1;
+            pthread_cond_signal(&server.wake);
+        }
+        pthread_mutex_unlock(&server.lock);
+
+        if (client >= 0) {
+            log_printf(WARNINGS, "warning", "Too many clients, connection dropped.\n");
+            close(client);
+        }
+    }
+
+    log_printf(STATUS_REPORTS, "status", "Stopping the server.\n");
+
+    pthread_mutex_lock(&server.lock);
+    server.stopping = true;
+    pthread_cond_broadcast(&server.wake);
+    pthread_mutex_unlock(&server.lock);
+
+    for (size_t id = 0; id < started; ++id) {
+        pthread_join(server.threads[id].thread, NULL);
+        ServerThread_dtor(&server.threads[id]);
+    }
+
+    for (size_t id = 0; id < server.size; ++id) {
+        close(server.connections[(server.front + id) % SERVER_BACKLOG]);
+    }
+
+    free(server.threads);
+    server.threads = NULL;
+
+    close(server.socket);
+    unlink(socket_name);
+
+    action.sa_handler = SIG_DFL;
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+
+    pthread_mutex_destroy(&server.lock);
+    pthread_cond_destroy(&server.wake);
+
+    //* Interrupted system calls are the normal way for the server to stop.
+    if (started && errno == EINTR) errno = 0;
+}
+
+size_t run_client(const char* socket_name, const char* file_name, const ServerRequest* options, FILE* output,
+                  int* const err_code) {
+    _LOG_FAIL_CHECK_(socket_name, "error", ERROR_REPORTS, return 0, err_code, EFAULT);
+    _LOG_FAIL_CHECK_(file_name, "error", ERROR_REPORTS, return 0, err_code, EFAULT);
+    _LOG_FAIL_CHECK_(options, "error", ERROR_REPORTS, return 0, err_code, EFAULT);
+    _LOG_FAIL_CHECK_(output, "error", ERROR_REPORTS, return 0, err_code, EFAULT);
+
+    struct sockaddr_un address = {};
+    _LOG_FAIL_CHECK_(make_address(&address, socket_name), "error", ERROR_REPORTS, return 0, err_code, ENAMETOOLONG);
+
+    int server = socket(AF_UNIX, SOCK_STREAM, 0);
+    _LOG_FAIL_CHECK_(server >= 0, "error", ERROR_REPORTS, return 0, err_code, EAGAIN);
+
+    if (connect(server, (const struct sockaddr*)&address, sizeof(address))) {
+        log_printf(ERROR_REPORTS, "error", "Failed to connect to %s.\n", socket_name);
+        close(server);
+        *err_code = ECONNREFUSED;
+        return 0;
+    }
+
+    FILE* answers = fdopen(server, "r");
+    _LOG_FAIL_CHECK_(answers, "error", ERROR_REPORTS, close(server); return 0, err_code, ENOMEM);
+
+    char* text = read_whole(file_name);
+    _LOG_FAIL_CHECK_(text, "error", ERROR_REPORTS, fclose(answers); return 0, err_code, ENOENT);
+
+    size_t failures = 0;
+
+    char* answer = NULL;
+    size_t answer_capacity = 0;
+
+    for (const char* line = text; *line != '\0';) {
+        const char* line_end = strchr(line, '\n');
+        if (!line_end) line_end = line + strlen(line);
+
+        bool is_empty = true;
+        for (const char* iter = line; iter < line_end && is_empty; ++iter) {
+            if (!isspace(*iter)) is_empty = false;
+        }
+
+        if (!is_empty) {
+            char* request = dynamic_sprintf("-D%u -S%u -P%.17g -G%d %.*s\n", options->dif_power,
+                                            options->series_power, options->series_point, options->optimize_mode,
+                                            (int)(line_end - line), line);
+            bool is_sent = request && send_all(server, request, strlen(request));
+            free(request);
+
+            if (!is_sent || getline(&answer, &answer_capacity, answers) < 0) {
+                log_printf(ERROR_REPORTS, "error", "Server closed the connection.\n");
+                *err_code = ECONNRESET;
+                ++failures;
+                break;
+            }
+
+            fputs(answer, output);
+            if (strstr(answer, "\"error\"")) ++failures;
+        }
+
+        line = *line_end == '\n' ? line_end + 1 : line_end;
+    }
+
+    free(answer);
+    free(text);
+    fclose(answers);
+
+    return failures;
+}
+
+static void ServerThread_ctor(ServerThread* thread, Server* server, int* const err_code) {
+    *thread = {};
+    thread->server = server;
+
+    EquationTable_ctor(&thread->shared.nodes);
+    DiffCache_ctor(&thread->shared.derivatives);
+    EquationArena_ctor(&thread->scratch);
+    SymbolTable_ctor(&thread->symbols);
+
+    thread->request_buffer = (char*) calloc(SERVER_MAX_REQUEST_LENGTH, sizeof(*thread->request_buffer));
+    thread->formula_capacity = MAX_FORMULA_LENGTH;
+    thread->formula_buffer = (char*) calloc(thread->formula_capacity, sizeof(*thread->formula_buffer));
+
+    _LOG_FAIL_CHECK_(thread->request_buffer && thread->formula_buffer, "error", ERROR_REPORTS, return,
+                     err_code, ENOMEM);
+}
+
+static void ServerThread_dtor(ServerThread* thread) {
+    DiffCache_dtor(&thread->shared.derivatives);
+    EquationTable_dtor(&thread->shared.nodes);
+    EquationArena_dtor(&thread->scratch);
+    SymbolTable_dtor(&thread->symbols);
+
+    free(thread->request_buffer);
+    thread->request_buffer = NULL;
+
+    free(thread->formula_buffer);
+    thread->formula_buffer = NULL;
+}
+
+static void* server_thread_main(void* argument) {
+    ServerThread* thread = (ServerThread*)argument;
+
+    EquationArena_bind(&thread->scratch);
+    SymbolTable_bind(&thread->symbols);
+
+    for (int client = take_connection(thread->server); client >= 0; client = take_connection(thread->server)) {
+        serve_client(thread, client);
+        close(client);
+    }
+
+    EquationArena_bind(NULL);
+    SymbolTable_bind(NULL);
+
+    return NULL;
+}
+
+static int take_connection(Server* server) {
+    pthread_mutex_lock(&server->lock);
+
+    while (!server->stopping && server->size == 0) pthread_cond_wait(&server->wake, &server->lock);
+
+    int client = -1;
+    if (!server->stopping) {
+        client = server->connections[server->front];
+        server->front = (server->front + 1) % SERVER_BACKLOG;
+        --server->size;
+    }
+
+    pthread_mutex_unlock(&server->lock);
+
+    return client;
+}
+
+static void serve_client(ServerThread* thread, int client) {
+    char* buffer = thread->request_buffer;
+    size_t filled = 0;
+
+    log_printf(STATUS_REPORTS, "status", "Client connected.\n");
+
+    while (!ServerStopping) {
+        //* Waiting with a timeout, so clients that stay connected do not block stopping.
+        struct pollfd request = { .fd = client, .events = POLLIN, .revents = 0 };
+        if (poll(&request, 1, SERVER_POLL_TIMEOUT) <= 0) continue;
+
+        ssize_t received = recv(client, buffer + filled, SERVER_MAX_REQUEST_LENGTH - 1 - filled, 0);
+        if (received <= 0) break;
+        filled += (size_t)received;
+
+        char* line = buffer;
+        for (char* line_end = (char*) memchr(line, '\n', filled); line_end;
+                   line_end = (char*) memchr(line, '\n', filled - (size_t)(line - buffer))) {
+            *line_end = '\0';
+            if (!answer_request(thread, client, line)) return;
+            line = line_end + 1;
+        }
+
+        filled -= (size_t)(line - buffer);
+        memmove(buffer, line, filled);
+
+        if (filled >= SERVER_MAX_REQUEST_LENGTH - 1) {
+            const char too_long[] = "{\"error\":\"request is too long\"}\n";
+            send_all(client, too_long, sizeof(too_long) - 1);
+            break;
+        }
+    }
+
+    log_printf(STATUS_REPORTS, "status", "Client disconnected.\n");
+}
+
+static bool answer_request(ServerThread* thread, int client, const char* line) {
+    char* answer = NULL;
+    size_t answer_size = 0;
+
+    FILE* output = open_memstream(&answer, &answer_size);
+    if (!output) return false;
+
+    bool is_complete = put_answer(thread, output, line);
+    fclose(output);
+
+    if (!is_complete) {
+        log_printf(WARNINGS, "warning", "Answer of %ld bytes is too long to be sent.\n", (long int)answer_size);
+
+        free(answer);
+
+        const char too_big[] = "{\"error\":\"answer is too big\"}\n";
+        return send_all(client, too_big, sizeof(too_big) - 1);
+    }
+
+    bool is_sent = send_all(client, answer, answer_size);
+    free(answer);
+
+    return is_sent;
+}
+
+static bool put_answer(ServerThread* thread, FILE* output, const char* line) {
+    //* A broken request should not stop the server, so errors are tracked per request.
+    errno = 0;
+
+    ServerRequest request = *thread->server->defaults;
+    if (!parse_options(&line, &request)) {
+        fputs("{\"error\":\"invalid options\"}\n", output);
+        return true;
+    }
+
+    //* Names are dropped together with the nodes, so cached equations never refer to a missing name.
+    if (thread->shared.nodes.size > SERVER_MAX_TABLE_NODES || Symbol_count() > SERVER_MAX_SYMBOLS) {
+        log_printf(STATUS_REPORTS, "status", "Clearing node table of %ld nodes and %ld symbols.\n",
+                   (long int)thread->shared.nodes.size, (long int)Symbol_count());
+
+        DiffCache_dtor(&thread->shared.derivatives);
+        EquationTable_dtor(&thread->shared.nodes);
+        SymbolTable_dtor(&thread->symbols);
+        SymbolTable_ctor(&thread->symbols);
+        SymbolTable_bind(&thread->symbols);
+        EquationTable_ctor(&thread->shared.nodes);
+        DiffCache_ctor(&thread->shared.derivatives);
+    }
+
+    LexCursor cursor = {};
+    LexCursor_ctor(&cursor, line);
+
+    Equation* equation = parse(&cursor);
+
+    bool is_broken = errno || Equation_get_error(equation) || cursor.lexeme.type != LEX_OP_TERM;
+
+    if (is_broken) {
+        fputs("{\"error\":\"parse failed\"}\n", output);
+        EquationArena_reset(&thread->scratch);
+        errno = 0;
+        return true;
+    }
+
+    thread->shared.info.optimize = request.optimize_mode > 0;
+    thread->shared.info.optimize_cost = request.optimize_mode > 1 ? OPT_COST_EVAL : OPT_COST_SIZE;
+
+    const Equation* current = EquationTable_import(&thread->shared.nodes, equation);
+
+    fputs("{\"equation\":", output);
+    bool fits = put_formula(thread, output, current);
+
+    fputs(",\"derivatives\":[", output);
+    for (unsigned int power = 1; fits && power <= request.dif_power; ++power) {
+        diff_in_place(&thread->shared, &current);
+
+        if (power > 1) fputc(',', output);
+        fits = put_formula(thread, output, current);
+    }
+
+    if (!fits) {
+        EquationArena_reset(&thread->scratch);
+        errno = 0;
+        return false;
+    }
+
+    fputs("],\"series\":{\"point\":", output);
+    put_json_number(output, request.series_point);
+    fputs(",\"coefficients\":", output);
+
+    //* Equations with no series at the point get null instead of the coefficients.
+    double* coefs = (double*) calloc((size_t)request.series_power + 1, sizeof(*coefs));
+    if (coefs && Equation_taylor(equation, request.series_point, request.series_power, coefs)) {
+        fputc('[', output);
+        for (unsigned int power = 0; power <= request.series_power; ++power) {
+            if (power > 0) fputc(',', output);
+            put_json_number(output, coefs[power]);
+        }
+        fputc(']', output);
+    } else {
+        fputs("null", output);
+    }
+
+    free(coefs);
+
+    Dual tangent = Equation_calculate_dual(equation, request.series_point);
+
+    fputs("},\"tangent\":{\"point\":", output);
+    put_json_number(output, request.series_point);
+    fputs(",\"value\":", output);
+    put_json_number(output, tangent.val);
+    fputs(",\"slope\":", output);
+    put_json_number(output, tangent.der);
+    fputs("},\"gradient\":", output);
+    put_gradient(output, equation, request.series_point);
+    fputs("}\n", output);
+
+    //* Parsed equation and intermediate derivatives are all in the scratch arena.
+    EquationArena_reset(&thread->scratch);
+
+    errno = 0;
+    return true;
+}
+
+static bool put_formula(ServerThread* thread, FILE* output, const Equation* equation) {
+    if (!Equation_write_to_buffer(equation, Equation_write_as_input, &thread->formula_buffer,
+                                  &thread->formula_capacity, SERVER_MAX_ANSWER_LENGTH)) return false;
+
+    put_json_string(output, thread->formula_buffer);
+
+    long int answer_length = ftell(output);
+    return answer_length >= 0 && (size_t)answer_length <= SERVER_MAX_ANSWER_LENGTH;
+}
+
+static void put_gradient(FILE* output, const Equation* equation, double point) {
+    VarTable vars = {};
+    VarTable_ctor(&vars);
+    VarTable_set(&vars, SYMBOL_X, point);
+    VarTable_bind_all(&vars, equation, 0.0);
+
+    double* gradient = (double*) calloc(vars.size, sizeof(*gradient));
+    if (gradient) Equation_gradient(equation, &vars, gradient);
+
+    fputc('{', output);
+    for (size_t index = 0; gradient && index < vars.size; ++index) {
+        if (index > 0) fputc(',', output);
+        put_json_string(output, Symbol_name((symbol_t)vars.vars[index].id));
+        fputc(':', output);
+        put_json_number(output, gradient[index]);
+    }
+    fputc('}', output);
+
+    free(gradient);
+    VarTable_dtor(&vars);
+}
+
+static bool parse_options(const char** line, ServerRequest* request) {
+    const char* iter = *line;
+
+    while (true) {
+        while (isblank(*iter)) ++iter;
+        if (iter[0] != '-' || !isalpha(iter[1])) break;
+
+        const char* value = iter + 2;
+        char* value_end = NULL;
+
+        long int_value = 0;
+        double dbl_value = 0.0;
+
+        switch (iter[1]) {
+        case 'D':
+        case 'S':
+            int_value = strtol(value, &value_end, 10);
+            if (int_value < 0 || int_value > (long)SERVER_MAX_POWER) return false;
+            if (iter[1] == 'D') request->dif_power = (unsigned int)int_value;
+            else request->series_power = (unsigned int)int_value;
+            break;
+        case 'P':
+            dbl_value = strtod(value, &value_end);
+            if (!isfinite(dbl_value)) return false;
+            request->series_point = dbl_value;
+            break;
+        case 'G':
+            int_value = strtol(value, &value_end, 10);
+            if (int_value < 0 || int_value > 2) return false;
+            request->optimize_mode = (int)int_value;
+            break;
+        default:
+            return false;
+        }
+
+        if (value_end == value || (*value_end != '\0' && !isblank(*value_end))) return false;
+        iter = value_end;
+    }
+
+    *line = iter;
+    return true;
+}
+
+static bool send_all(int socket, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t sent = send(socket, data, size, MSG_NOSIGNAL);
+        if (sent < 0 && errno == EINTR) continue;
+        if (sent <= 0) return false;
+
+        data += sent;
+        size -= (size_t)sent;
+    }
+
+    return true;
+}
+
+static bool make_address(struct sockaddr_un* address, const char* socket_name) {
+    if (strlen(socket_name) >= sizeof(address->sun_path)) return false;
+
+    address->sun_family = AF_UNIX;
+    strncpy(address->sun_path, socket_name, sizeof(address->sun_path) - 1);
+
+    return true;
+}
+
+static bool remove_stale_socket(const char* socket_name, const struct sockaddr_un* address) {
+    struct stat socket_stat = {};
+    if (stat(socket_name, &socket_stat)) {
+        if (errno != ENOENT) return false;
+
+        errno = 0;
+        return true;
+    }
+
+    if (!S_ISSOCK(socket_stat.st_mode)) return false;
+
+    int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (probe < 0) return false;
+
+    //* Only a socket nobody listens on is left behind, a running server accepts the connection.
+    bool is_stale = connect(probe, (const struct sockaddr*)address, sizeof(*address)) && errno == ECONNREFUSED;
+    close(probe);
+
+    if (!is_stale || unlink(socket_name)) return false;
+
+    errno = 0;
+    return true;
+}
+
+static void stop_server(int signal_id) {
+    SILENCE_UNUSED(signal_id);
+    ServerStopping = 1;
+}
@@ -0,0 +1,80 @@
+/**
+ * @file server.h
+ * @author Kudryashov Ilya (kudriashov.it@phystech.edu)
+ * @brief Differentiation server on a local socket and its client.
+ * @version 0.1
+ * @date 2022-12-17
+ * 
+ * @copyright Copyright (c) 2022
+ * 
+ */
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+
+#include "lib/symbol_table.h"
+
+static const size_t SERVER_DEFAULT_THREADS = 4;
+
+//* Maximum number of connections waiting for a free thread.
+static const size_t SERVER_BACKLOG = 64;
+
+static const size_t SERVER_MAX_REQUEST_LENGTH = 65536;
+
+//* Bigger answers are replaced with an error, so one request can not exhaust the memory of the server.
+static const size_t SERVER_MAX_ANSWER_LENGTH = (size_t)1 << 26;
+
+//* Maximum differentiation and series power a client can request.
+static const unsigned int SERVER_MAX_POWER = 64;
+
+//* Node table of a thread is cleared when it grows bigger than this.
+static const size_t SERVER_MAX_TABLE_NODES = 1 << 20;
+
+//* Symbol table of a thread is cleared with its node table when it has more names than this.
+static const size_t SERVER_MAX_SYMBOLS = SYMBOL_MAX_COUNT / 2;
+
+//* How often threads waiting for input check if the server is stopping (in milliseconds).
+static const int SERVER_POLL_TIMEOUT = 200;
+
+/**
+ * @brief Options of one request, same as the ones of single equation mode.
+ * Request is a line of options followed by the equation, "-D3 -S4 -P0.5 -G1 sin(x)".
+ */
+struct ServerRequest {
+    unsigned int dif_power = 2;     // <-- -D
+    unsigned int series_power = 5;  // <-- -S
+    double series_point = 0.0;      // <-- -P
+    int optimize_mode = 0;          // <-- -G
+};
+
+/**
+ * @brief Serve requests on the socket until the process receives SIGINT or SIGTERM.
+ * Every thread serves one client at a time and keeps its node table and derivative cache between requests,
+ * every request is answered with one JSON line.
+ * 
+ * @param socket_name path of the socket to create
+ * @param thread_count number of clients served at once (0 = default)
+ * @param defaults options of requests that do not specify them
+ * @param err_code variable to use as errno
+ */
+void run_server(const char* socket_name, size_t thread_count, const ServerRequest* defaults,
+                int* const err_code = &errno);
+
+/**
+ * @brief Send every non-empty line of the file to the server and print the answers.
+ * 
+ * @param socket_name path of the server socket
+ * @param file_name file with equations, one per line
+ * @param options options to send with every equation
+ * @param output where to print the answers
+ * @param err_code variable to use as errno
+ * @return number of requests the server failed to answer
+ */
+size_t run_client(const char* socket_name, const char* file_name, const ServerRequest* options, FILE* output,
+                  int* const err_code = &errno);
+
+#endif